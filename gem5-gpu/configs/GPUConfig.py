@@ -133,6 +133,13 @@ def addGPUOptions(parser):
     parser.add_option("--g_core_prim_pipe_size", type="int", default=2, help="Core prims buffer size")
     parser.add_option("--g_core_prim_delay", type="int", default=4, help="Prim bounding box calculation delay")
     parser.add_option("--g_core_prim_warps", type="int", default=2, help="Number of prim warps concurrently processed")
+    parser.add_option("--g_shader_cache", type="int", default=0, help="Reuse generated shader PTX across draw calls")
+    parser.add_option("--g_shader_cache_dir", type="string", default="none", help="Directory to persist the shader cache across runs (none to disable)")
+    parser.add_option("--g_frame_dump_format", type="choice", choices=["png", "ppm", "raw", "delta", "none"], default="png", help="Format of the per draw call buffer dumps")
+    parser.add_option("--g_frame_dump_queue", type="int", default=8, help="Buffer dumps queued for the writer thread before simulation waits")
+    parser.add_option("--g_hiz_levels", type="int", default=0, help="Levels of the HiZ pyramid used for coarse culling (0 to disable)")
+    parser.add_option("--g_fast_forward", action="store_true", default=False, help="Replay standalone trace frames before the start frame through Mesa only")
+    parser.add_option("--g_raster_threads", type="int", default=1, help="Host threads used to bin primitive batches into raster tiles")
 
 
 def configureMemorySpaces(options):
@@ -222,6 +229,13 @@ def parseGpgpusimConfig(options):
     config = config.replace("%gCorePrimPipeSize%", str(options.g_core_prim_pipe_size) +"\n")
     config = config.replace("%gCorePrimDelay%", str(options.g_core_prim_delay) +"\n")
     config = config.replace("%gCorePrimWarps%", str(options.g_core_prim_warps) +"\n")
+    config = config.replace("%gShaderCache%", str(options.g_shader_cache) +"\n")
+    config = config.replace("%gShaderCacheDir%", options.g_shader_cache_dir +"\n")
+    config = config.replace("%gFrameDumpFormat%", options.g_frame_dump_format +"\n")
+    config = config.replace("%gFrameDumpQueue%", str(options.g_frame_dump_queue) +"\n")
+    config = config.replace("%gHizLevels%", str(options.g_hiz_levels) +"\n")
+    config = config.replace("%gFastForward%", ("1" if options.g_fast_forward else "0") +"\n")
+    config = config.replace("%gRasterThreads%", str(options.g_raster_threads) +"\n")
 
     maxWgSize = options.g_tc_w*options.g_tc_h*options.g_raster_tw*options.g_raster_th
     if(options.g_frag_wg_size > maxWgSize or options.g_vert_wg_size>maxWgSize):
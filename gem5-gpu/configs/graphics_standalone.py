@@ -59,6 +59,8 @@ parser.add_option("--sim-cycles", type="int", default=1000,
                   help="Number of simulation cycles")
 parser.add_option("--gtrace", type="string", default="",
                    help="apitrace trace file")
+parser.add_option("--gcheckpoint", type="string", default="",
+                   help="frame boundary checkpoint to resume the trace from")
 
 (options, args) = parser.parse_args()
 
@@ -208,10 +210,18 @@ root.system.mem_mode = 'timing'
 # Not much point in this being higher than the L1 latency
 m5.ticks.setGlobalFrequency('1ns')
 
-# instantiate configuration
-m5.instantiate()
+# instantiate configuration, frames before the checkpoint are replayed
+# by Mesa only
+if options.gcheckpoint != "":
+   m5.instantiate(options.gcheckpoint)
+else:
+   m5.instantiate()
 
-# simulate until program terminates
+# simulate until program terminates, taking the graphics checkpoints
+# requested at frame boundaries on the way
 exit_event = m5.simulate(options.abs_max_tick)
+while exit_event.getCause() == "graphics checkpoint":
+   m5.checkpoint(os.path.join(m5.options.outdir, "cpt.%d" % m5.curTick()))
+   exit_event = m5.simulate(options.abs_max_tick - m5.curTick())
 
 print 'Exiting @ tick', m5.curTick(), 'because', exit_event.getCause()
@@ -1854,6 +1854,50 @@ void** graphicsRegisterFatBinary( void *fat_cubin_p, const char * ptx_info_file,
     return (void**)handle;
 }
 
+// Re-registers a binary whose symbol table is still resident from an earlier
+// graphicsRegisterFatBinary, skipping the PTX front end. Only the globals and
+// constants get a new allocation.
+void** graphicsReloadFatBinary(unsigned fat_cubin_handle, void** pAllocAddr)
+{
+    DPRINTF(GPUSyscalls, "gem5 GPU Syscall: graphicsReloadFatBinary(handle = %d)\n", fat_cubin_handle);
+
+    CudaGPU *cudaGPU = CudaGPU::getCudaGPU(g_active_device);
+    ThreadContext* tc = cudaGPU->getGraphicsTC();
+
+    assert(registering_fat_cubin_handle == 0);
+    assert(registering_symtab == NULL);
+    registering_symtab = cudaGPU->get_binary(fat_cubin_handle);
+    assert(registering_symtab);
+    registering_fat_cubin_handle = fat_cubin_handle;
+    cudaGPU->add_binary(registering_symtab, registering_fat_cubin_handle);
+
+    // Binaries parsed since then may have claimed the shared variable names
+    symbol_table::iterator iter;
+    for (iter = registering_symtab->global_iterator_begin(); iter != registering_symtab->global_iterator_end(); iter++) {
+        g_sym_name_to_symbol_table[(*iter)->name()] = registering_symtab;
+    }
+    for (iter = registering_symtab->const_iterator_begin(); iter != registering_symtab->const_iterator_end(); iter++) {
+        g_sym_name_to_symbol_table[(*iter)->name()] = registering_symtab;
+    }
+
+    assert(registering_allocation_size == -1);
+    registering_allocation_size = get_global_and_constant_alloc_size(registering_symtab);
+
+    DPRINTF(GPUSyscalls, "gem5 GPU Syscall: graphicsReloadFatBinary needs %d bytes allocated\n", registering_allocation_size);
+
+    // Recorded like a fresh registration so checkpoints see this allocation
+    cudaGPU->saveFatBinaryInfoTop(-1, registering_fat_cubin_handle, -1, sizeof(__cudaFatCudaBinary));
+
+    GPUSyscallHelper helper(tc, NULL);
+
+    Addr sim_alloc_ptr = cudaGPU->mallocGraphicsMem(registering_allocation_size);
+    (*pAllocAddr) = (void*) sim_alloc_ptr;
+    cudaGPU->saveFatBinaryInfoBottom(sim_alloc_ptr);
+    unsigned int handle = registerFatBinaryBottom(&helper, sim_alloc_ptr);
+
+    return (void**)handle;
+}
+
 void
 __cudaRegisterFatBinaryFinalize(ThreadContext *tc, gpusyscall_t *call_params)
 {
@@ -379,6 +379,7 @@ cudaError_t graphicsFreeArray(struct cudaArray *array);
 cudaError_t graphicsStreamCreate(cudaStream_t *stream);
 cudaError_t graphicsStreamDestroy(cudaStream_t stream);
 void** graphicsRegisterFatBinary( void *fat_cubin, const char * ptx_info_file, void** pAllocAddr);
+void** graphicsReloadFatBinary(unsigned fat_cubin_handle, void** pAllocAddr);
 void graphicsRegisterFunction(
 		void   **fatCubinHandle,
 		const char    *hostFun,
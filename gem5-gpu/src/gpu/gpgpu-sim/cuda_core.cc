@@ -987,13 +987,13 @@ CudaCore::record_st(memory_space_t space)
 }
 
 void
-CudaCore::record_inst(int inst_type)
+CudaCore::record_inst(int inst_type, unsigned count)
 {
-    instCounts[inst_type]++;
+    instCounts[inst_type] += count;
 
     // if not nop
     if (inst_type != 7) {
-        instInstances++;
+        instInstances += count;
         if (curCycle() != lastActiveCycle) {
             lastActiveCycle = curCycle();
             notStalledCycles++;
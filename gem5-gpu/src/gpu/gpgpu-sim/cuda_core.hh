@@ -445,7 +445,7 @@ class CudaCore : public MemObject
 
     void record_ld(memory_space_t space);
     void record_st(memory_space_t space);
-    void record_inst(int inst_type);
+    void record_inst(int inst_type, unsigned count = 1);
     void record_block_issue(unsigned hw_cta_id);
     void record_block_commit(unsigned hw_cta_id);
     void printCTAStats(std::ostream& out);
@@ -551,6 +551,10 @@ void CudaGPU::gpuPrintStats(std::ostream& out) {
         (*cores)->printCTAStats(out);
     }
     out << "\ntotal kernel time (ticks) = " << total_kernel_ticks << "\n";
+    g_renderData.printShaderCacheStats(out);
+    g_renderData.printFrameDumpStats(out);
+    g_renderData.printHizStats(out);
+    g_renderData.printRasterStats(out);
 
     if (clearTick) {
         out << "Stats cleared at tick " << clearTick << "\n";
@@ -752,6 +756,15 @@ void CudaGPU::add_binary( symbol_table *symtab, unsigned fat_cubin_handle )
     m_last_fat_cubin_handle = fat_cubin_handle;
 }
 
+symbol_table *CudaGPU::get_binary( unsigned fat_cubin_handle )
+{
+    std::map<unsigned,symbol_table*>::iterator i = m_code.find(fat_cubin_handle);
+    if (i != m_code.end()) {
+        return i->second;
+    }
+    return NULL;
+}
+
 void CudaGPU::add_ptxinfo( const char *deviceFun, const struct gpgpu_ptx_sim_kernel_info info )
 {
     symbol *s = m_code[m_last_fat_cubin_handle]->lookup(deviceFun);
@@ -1068,6 +1081,8 @@ void CudaGPU::GMemory::freeMem(Addr addr) {
 */
 void GPUExitCallback::process()
 {
+    //make sure pending frame dumps reach the disk
+    g_renderData.flushFrameDumps();
     OutputStream* outs = simout.find(stats_filename);
     if(outs){
        std::ostream *os = outs->stream();
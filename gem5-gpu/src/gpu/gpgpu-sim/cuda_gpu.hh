@@ -661,9 +661,11 @@ class CudaGPU : public MemObject
         bin.sim_alloc_ptr = sim_alloc_ptr;
     }
     void saveFunctionNames(unsigned int handle, const char *host, const char *dev) {
-        _FatBinary& bin = fatBinaries[handle-1];
-        assert(bin.handle == handle);
-        bin.funcMap[host] = std::string(dev);
+        // Reloaded graphics binaries add records that reuse their handle
+        std::vector<_FatBinary>::reverse_iterator bin = fatBinaries.rbegin();
+        while (bin != fatBinaries.rend() && bin->handle != handle) ++bin;
+        assert(bin != fatBinaries.rend());
+        bin->funcMap[host] = std::string(dev);
     }
     void saveVar(Addr sim_deviceAddress, const char* deviceName, int sim_size, int sim_constant, int sim_global, int sim_ext, Addr sim_hostVar) {
         _CudaVar var;
@@ -679,6 +681,7 @@ class CudaGPU : public MemObject
 
     /// From gpu syscalls (used to be CUctx_st)
     void add_binary( symbol_table *symtab, unsigned fat_cubin_handle );
+    symbol_table *get_binary( unsigned fat_cubin_handle );
     void add_ptxinfo( const char *deviceFun, const struct gpgpu_ptx_sim_kernel_info info );
     void register_function( unsigned fat_cubin_handle, const char *hostFun, const char *deviceFun );
     function_info *get_kernel(const char *hostFun);
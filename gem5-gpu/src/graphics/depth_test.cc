@@ -0,0 +1,63 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "base/misc.hh"
+#include "graphics/depth_test.hh"
+
+void
+DepthTester::setFunc(GLenum func)
+{
+    switch (func) {
+      case GL_NEVER:
+        m_test = &DepthCompare<GL_NEVER>::pass<uint64_t>;
+        break;
+      case GL_LESS:
+        m_test = &DepthCompare<GL_LESS>::pass<uint64_t>;
+        break;
+      case GL_EQUAL:
+        m_test = &DepthCompare<GL_EQUAL>::pass<uint64_t>;
+        break;
+      case GL_LEQUAL:
+        m_test = &DepthCompare<GL_LEQUAL>::pass<uint64_t>;
+        break;
+      case GL_GREATER:
+        m_test = &DepthCompare<GL_GREATER>::pass<uint64_t>;
+        break;
+      case GL_NOTEQUAL:
+        m_test = &DepthCompare<GL_NOTEQUAL>::pass<uint64_t>;
+        break;
+      case GL_GEQUAL:
+        m_test = &DepthCompare<GL_GEQUAL>::pass<uint64_t>;
+        break;
+      case GL_ALWAYS:
+        m_test = &DepthCompare<GL_ALWAYS>::pass<uint64_t>;
+        break;
+      default:
+        panic("Unsupported depth function %x\n", func);
+    }
+    m_func = func;
+}
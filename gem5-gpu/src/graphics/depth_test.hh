@@ -0,0 +1,230 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef __DEPTH_TEST_HH__
+#define __DEPTH_TEST_HH__
+
+#include <GL/gl.h>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+
+/*
+ * Depth comparison kernels. Each depth function gets its own compare functor
+ * so the per-fragment test is a single inlined comparison instead of a switch
+ * on the GL state. DepthTester resolves the function once per draw call; the
+ * span kernels test or reduce a whole tile of Z16/Z32 values in branch-free
+ * loops the compiler can vectorize.
+ *
+ * As in the GL spec a fragment passes when "newDepth <func> oldDepth".
+ */
+template <GLenum Func> struct DepthCompare;
+
+template <> struct DepthCompare<GL_NEVER> {
+    template <typename T> static bool pass(T oldDepth, T newDepth)
+    { return false; }
+};
+template <> struct DepthCompare<GL_LESS> {
+    template <typename T> static bool pass(T oldDepth, T newDepth)
+    { return newDepth < oldDepth; }
+};
+template <> struct DepthCompare<GL_EQUAL> {
+    template <typename T> static bool pass(T oldDepth, T newDepth)
+    { return newDepth == oldDepth; }
+};
+template <> struct DepthCompare<GL_LEQUAL> {
+    template <typename T> static bool pass(T oldDepth, T newDepth)
+    { return newDepth <= oldDepth; }
+};
+template <> struct DepthCompare<GL_GREATER> {
+    template <typename T> static bool pass(T oldDepth, T newDepth)
+    { return newDepth > oldDepth; }
+};
+template <> struct DepthCompare<GL_NOTEQUAL> {
+    template <typename T> static bool pass(T oldDepth, T newDepth)
+    { return newDepth != oldDepth; }
+};
+template <> struct DepthCompare<GL_GEQUAL> {
+    template <typename T> static bool pass(T oldDepth, T newDepth)
+    { return newDepth >= oldDepth; }
+};
+template <> struct DepthCompare<GL_ALWAYS> {
+    template <typename T> static bool pass(T oldDepth, T newDepth)
+    { return true; }
+};
+
+class DepthTester {
+  public:
+    typedef bool (*testFunc_t)(uint64_t oldDepth, uint64_t newDepth);
+
+    DepthTester() { setFunc(GL_LESS); }
+
+    //resolves the comparison kernels, called once per draw call
+    void setFunc(GLenum func);
+    GLenum func() const { return m_func; }
+
+    bool test(uint64_t oldDepth, uint64_t newDepth) const
+    { return m_test(oldDepth, newDepth); }
+
+    //functions for which a [front, back] depth range bounds the test result
+    bool ordered() const
+    {
+        return m_func == GL_LESS or m_func == GL_LEQUAL
+            or m_func == GL_GREATER or m_func == GL_GEQUAL;
+    }
+
+    //tests count new depths against a single stored depth,
+    //pass[i] is set to 0/1 and the number of passing values is returned
+    template <typename T>
+    unsigned testNew(uint64_t oldDepth, const T* newDepths, unsigned count,
+          uint8_t* pass) const;
+
+    //tests a single new depth against count stored depths
+    template <typename T>
+    unsigned testOld(const T* oldDepths, uint64_t newDepth, unsigned count,
+          uint8_t* pass) const;
+
+    //nearest (front) and farthest (back) of count > 0 depths, ordered() only
+    template <typename T>
+    void range(const T* depths, unsigned count, uint64_t& front,
+          uint64_t& back) const;
+
+    //smallest and largest of count > 0 depths
+    template <typename T>
+    static void minMax(const T* depths, unsigned count, uint64_t& minDepth,
+          uint64_t& maxDepth);
+
+  private:
+    template <GLenum Func, bool RefIsOld, typename T>
+    static unsigned spanKernel(uint64_t ref, const T* vals, unsigned count,
+          uint8_t* pass);
+    template <bool RefIsOld, typename T>
+    unsigned span(uint64_t ref, const T* vals, unsigned count,
+          uint8_t* pass) const;
+
+    GLenum m_func;
+    testFunc_t m_test;
+};
+
+template <GLenum Func, bool RefIsOld, typename T>
+unsigned
+DepthTester::spanKernel(uint64_t ref, const T* vals, unsigned count,
+      uint8_t* pass)
+{
+    unsigned passed = 0;
+    if (ref > std::numeric_limits<T>::max()) {
+        //every value is below the reference, the result is the same for all
+        typedef DepthCompare<Func> cmp;
+        const uint8_t res = RefIsOld? cmp::template pass<uint64_t>(ref, 0)
+            : cmp::template pass<uint64_t>(0, ref);
+        for (unsigned i = 0; i < count; i++)
+            pass[i] = res;
+        return res? count : 0;
+    }
+    //compare in the narrow type so the loop vectorizes
+    typedef DepthCompare<Func> cmp;
+    const T r = ref;
+    for (unsigned i = 0; i < count; i++) {
+        const uint8_t res = RefIsOld? cmp::template pass<T>(r, vals[i])
+            : cmp::template pass<T>(vals[i], r);
+        pass[i] = res;
+        passed += res;
+    }
+    return passed;
+}
+
+template <bool RefIsOld, typename T>
+unsigned
+DepthTester::span(uint64_t ref, const T* vals, unsigned count,
+      uint8_t* pass) const
+{
+    switch (m_func) {
+      case GL_NEVER:
+        return spanKernel<GL_NEVER, RefIsOld>(ref, vals, count, pass);
+      case GL_LESS:
+        return spanKernel<GL_LESS, RefIsOld>(ref, vals, count, pass);
+      case GL_EQUAL:
+        return spanKernel<GL_EQUAL, RefIsOld>(ref, vals, count, pass);
+      case GL_LEQUAL:
+        return spanKernel<GL_LEQUAL, RefIsOld>(ref, vals, count, pass);
+      case GL_GREATER:
+        return spanKernel<GL_GREATER, RefIsOld>(ref, vals, count, pass);
+      case GL_NOTEQUAL:
+        return spanKernel<GL_NOTEQUAL, RefIsOld>(ref, vals, count, pass);
+      case GL_GEQUAL:
+        return spanKernel<GL_GEQUAL, RefIsOld>(ref, vals, count, pass);
+      default:
+        return spanKernel<GL_ALWAYS, RefIsOld>(ref, vals, count, pass);
+    }
+}
+
+template <typename T>
+unsigned
+DepthTester::testNew(uint64_t oldDepth, const T* newDepths, unsigned count,
+      uint8_t* pass) const
+{
+    return span<true>(oldDepth, newDepths, count, pass);
+}
+
+template <typename T>
+unsigned
+DepthTester::testOld(const T* oldDepths, uint64_t newDepth, unsigned count,
+      uint8_t* pass) const
+{
+    return span<false>(newDepth, oldDepths, count, pass);
+}
+
+template <typename T>
+void
+DepthTester::minMax(const T* depths, unsigned count, uint64_t& minDepth,
+      uint64_t& maxDepth)
+{
+    assert(count > 0);
+    T minVal = depths[0];
+    T maxVal = depths[0];
+    for (unsigned i = 1; i < count; i++) {
+        minVal = depths[i] < minVal? depths[i] : minVal;
+        maxVal = depths[i] > maxVal? depths[i] : maxVal;
+    }
+    minDepth = minVal;
+    maxDepth = maxVal;
+}
+
+template <typename T>
+void
+DepthTester::range(const T* depths, unsigned count, uint64_t& front,
+      uint64_t& back) const
+{
+    assert(ordered());
+    uint64_t minVal, maxVal;
+    minMax(depths, count, minVal, maxVal);
+    const bool nearIsMin = m_func == GL_LESS or m_func == GL_LEQUAL;
+    front = nearIsMin? minVal : maxVal;
+    back = nearIsMin? maxVal : minVal;
+}
+
+#endif // __DEPTH_TEST_HH__
@@ -0,0 +1,197 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Checks the DepthTester span kernels against a per-fragment switch on the
+// depth function, as renderData_t::depthTest did, and times both over
+// synthetic depth tiles for each depth size.
+// Usage: depth_test_test [tiles to time]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+#include "graphics/depth_test.hh"
+
+static const GLenum funcs[] = {GL_NEVER, GL_LESS, GL_EQUAL, GL_LEQUAL,
+    GL_GREATER, GL_NOTEQUAL, GL_GEQUAL, GL_ALWAYS};
+static const char* funcNames[] = {"NEVER", "LESS", "EQUAL", "LEQUAL",
+    "GREATER", "NOTEQUAL", "GEQUAL", "ALWAYS"};
+
+//the per-fragment test before DepthTester, called across translation units
+__attribute__((noinline))
+static bool switchDepthTest(GLenum func, uint64_t oldDepthVal,
+      uint64_t newDepthVal)
+{
+    switch (func) {
+      case GL_LESS: return newDepthVal < oldDepthVal;
+      case GL_LEQUAL: return newDepthVal <= oldDepthVal;
+      case GL_GEQUAL: return newDepthVal >= oldDepthVal;
+      case GL_GREATER: return newDepthVal > oldDepthVal;
+      case GL_NOTEQUAL: return newDepthVal != oldDepthVal;
+      case GL_EQUAL: return newDepthVal == oldDepthVal;
+      case GL_NEVER: return false;
+      default: return true;
+    }
+}
+
+template <typename T>
+static void fillTiles(std::vector<T>& depths)
+{
+    //narrow value range so EQUAL and NOTEQUAL both get exercised
+    for (unsigned i = 0; i < depths.size(); i++)
+        depths[i] = (T) (rand() % 64) << (sizeof(T) * 8 - 8);
+}
+
+template <typename T>
+static int checkSpans(const char* size)
+{
+    DepthTester tester;
+    std::vector<T> depths(257);
+    std::vector<uint8_t> pass(depths.size());
+    for (unsigned f = 0; f < sizeof(funcs) / sizeof(funcs[0]); f++) {
+        tester.setFunc(funcs[f]);
+        for (unsigned iter = 0; iter < 2000; iter++) {
+            fillTiles(depths);
+            unsigned count = rand() % depths.size();
+            //references beyond the depth size take the uniform path
+            uint64_t ref = (rand() % 8 == 0) ?
+                (uint64_t) std::numeric_limits<T>::max() + 1 + rand() % 3 :
+                depths[rand() % depths.size()];
+            unsigned passed = tester.testNew(ref, &depths[0], count, &pass[0]);
+            unsigned expected = 0;
+            for (unsigned i = 0; i < count; i++) {
+                bool res = switchDepthTest(funcs[f], ref, depths[i]);
+                expected += res;
+                if (pass[i] != res or tester.test(ref, depths[i]) != res) {
+                    printf("ERROR ** %s %s testNew differs at %u\n", size,
+                           funcNames[f], i);
+                    return 1;
+                }
+            }
+            if (passed != expected) {
+                printf("ERROR ** %s %s testNew count %u, expected %u\n", size,
+                       funcNames[f], passed, expected);
+                return 1;
+            }
+            passed = tester.testOld(&depths[0], ref, count, &pass[0]);
+            expected = 0;
+            for (unsigned i = 0; i < count; i++) {
+                bool res = switchDepthTest(funcs[f], depths[i], ref);
+                expected += res;
+                if (pass[i] != res) {
+                    printf("ERROR ** %s %s testOld differs at %u\n", size,
+                           funcNames[f], i);
+                    return 1;
+                }
+            }
+            if (passed != expected) {
+                printf("ERROR ** %s %s testOld count %u, expected %u\n", size,
+                       funcNames[f], passed, expected);
+                return 1;
+            }
+            if (count > 0 and tester.ordered()) {
+                uint64_t front, back, minDepth, maxDepth;
+                tester.range(&depths[0], count, front, back);
+                DepthTester::minMax(&depths[0], count, minDepth, maxDepth);
+                for (unsigned i = 0; i < count; i++) {
+                    //nothing nearer than front or farther than back
+                    if ((depths[i] != front and tester.test(front, depths[i])) or
+                        (depths[i] != back and tester.test(depths[i], back)) or
+                        depths[i] < minDepth or depths[i] > maxDepth) {
+                        printf("ERROR ** %s %s range does not bound %u\n",
+                               size, funcNames[f], i);
+                        return 1;
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+//fragments per microsecond testing tiles of tileSize fragments against a
+//stored depth, old per-fragment switch against the span kernel
+template <typename T>
+static void timeSpans(const char* size, unsigned tileSize, unsigned tiles)
+{
+    typedef std::chrono::steady_clock bench_clock;
+    const unsigned nTiles = 1024;
+    std::vector<T> depths(nTiles * tileSize);
+    std::vector<uint8_t> pass(tileSize);
+    fillTiles(depths);
+    DepthTester tester;
+    volatile GLenum funcSel = GL_LESS;
+    printf("%s, %u fragment tiles (Mfragments/s, switch -> span):\n", size,
+           tileSize);
+    for (unsigned f = 1; f < sizeof(funcs) / sizeof(funcs[0]) - 1; f++) {
+        funcSel = funcs[f];
+        tester.setFunc(funcs[f]);
+        uint64_t sum = 0;
+        bench_clock::time_point t0 = bench_clock::now();
+        for (unsigned t = 0; t < tiles; t++) {
+            const T* tile = &depths[(t % nTiles) * tileSize];
+            uint64_t ref = tile[t % tileSize];
+            for (unsigned i = 0; i < tileSize; i++)
+                sum += switchDepthTest(funcSel, ref, tile[i]);
+        }
+        bench_clock::time_point t1 = bench_clock::now();
+        for (unsigned t = 0; t < tiles; t++) {
+            const T* tile = &depths[(t % nTiles) * tileSize];
+            uint64_t ref = tile[t % tileSize];
+            sum += tester.testNew(ref, tile, tileSize, &pass[0]);
+        }
+        bench_clock::time_point t2 = bench_clock::now();
+        double frags = (double) tiles * tileSize;
+        printf("   %-8s %7.1f -> %7.1f (checksum %llu)\n", funcNames[f],
+               frags / std::chrono::duration<double, std::micro>(t1 - t0).count(),
+               frags / std::chrono::duration<double, std::micro>(t2 - t1).count(),
+               (unsigned long long) sum);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int errors_found = 0;
+    srand(1);
+    errors_found |= checkSpans<uint16_t>("Z16");
+    errors_found |= checkSpans<uint32_t>("Z32");
+
+    unsigned tiles = (argc > 1) ? atoi(argv[1]) : 200000;
+    //a raster tile and a TC tile of the default configuration
+    timeSpans<uint16_t>("Z16", 32, tiles);
+    timeSpans<uint32_t>("Z32", 32, tiles);
+    timeSpans<uint16_t>("Z16", 256, tiles / 8);
+    timeSpans<uint32_t>("Z32", 256, tiles / 8);
+
+    if (errors_found) {
+        printf("SUMMARY:  ERRORS FOUND\n");
+    } else {
+        printf("SUMMARY: UNIT TEST PASSED\n");
+    }
+    return errors_found;
+}
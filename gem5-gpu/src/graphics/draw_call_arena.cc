@@ -0,0 +1,75 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+#include "graphics/draw_call_arena.hh"
+
+drawCallArena_t::~drawCallArena_t(){
+   reset();
+   for(unsigned c=0; c<m_chunks.size(); c++)
+      free(m_chunks[c].base);
+   m_chunks.clear();
+}
+
+void* drawCallArena_t::allocate(size_t bytes, size_t align){
+   assert(align > 0 and (align & (align-1)) == 0);
+   while(m_currChunk < m_chunks.size()){
+      chunk_t& chunk = m_chunks[m_currChunk];
+      size_t start = (m_offset + align - 1) & ~(align - 1);
+      if(start + bytes <= chunk.size){
+         m_offset = start + bytes;
+         m_allocatedBytes += bytes;
+         m_peakBytes = std::max(m_peakBytes, m_allocatedBytes);
+         return chunk.base + start;
+      }
+      //move on to the next retained chunk
+      m_currChunk++;
+      m_offset = 0;
+   }
+   //malloc memory is aligned for any fundamental type
+   size_t chunkSize = std::max(m_chunkSize, bytes);
+   uint8_t* base = (uint8_t*) malloc(chunkSize);
+   assert(base != NULL);
+   m_chunks.push_back(chunk_t(base, chunkSize));
+   m_currChunk = m_chunks.size() - 1;
+   m_offset = bytes;
+   m_allocatedBytes += bytes;
+   m_peakBytes = std::max(m_peakBytes, m_allocatedBytes);
+   return base;
+}
+
+void drawCallArena_t::reset(){
+   for(auto it = m_dtors.rbegin(); it != m_dtors.rend(); ++it)
+      it->second(it->first);
+   m_dtors.clear();
+   m_currChunk = 0;
+   m_offset = 0;
+   m_allocatedBytes = 0;
+}
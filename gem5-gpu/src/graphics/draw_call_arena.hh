@@ -0,0 +1,99 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef __DRAW_CALL_ARENA_HH__
+#define __DRAW_CALL_ARENA_HH__
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//bump allocator for objects that live as long as a draw call, everything
+//allocated here is released in bulk by reset(), chunks are kept for reuse
+class drawCallArena_t {
+   public:
+      drawCallArena_t(size_t chunkSize = (1 << 20)):
+         m_chunkSize(chunkSize), m_currChunk(0), m_offset(0),
+         m_allocatedBytes(0), m_peakBytes(0)
+      {}
+      ~drawCallArena_t();
+
+      void* allocate(size_t bytes, size_t align);
+
+      template <typename T, typename... Args>
+      T* create(Args&&... args){
+         T* obj = new (allocate(sizeof(T), alignof(T)))
+            T(std::forward<Args>(args)...);
+         if(!std::is_trivially_destructible<T>::value)
+            m_dtors.push_back(std::make_pair((void*)obj, &destroy<T>));
+         return obj;
+      }
+
+      //value-initialized array, elements are not destructed on reset
+      template <typename T>
+      T* createArray(size_t count){
+         static_assert(std::is_trivially_destructible<T>::value,
+               "arena arrays must be trivially destructible");
+         if(count == 0) return NULL;
+         T* arr = (T*) allocate(sizeof(T)*count, alignof(T));
+         for(size_t i=0; i<count; i++)
+            new (&arr[i]) T();
+         return arr;
+      }
+
+      void reset();
+      size_t allocatedBytes() const { return m_allocatedBytes; }
+      size_t peakBytes() const { return m_peakBytes; }
+      size_t chunksCount() const { return m_chunks.size(); }
+
+   private:
+      drawCallArena_t(const drawCallArena_t&) = delete;
+      drawCallArena_t& operator=(const drawCallArena_t&) = delete;
+
+      template <typename T>
+      static void destroy(void* obj){
+         static_cast<T*>(obj)->~T();
+      }
+
+      struct chunk_t {
+         chunk_t(uint8_t* b, size_t s): base(b), size(s) {}
+         uint8_t* base;
+         size_t size;
+      };
+      const size_t m_chunkSize;
+      std::vector<chunk_t> m_chunks;
+      unsigned m_currChunk;
+      size_t m_offset;
+      size_t m_allocatedBytes;
+      size_t m_peakBytes;
+      std::vector<std::pair<void*, void (*)(void*)> > m_dtors;
+};
+
+#endif /* __DRAW_CALL_ARENA_HH__ */
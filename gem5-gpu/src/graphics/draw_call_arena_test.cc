@@ -0,0 +1,315 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Checks drawCallArena_t and times binning the fragments of a primitive into
+// raster tiles the way sortFragmentsInTiles did before the arena, with heap
+// tiles in an unordered_map walked over every frame tile, against the arena
+// tiles in a flat array over the primitive bounding box.  The tiles model
+// RasterTile's fragment storage without the Mesa fragment data.
+// Usage: draw_call_arena_test [draw calls to time]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+
+#include "graphics/draw_call_arena.hh"
+
+static const unsigned QUAD_SIZE = 4;
+
+struct frag_t {
+   unsigned x, y;
+};
+
+struct slot_t {
+   slot_t(): alive(false), frag(NULL) {}
+   bool alive;
+   const frag_t* frag;
+};
+
+static unsigned quadSlot(const frag_t* frag, unsigned tileH, unsigned tileW,
+      unsigned& quadIdx){
+   unsigned fragX = frag->x%tileW;
+   unsigned fragY = frag->y%tileH;
+   const unsigned qd = QUAD_SIZE/2;
+   quadIdx = fragY%qd == 0? (fragX%qd == 0? 0 : 1) : (fragX%qd == 0? 2 : 3);
+   return (fragY/qd)*(tileW/qd) + fragX/qd;
+}
+
+//tile as RasterTile stored it before the arena, a vector per quad
+struct heapTile_t {
+   heapTile_t(unsigned _tileH, unsigned _tileW, unsigned _x, unsigned _y,
+         unsigned _pos):
+      tileH(_tileH), tileW(_tileW), x(_x), y(_y), pos(_pos),
+      quads(_tileH*_tileW/QUAD_SIZE, std::vector<slot_t>(QUAD_SIZE))
+   {}
+   void addFragment(const frag_t* frag){
+      unsigned q;
+      unsigned t = quadSlot(frag, tileH, tileW, q);
+      quads[t][q].frag = frag;
+      quads[t][q].alive = true;
+   }
+   unsigned activeCount() const {
+      unsigned count = 0;
+      for(unsigned t=0; t<quads.size(); t++)
+         for(unsigned q=0; q<QUAD_SIZE; q++)
+            count += quads[t][q].alive;
+      return count;
+   }
+   unsigned tileH, tileW, x, y, pos;
+   std::vector<std::vector<slot_t> > quads;
+};
+
+//tile as RasterTile stores it now, one arena array for all quads
+struct arenaTile_t {
+   arenaTile_t(drawCallArena_t* arena, unsigned _tileH, unsigned _tileW,
+         unsigned _x, unsigned _y, unsigned _pos):
+      tileH(_tileH), tileW(_tileW), x(_x), y(_y), pos(_pos),
+      slots(arena->createArray<slot_t>(_tileH*_tileW))
+   {}
+   void addFragment(const frag_t* frag){
+      unsigned q;
+      unsigned t = quadSlot(frag, tileH, tileW, q);
+      slots[t*QUAD_SIZE + q].frag = frag;
+      slots[t*QUAD_SIZE + q].alive = true;
+   }
+   unsigned activeCount() const {
+      unsigned count = 0;
+      for(unsigned i=0; i<tileH*tileW; i++)
+         count += slots[i].alive;
+      return count;
+   }
+   unsigned tileH, tileW, x, y, pos;
+   slot_t* slots;
+};
+
+struct binConfig_t {
+   unsigned frameW, frameH, tileH, tileW, tcBlockInTiles, clusters;
+   unsigned wTiles() const { return frameW/tileW; }
+   unsigned hTiles() const { return (frameH + tileH - 1)/tileH; }
+   unsigned xTCBlocks() const {
+      unsigned tbpw = tcBlockInTiles*tileW;
+      return (frameW + tbpw - 1)/tbpw;
+   }
+   unsigned cluster(unsigned x, unsigned y) const {
+      return ((y/tcBlockInTiles)*xTCBlocks() + x/tcBlockInTiles)%clusters;
+   }
+};
+
+//the binning before the arena, per cluster lists of tile positions are
+//appended to order
+static void binHeap(const binConfig_t& c, const std::vector<frag_t>& frags,
+      std::vector<std::vector<unsigned> >& order){
+   std::unordered_map<unsigned, heapTile_t*> tiles;
+   for(unsigned f=0; f < frags.size(); f++){
+      unsigned x = frags[f].x/c.tileW;
+      unsigned y = frags[f].y/c.tileH;
+      unsigned pos = y*c.wTiles() + x;
+      if(tiles.find(pos) == tiles.end())
+         tiles[pos] = new heapTile_t(c.tileH, c.tileW, x, y, pos);
+      tiles[pos]->addFragment(&frags[f]);
+   }
+   unsigned fragCount = 0;
+   const unsigned tilesCount = c.wTiles()*c.hTiles();
+   for(unsigned t=0; t < tilesCount; t++){
+      if(tiles.find(t) != tiles.end())
+         fragCount += tiles[t]->activeCount();
+   }
+   if(fragCount != frags.size())
+      abort();
+   for(unsigned t=0; t < tilesCount; t++){
+      if(tiles.find(t) != tiles.end())
+         order[c.cluster(tiles[t]->x, tiles[t]->y)].push_back(t);
+   }
+   for(auto it = tiles.begin(); it != tiles.end(); ++it)
+      delete it->second;
+}
+
+//the binning now, bounding box array of arena tiles
+static void binArena(const binConfig_t& c, const std::vector<frag_t>& frags,
+      drawCallArena_t* arena, std::vector<std::vector<unsigned> >& order){
+   if(frags.empty())
+      return;
+   unsigned minXPos = frags[0].x, maxXPos = frags[0].x;
+   unsigned minYPos = frags[0].y, maxYPos = frags[0].y;
+   //the primitive tracks these as fragments are added
+   for(unsigned f=1; f < frags.size(); f++){
+      minXPos = std::min(minXPos, frags[f].x);
+      maxXPos = std::max(maxXPos, frags[f].x);
+      minYPos = std::min(minYPos, frags[f].y);
+      maxYPos = std::max(maxYPos, frags[f].y);
+   }
+   const unsigned minX = minXPos/c.tileW, maxX = maxXPos/c.tileW;
+   const unsigned minY = minYPos/c.tileH, maxY = maxYPos/c.tileH;
+   const unsigned bboxW = maxX - minX + 1;
+   const unsigned bboxH = maxY - minY + 1;
+   arenaTile_t** tiles = arena->createArray<arenaTile_t*>(bboxW*bboxH);
+   for(unsigned f=0; f < frags.size(); f++){
+      unsigned x = frags[f].x/c.tileW;
+      unsigned y = frags[f].y/c.tileH;
+      arenaTile_t*& tile = tiles[(y - minY)*bboxW + (x - minX)];
+      if(tile == NULL)
+         tile = arena->create<arenaTile_t>(arena, c.tileH, c.tileW, x, y,
+               y*c.wTiles() + x);
+      tile->addFragment(&frags[f]);
+   }
+   unsigned fragCount = 0;
+   for(unsigned t=0; t < bboxW*bboxH; t++){
+      if(tiles[t] == NULL)
+         continue;
+      fragCount += tiles[t]->activeCount();
+      order[c.cluster(tiles[t]->x, tiles[t]->y)].push_back(tiles[t]->pos);
+   }
+   if(fragCount != frags.size())
+      abort();
+}
+
+//fragments of a triangle with a random corner and the given size, emitted in
+//raster order like the Mesa rasterizer does
+static void makeTriangle(const binConfig_t& c, unsigned size,
+      std::vector<frag_t>& frags){
+   frags.clear();
+   unsigned x0 = rand()%(c.frameW - size);
+   unsigned y0 = rand()%(c.frameH - size);
+   for(unsigned y=0; y < size; y++){
+      for(unsigned x=0; x <= y; x++){
+         frag_t f = {x0 + x, y0 + y};
+         frags.push_back(f);
+      }
+   }
+}
+
+struct tracked_t {
+   tracked_t(int* _live): live(_live) { (*live)++; }
+   ~tracked_t() { (*live)--; }
+   int* live;
+};
+
+static int check_arena(){
+   drawCallArena_t arena(4096);
+   int live = 0;
+   for(unsigned round=0; round < 3; round++){
+      for(unsigned i=0; i < 1000; i++){
+         arena.create<tracked_t>(&live);
+         double* d = arena.createArray<double>(1 + i%7);
+         if(((size_t)d % alignof(double)) != 0 or d[i%7 == 0? 0 : i%7] != 0.0){
+            printf("ERROR ** misaligned or uninitialized arena array\n");
+            return 1;
+         }
+         d[0] = 1.0;
+         arena.allocate(1 + i%13, 1);
+      }
+      //an allocation larger than a chunk gets a chunk of its own
+      arena.createArray<char>(10000);
+      if(live != 1000){
+         printf("ERROR ** %d live arena objects, expected 1000\n", live);
+         return 1;
+      }
+      size_t chunks = arena.chunksCount();
+      arena.reset();
+      if(live != 0 or arena.allocatedBytes() != 0){
+         printf("ERROR ** arena reset left %d objects, %zu bytes\n", live,
+               arena.allocatedBytes());
+         return 1;
+      }
+      //chunks are reused after the first round
+      if(round > 0 and arena.chunksCount() != chunks){
+         printf("ERROR ** arena grew to %zu chunks after reset\n", chunks);
+         return 1;
+      }
+   }
+   return 0;
+}
+
+int main(int argc, char *argv[])
+{
+   typedef std::chrono::steady_clock bench_clock;
+   int errors_found = check_arena();
+   unsigned drawCalls = (argc > 1)? atoi(argv[1]) : 4;
+   const unsigned primsPerDraw = 500;
+   binConfig_t configs[] = {
+      {1024, 768, 4, 8, 8, 6},
+      {1920, 1080, 4, 8, 8, 6},
+   };
+   const unsigned sizes[] = {8, 32, 128};
+   srand(1);
+   for(unsigned c=0; c < sizeof(configs)/sizeof(configs[0]); c++){
+      for(unsigned s=0; s < sizeof(sizes)/sizeof(sizes[0]); s++){
+         std::vector<std::vector<frag_t> > prims(primsPerDraw);
+         for(unsigned p=0; p < primsPerDraw; p++)
+            makeTriangle(configs[c], sizes[s], prims[p]);
+
+         //both schemes must hand the same tiles to each cluster in order
+         for(unsigned p=0; p < primsPerDraw and !errors_found; p++){
+            drawCallArena_t arena;
+            std::vector<std::vector<unsigned> > heapOrder(configs[c].clusters);
+            std::vector<std::vector<unsigned> > arenaOrder(configs[c].clusters);
+            binHeap(configs[c], prims[p], heapOrder);
+            binArena(configs[c], prims[p], &arena, arenaOrder);
+            if(heapOrder != arenaOrder){
+               printf("ERROR ** tile order differs for primitive %u\n", p);
+               errors_found = 1;
+            }
+         }
+
+         std::vector<std::vector<unsigned> > order(configs[c].clusters);
+         bench_clock::time_point t0 = bench_clock::now();
+         for(unsigned d=0; d < drawCalls; d++){
+            for(unsigned p=0; p < primsPerDraw; p++){
+               for(unsigned k=0; k < order.size(); k++) order[k].clear();
+               binHeap(configs[c], prims[p], order);
+            }
+         }
+         bench_clock::time_point t1 = bench_clock::now();
+         drawCallArena_t arena;
+         for(unsigned d=0; d < drawCalls; d++){
+            for(unsigned p=0; p < primsPerDraw; p++){
+               for(unsigned k=0; k < order.size(); k++) order[k].clear();
+               binArena(configs[c], prims[p], &arena, order);
+            }
+            arena.reset();
+         }
+         bench_clock::time_point t2 = bench_clock::now();
+         double heapUs = std::chrono::duration<double, std::micro>(t1 - t0).count();
+         double arenaUs = std::chrono::duration<double, std::micro>(t2 - t1).count();
+         printf("%ux%u tile %ux%u, %u px triangles: "
+               "heap/map %.2f us/prim, arena/bbox %.2f us/prim\n",
+               configs[c].frameW, configs[c].frameH, configs[c].tileH,
+               configs[c].tileW, sizes[s],
+               heapUs/(drawCalls*primsPerDraw), arenaUs/(drawCalls*primsPerDraw));
+      }
+   }
+
+   if(errors_found){
+      printf("SUMMARY:  ERRORS FOUND\n");
+   } else {
+      printf("SUMMARY: UNIT TEST PASSED\n");
+   }
+   return errors_found;
+}
@@ -35,7 +35,10 @@
 #include "base/statistics.hh"
 #include "debug/GraphicsStandalone.hh"
 #include "gpu/gpgpu-sim/cuda_gpu.hh"
+#include "graphics/mesa_gpgpusim.h"
+#include "sim/serialize.hh"
 #include "sim/sim_events.hh"
+#include "sim/simulate.hh"
 #include "sim/stats.hh"
 #include "sim/system.hh"
 
@@ -47,13 +50,12 @@ GraphicsStandalone::GraphicsStandalone(const Params *p) :
       tickEvent(this),
       traceStarted(false),
       traceDone(false),
+      checkpointTaken(false),
       tracePath(p->trace_path),
       traceThread(NULL)
 {
    if(tracePath.size() == 0)
       panic("No graphics trace is specified");
-
-   schedule(tickEvent, 0);
 }
 
 GraphicsStandalone::~GraphicsStandalone(){
@@ -66,6 +68,29 @@ GraphicsStandalone::init()
 {
 }
 
+void
+GraphicsStandalone::startup()
+{
+   //after a checkpoint restore curTick is no longer 0
+   schedule(tickEvent, clockEdge());
+}
+
+void
+GraphicsStandalone::serialize(CheckpointOut &cp) const
+{
+   unsigned frame = g_renderData.getCurrentFrame();
+   SERIALIZE_SCALAR(frame);
+}
+
+void
+GraphicsStandalone::unserialize(CheckpointIn &cp)
+{
+   unsigned frame;
+   UNSERIALIZE_SCALAR(frame);
+   DPRINTF(GraphicsStandalone, "resuming trace at frame %u\n", frame);
+   g_renderData.setResumeFrame(frame);
+}
+
 void
 GraphicsStandalone::tick()
 {
@@ -84,6 +109,29 @@ GraphicsStandalone::tick()
       DPRINTF(GraphicsStandalone, "starting trace %s\n", tracePath.c_str());
       traceThread = new std::thread(&GraphicsStandalone::runTrace, this, std::ref(tracePath));
       traceStarted = true;
+   } else {
+      if(checkpointTaken){
+         checkpointTaken = false;
+         g_renderData.releaseCheckpoint();
+      }
+
+      if(g_renderData.checkpointPending() 
+            and CheckPointRequest_t::Request.isCheckpointRequested()){
+         DPRINTF(GraphicsStandalone, "checkpoint at frame %u\n", 
+               g_renderData.getCurrentFrame());
+         checkpointTaken = true;
+         schedule(tickEvent, clockEdge(Cycles(1)));
+         exitSimLoop("graphics checkpoint");
+         return;
+      }
+
+      //frames the trace fast-forwards through do not advance simulated 
+      //time, poll again at this tick and let the trace thread run meanwhile
+      if(!traceDone and g_renderData.fastForwardingFrame()){
+         std::this_thread::yield();
+         schedule(tickEvent, curTick());
+         return;
+      }
    }
 
    schedule(tickEvent, clockEdge(Cycles(1)));
@@ -31,6 +31,7 @@
 #ifndef __GPU_STANDALONE_HH__
 #define __GPU_STANDALONE_HH__
 
+#include <atomic>
 #include <thread>
 #include "base/statistics.hh"
 #include "base/types.hh"
@@ -49,8 +50,14 @@ class GraphicsStandalone : public ClockedObject
     GraphicsStandalone(const Params *p);
     ~GraphicsStandalone();
     virtual void init();
+    virtual void startup();
     // main simulation loop
     void tick();
+
+    //checkpoints are taken at frame boundaries, the trace is replayed up
+    //to the checkpoint frame on restore
+    virtual void serialize(CheckpointOut &cp) const;
+    virtual void unserialize(CheckpointIn &cp);
     //Port to physical memory
     const PortProxy physProxy;
 
@@ -73,7 +80,9 @@ class GraphicsStandalone : public ClockedObject
 
     TickEvent tickEvent;
     bool traceStarted;
-    bool traceDone;
+    std::atomic<bool> traceDone;
+    //a checkpoint was requested at the last simulation loop exit
+    bool checkpointTaken;
     Tick simCycles;
     std::string tracePath;
 
@@ -0,0 +1,215 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cassert>
+
+#include "graphics/hiz_pyramid.hh"
+
+HizPyramid::HizPyramid():
+    m_maxLevels(0), m_active(false), m_func(GL_LESS), m_queries(0),
+    m_primCulls(0), m_blockCulls(0), m_tilesCulled(0), m_fragmentsCulled(0)
+{}
+
+void
+HizPyramid::configure(unsigned levels)
+{
+    m_maxLevels = levels;
+    m_levelCulls = std::vector<std::atomic<uint64_t> >(levels + 1);
+    for (unsigned l = 0; l < m_levelCulls.size(); l++)
+        m_levelCulls[l] = 0;
+}
+
+void
+HizPyramid::reset(unsigned wTiles, unsigned hTiles, GLenum depthFunc)
+{
+    assert(enabled());
+    m_func = depthFunc;
+    //GL_NOTEQUAL writes can widen a range and GL_ALWAYS never fails
+    m_active = depthFunc != GL_NOTEQUAL and depthFunc != GL_ALWAYS;
+
+    m_levels.clear();
+    unsigned w = wTiles;
+    unsigned h = hTiles;
+    do {
+        level_t level;
+        level.w = w;
+        level.h = h;
+        level.minDepth.assign(w * h, (uint64_t) -1);
+        level.maxDepth.assign(w * h, 0);
+        m_levels.push_back(level);
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+    } while (m_levels.size() <= m_maxLevels and
+          (m_levels.back().w > 1 or m_levels.back().h > 1));
+}
+
+void
+HizPyramid::addTileRange(unsigned x, unsigned y, uint64_t minDepth,
+      uint64_t maxDepth)
+{
+    level_t& level = m_levels[0];
+    assert(x < level.w and y < level.h);
+    const unsigned idx = y * level.w + x;
+    level.minDepth[idx] = std::min(level.minDepth[idx], minDepth);
+    level.maxDepth[idx] = std::max(level.maxDepth[idx], maxDepth);
+}
+
+void
+HizPyramid::mergeNode(unsigned l, unsigned x, unsigned y)
+{
+    assert(l > 0);
+    const level_t& child = m_levels[l - 1];
+    level_t& level = m_levels[l];
+    uint64_t minDepth = (uint64_t) -1;
+    uint64_t maxDepth = 0;
+    for (unsigned cy = 2 * y; cy < std::min(2 * y + 2, child.h); cy++) {
+        for (unsigned cx = 2 * x; cx < std::min(2 * x + 2, child.w); cx++) {
+            minDepth = std::min(minDepth, child.minDepth[cy * child.w + cx]);
+            maxDepth = std::max(maxDepth, child.maxDepth[cy * child.w + cx]);
+        }
+    }
+    level.minDepth[y * level.w + x] = minDepth;
+    level.maxDepth[y * level.w + x] = maxDepth;
+}
+
+void
+HizPyramid::build()
+{
+    for (unsigned l = 1; l < m_levels.size(); l++)
+        for (unsigned y = 0; y < m_levels[l].h; y++)
+            for (unsigned x = 0; x < m_levels[l].w; x++)
+                mergeNode(l, x, y);
+}
+
+void
+HizPyramid::updateTile(unsigned x, unsigned y, uint64_t minDepth,
+      uint64_t maxDepth)
+{
+    level_t& level = m_levels[0];
+    assert(x < level.w and y < level.h);
+    level.minDepth[y * level.w + x] = minDepth;
+    level.maxDepth[y * level.w + x] = maxDepth;
+    for (unsigned l = 1; l < m_levels.size(); l++)
+        mergeNode(l, x >> l, y >> l);
+}
+
+bool
+HizPyramid::rejectNode(unsigned l, unsigned idx, uint64_t minDepth,
+      uint64_t maxDepth) const
+{
+    const uint64_t nodeMin = m_levels[l].minDepth[idx];
+    const uint64_t nodeMax = m_levels[l].maxDepth[idx];
+    //nothing was stored, the node lies outside of the frame
+    if (nodeMin > nodeMax)
+        return true;
+    switch (m_func) {
+      case GL_NEVER: return true;
+      case GL_LESS: return minDepth >= nodeMax;
+      case GL_LEQUAL: return minDepth > nodeMax;
+      case GL_GREATER: return maxDepth <= nodeMin;
+      case GL_GEQUAL: return maxDepth < nodeMin;
+      case GL_EQUAL: return maxDepth < nodeMin or minDepth > nodeMax;
+      default: return false;
+    }
+}
+
+bool
+HizPyramid::rejectRectAt(unsigned l, unsigned x0, unsigned y0,
+      unsigned x1, unsigned y1, uint64_t minDepth, uint64_t maxDepth)
+{
+    const level_t& level = m_levels[l];
+    for (unsigned ny = y0 >> l; ny <= (y1 >> l); ny++) {
+        for (unsigned nx = x0 >> l; nx <= (x1 >> l); nx++) {
+            if (rejectNode(l, ny * level.w + nx, minDepth, maxDepth)) {
+                m_levelCulls[l].fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            if (l == 0)
+                return false;
+            //refine the part of the rectangle covered by this node
+            const unsigned cx0 = std::max(x0, nx << l);
+            const unsigned cy0 = std::max(y0, ny << l);
+            const unsigned cx1 = std::min(x1, ((nx + 1) << l) - 1);
+            const unsigned cy1 = std::min(y1, ((ny + 1) << l) - 1);
+            if (!rejectRectAt(l - 1, cx0, cy0, cx1, cy1, minDepth, maxDepth))
+                return false;
+        }
+    }
+    return true;
+}
+
+bool
+HizPyramid::rejectRect(unsigned x0, unsigned y0, unsigned x1, unsigned y1,
+      uint64_t minDepth, uint64_t maxDepth)
+{
+    if (!m_active or m_levels.empty())
+        return false;
+    assert(x0 <= x1 and y0 <= y1);
+    x1 = std::min(x1, m_levels[0].w - 1);
+    y1 = std::min(y1, m_levels[0].h - 1);
+    if (x0 > x1 or y0 > y1)
+        return true;
+    m_queries.fetch_add(1, std::memory_order_relaxed);
+
+    //start from the finest level where the rectangle spans at most 2x2 nodes
+    unsigned l = 0;
+    while (l + 1 < m_levels.size() and
+          (((x1 >> l) - (x0 >> l)) > 1 or ((y1 >> l) - (y0 >> l)) > 1))
+        l++;
+    return rejectRectAt(l, x0, y0, x1, y1, minDepth, maxDepth);
+}
+
+void
+HizPyramid::recordPrimCull(unsigned fragments)
+{
+    m_primCulls.fetch_add(1, std::memory_order_relaxed);
+    m_fragmentsCulled.fetch_add(fragments, std::memory_order_relaxed);
+}
+
+void
+HizPyramid::recordBlockCull(unsigned tiles, unsigned fragments)
+{
+    m_blockCulls.fetch_add(1, std::memory_order_relaxed);
+    m_tilesCulled.fetch_add(tiles, std::memory_order_relaxed);
+    m_fragmentsCulled.fetch_add(fragments, std::memory_order_relaxed);
+}
+
+void
+HizPyramid::printStats(std::ostream& out) const
+{
+    if (!enabled())
+        return;
+    out << "hiz pyramid queries: " << m_queries << "\n";
+    for (unsigned l = 0; l < m_levelCulls.size(); l++)
+        out << "hiz pyramid level " << l << " node culls: "
+            << m_levelCulls[l] << "\n";
+    out << "hiz pyramid culled primitives: " << m_primCulls << "\n";
+    out << "hiz pyramid culled tc blocks: " << m_blockCulls << "\n";
+    out << "hiz pyramid culled tiles: " << m_tilesCulled << "\n";
+    out << "hiz pyramid culled fragments: " << m_fragmentsCulled << "\n";
+}
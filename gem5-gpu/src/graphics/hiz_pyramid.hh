@@ -0,0 +1,110 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef __HIZ_PYRAMID_HH__
+#define __HIZ_PYRAMID_HH__
+
+#include <GL/gl.h>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/*
+ * Multi-level min/max depth pyramid over the raster tile grid. Level 0 holds
+ * the depth range of each raster tile of the depth buffer, every level above
+ * it merges 2x2 nodes of the level below. Whole primitives or TC blocks are
+ * tested against the coarsest nodes that cover them and only refined where a
+ * coarse node cannot reject, so most rejections cost a handful of tests and
+ * happen before any raster tile is created.
+ *
+ * Unlike the per-tile front/back HiZ, the pyramid keeps plain min/max values
+ * so GL_EQUAL can be culled as well. The ranges stay conservative during a
+ * draw call because depth writes only move values in the passing direction;
+ * tiles that are fully overwritten tighten them through updateTile().
+ */
+class HizPyramid {
+  public:
+    HizPyramid();
+
+    //levels above the raster tile level, 0 disables the pyramid
+    void configure(unsigned levels);
+    bool enabled() const { return m_maxLevels > 0; }
+
+    //starts rebuilding the pyramid for a draw call
+    void reset(unsigned wTiles, unsigned hTiles, GLenum depthFunc);
+    //merges a span of depth values of tile (x, y) into level 0
+    void addTileRange(unsigned x, unsigned y, uint64_t minDepth,
+          uint64_t maxDepth);
+    //computes the coarse levels once level 0 is complete
+    void build();
+    //tile (x, y) was completely overwritten with depths in [min, max]
+    void updateTile(unsigned x, unsigned y, uint64_t minDepth,
+          uint64_t maxDepth);
+
+    //true if the current depth function can be culled with the pyramid
+    bool active() const { return m_active; }
+    //true if no fragment with a depth in [minDepth, maxDepth] inside the
+    //tiles [x0, x1] x [y0, y1] can pass the depth test, safe to call from
+    //the raster workers while the pyramid is not being updated
+    bool rejectRect(unsigned x0, unsigned y0, unsigned x1, unsigned y1,
+          uint64_t minDepth, uint64_t maxDepth);
+
+    void recordPrimCull(unsigned fragments);
+    void recordBlockCull(unsigned tiles, unsigned fragments);
+    void printStats(std::ostream& out) const;
+
+  private:
+    struct level_t {
+        unsigned w;
+        unsigned h;
+        std::vector<uint64_t> minDepth;
+        std::vector<uint64_t> maxDepth;
+    };
+
+    bool rejectNode(unsigned level, unsigned idx, uint64_t minDepth,
+          uint64_t maxDepth) const;
+    bool rejectRectAt(unsigned level, unsigned x0, unsigned y0,
+          unsigned x1, unsigned y1, uint64_t minDepth, uint64_t maxDepth);
+    void mergeNode(unsigned level, unsigned x, unsigned y);
+
+    unsigned m_maxLevels;
+    bool m_active;
+    GLenum m_func;
+    std::vector<level_t> m_levels;
+
+    //statistics, counted atomically so raster worker queries do not
+    //serialize on each other
+    std::vector<std::atomic<uint64_t> > m_levelCulls;
+    std::atomic<uint64_t> m_queries;
+    std::atomic<uint64_t> m_primCulls;
+    std::atomic<uint64_t> m_blockCulls;
+    std::atomic<uint64_t> m_tilesCulled;
+    std::atomic<uint64_t> m_fragmentsCulled;
+};
+
+#endif // __HIZ_PYRAMID_HH__
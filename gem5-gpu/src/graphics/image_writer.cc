@@ -0,0 +1,437 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cassert>
+#include <chrono>
+#include <fstream>
+#include <zlib.h>
+
+#include "base/misc.hh"
+#include "base/trace.hh"
+#include "debug/MesaGpgpusim.hh"
+#include "graphics/image_writer.hh"
+
+//frames between two keyframes in the delta container
+static const unsigned deltaKeyframePeriod = 32;
+
+static void putBe32(std::vector<uint8_t>& buf, uint32_t val)
+{
+    buf.push_back(val >> 24);
+    buf.push_back(val >> 16);
+    buf.push_back(val >> 8);
+    buf.push_back(val);
+}
+
+static void putLe32(std::ofstream& out, uint32_t val)
+{
+    const char bytes[4] = {(char) val, (char) (val >> 8),
+        (char) (val >> 16), (char) (val >> 24)};
+    out.write(bytes, 4);
+}
+
+static bool deflateBuffer(const std::vector<uint8_t>& in,
+      std::vector<uint8_t>& out)
+{
+    uLongf size = compressBound(in.size());
+    out.resize(size);
+    //favour speed, dumps are written for every draw call
+    if (compress2(out.data(), &size, in.data(), in.size(), Z_BEST_SPEED)
+          != Z_OK)
+        return false;
+    out.resize(size);
+    return true;
+}
+
+static void writePngChunk(std::ofstream& out, const char* type,
+      const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> header;
+    putBe32(header, data.size());
+    header.insert(header.end(), type, type + 4);
+    out.write((const char*) header.data(), header.size());
+    if (!data.empty())
+        out.write((const char*) data.data(), data.size());
+    uLong crc = crc32(0L, (const Bytef*) type, 4);
+    if (!data.empty())
+        crc = crc32(crc, data.data(), data.size());
+    std::vector<uint8_t> trailer;
+    putBe32(trailer, crc);
+    out.write((const char*) trailer.data(), trailer.size());
+}
+
+static unsigned sourcePixelSize(const ImageWriter::Layout& layout)
+{
+    if (layout.channels == "gray")
+        return (layout.bitDepth + 7) / 8;
+    return layout.channels.size() * ((layout.bitDepth + 7) / 8);
+}
+
+ImageWriter::ImageWriter():
+    m_format(Format::Png), m_queueDepth(8), m_busy(false), m_stop(false),
+    m_thread(NULL), m_queued(0), m_written(0), m_bytesIn(0), m_bytesOut(0),
+    m_stalls(0), m_encodeSeconds(0)
+{}
+
+ImageWriter::~ImageWriter()
+{
+    if (m_thread == NULL)
+        return;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_notEmpty.notify_all();
+    m_thread->join();
+    delete m_thread;
+}
+
+void
+ImageWriter::init(const std::string& format, unsigned queueDepth)
+{
+    if (format == "png")
+        m_format = Format::Png;
+    else if (format == "ppm")
+        m_format = Format::Ppm;
+    else if (format == "raw")
+        m_format = Format::Raw;
+    else if (format == "delta")
+        m_format = Format::Delta;
+    else if (format == "none")
+        m_format = Format::None;
+    else
+        fatal("Unknown frame dump format %s\n", format.c_str());
+    m_queueDepth = queueDepth > 0? queueDepth : 1;
+}
+
+void
+ImageWriter::write(const std::string& path, const std::string& stream,
+      const uint8_t* data, size_t size, const Layout& layout)
+{
+    if (!enabled())
+        return;
+    assert(size >= (size_t) layout.width * layout.height
+          * sourcePixelSize(layout));
+
+    Job job;
+    job.path = path;
+    job.stream = stream;
+    job.layout = layout;
+    job.data.assign(data, data + size);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_thread == NULL)
+        m_thread = new std::thread(&ImageWriter::run, this);
+    if (m_queue.size() >= m_queueDepth) {
+        m_stalls++;
+        m_notFull.wait(lock, [this] {
+            return m_queue.size() < m_queueDepth;
+        });
+    }
+    m_queue.push_back(std::move(job));
+    m_queued++;
+    m_bytesIn += size;
+    lock.unlock();
+    m_notEmpty.notify_one();
+}
+
+void
+ImageWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_queue.empty() and !m_busy; });
+}
+
+void
+ImageWriter::run()
+{
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_notEmpty.wait(lock, [this] {
+                return m_stop or !m_queue.empty();
+            });
+            if (m_queue.empty()) {
+                //only reached when stopping with nothing left to write
+                return;
+            }
+            job = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_busy = true;
+        }
+        m_notFull.notify_one();
+
+        auto start = std::chrono::steady_clock::now();
+        encode(job);
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_busy = false;
+            m_written++;
+            m_encodeSeconds += elapsed.count();
+        }
+        m_idle.notify_all();
+    }
+}
+
+void
+ImageWriter::encode(Job& job)
+{
+    switch (m_format) {
+      case Format::Png: writePng(job); break;
+      case Format::Ppm: writePpm(job); break;
+      case Format::Raw: writeRaw(job); break;
+      case Format::Delta: appendDelta(job); break;
+      default: assert(0);
+    }
+}
+
+unsigned
+ImageWriter::toPixels(const Job& job, bool alpha,
+      std::vector<uint8_t>& out) const
+{
+    const Layout& layout = job.layout;
+    const unsigned srcPixel = sourcePixelSize(layout);
+    const size_t srcStride = (size_t) layout.width * srcPixel;
+
+    if (layout.channels == "gray") {
+        const unsigned sampleBytes = srcPixel;
+        const unsigned dstPixel = sampleBytes > 1? 2 : 1;
+        out.resize((size_t) layout.width * layout.height * dstPixel);
+        uint8_t* dst = out.data();
+        for (unsigned row = 0; row < layout.height; row++) {
+            unsigned srcRow = layout.flip? layout.height - row - 1 : row;
+            const uint8_t* src = job.data.data() + srcRow * srcStride;
+            for (unsigned x = 0; x < layout.width; x++) {
+                //samples are in host (little-endian) order, keep the MSBs
+                uint32_t val = 0;
+                for (unsigned b = 0; b < sampleBytes; b++)
+                    val |= (uint32_t) src[b] << (8 * b);
+                src += sampleBytes;
+                if (dstPixel == 1) {
+                    *dst++ = val;
+                } else {
+                    val >>= 8 * (sampleBytes - 2);
+                    *dst++ = val >> 8;
+                    *dst++ = val;
+                }
+            }
+        }
+        return dstPixel;
+    }
+
+    //color buffers are 8 bits per channel
+    assert(layout.bitDepth == 8);
+    int offset[4] = {-1, -1, -1, -1};
+    const char* order = "rgba";
+    for (unsigned c = 0; c < 4; c++) {
+        size_t pos = layout.channels.find(order[c]);
+        if (pos != std::string::npos)
+            offset[c] = pos;
+    }
+    const unsigned dstPixel = alpha? 4 : 3;
+    out.resize((size_t) layout.width * layout.height * dstPixel);
+    uint8_t* dst = out.data();
+    for (unsigned row = 0; row < layout.height; row++) {
+        unsigned srcRow = layout.flip? layout.height - row - 1 : row;
+        const uint8_t* src = job.data.data() + srcRow * srcStride;
+        for (unsigned x = 0; x < layout.width; x++) {
+            for (unsigned c = 0; c < dstPixel; c++)
+                *dst++ = offset[c] >= 0? src[offset[c]] : 0xff;
+            src += srcPixel;
+        }
+    }
+    return dstPixel;
+}
+
+void
+ImageWriter::writePng(const Job& job)
+{
+    const Layout& layout = job.layout;
+    const bool gray = layout.channels == "gray";
+    std::vector<uint8_t> pixels;
+    const unsigned pixelSize = toPixels(job, true, pixels);
+    const unsigned sampleBytes = gray? pixelSize : 1;
+    const size_t stride = (size_t) layout.width * pixelSize;
+
+    //each scanline is prefixed by its filter type, use Sub (1)
+    std::vector<uint8_t> filtered(layout.height * (stride + 1));
+    uint8_t* dst = filtered.data();
+    for (unsigned row = 0; row < layout.height; row++) {
+        const uint8_t* src = pixels.data() + row * stride;
+        *dst++ = 1;
+        for (size_t i = 0; i < stride; i++)
+            *dst++ = src[i] - (i >= pixelSize? src[i - pixelSize] : 0);
+    }
+
+    std::vector<uint8_t> idat;
+    if (!deflateBuffer(filtered, idat)) {
+        warn("Unable to compress frame dump %s\n", job.path.c_str());
+        return;
+    }
+
+    std::vector<uint8_t> ihdr;
+    putBe32(ihdr, layout.width);
+    putBe32(ihdr, layout.height);
+    ihdr.push_back(8 * sampleBytes);
+    //color type: 0 gray, 6 RGBA
+    ihdr.push_back(gray? 0 : 6);
+    ihdr.push_back(0);
+    ihdr.push_back(0);
+    ihdr.push_back(0);
+
+    std::string path = job.path + ".png";
+    std::ofstream out(path, std::ios::out | std::ios::binary);
+    if (!out) {
+        warn("Unable to open frame dump %s\n", path.c_str());
+        return;
+    }
+    static const char signature[8] =
+        {(char) 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    out.write(signature, sizeof(signature));
+    writePngChunk(out, "IHDR", ihdr);
+    writePngChunk(out, "IDAT", idat);
+    writePngChunk(out, "IEND", std::vector<uint8_t>());
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_bytesOut += out.tellp();
+}
+
+void
+ImageWriter::writePpm(const Job& job)
+{
+    const Layout& layout = job.layout;
+    const bool gray = layout.channels == "gray";
+    std::vector<uint8_t> pixels;
+    const unsigned pixelSize = toPixels(job, false, pixels);
+
+    std::string path = job.path + ".ppm";
+    std::ofstream out(path, std::ios::out | std::ios::binary);
+    if (!out) {
+        warn("Unable to open frame dump %s\n", path.c_str());
+        return;
+    }
+    out << (gray? "P5" : "P6") << "\n" << layout.width << " "
+        << layout.height << "\n" << (gray and pixelSize > 1? 65535 : 255)
+        << "\n";
+    out.write((const char*) pixels.data(), pixels.size());
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_bytesOut += out.tellp();
+}
+
+void
+ImageWriter::writeRaw(const Job& job)
+{
+    std::ofstream out(job.path, std::ios::out | std::ios::binary);
+    if (!out) {
+        warn("Unable to open frame dump %s\n", job.path.c_str());
+        return;
+    }
+    out.write((const char*) job.data.data(), job.data.size());
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_bytesOut += job.data.size();
+}
+
+void
+ImageWriter::appendDelta(Job& job)
+{
+    auto it = m_deltaStreams.find(job.stream);
+    if (it == m_deltaStreams.end()) {
+        std::string dir = job.path.substr(0, job.path.rfind('/') + 1);
+        DeltaStream& ds = m_deltaStreams[job.stream];
+        ds.path = dir + "gpgpusimBuffer_" + job.stream + ".gsf";
+        ds.framesSinceKey = 0;
+        std::ofstream out(ds.path, std::ios::out | std::ios::binary
+              | std::ios::trunc);
+        out.write("GSFRAMES", 8);
+        it = m_deltaStreams.find(job.stream);
+    }
+    DeltaStream& ds = it->second;
+
+    const bool keyframe = ds.lastFrame.size() != job.data.size()
+        or ds.framesSinceKey >= deltaKeyframePeriod;
+    std::vector<uint8_t> payload;
+    if (keyframe) {
+        ds.framesSinceKey = 0;
+        ds.lastFrame = job.data;
+    } else {
+        ds.framesSinceKey++;
+        //unchanged bytes become zero runs that deflate well
+        for (size_t i = 0; i < job.data.size(); i++) {
+            uint8_t cur = job.data[i];
+            job.data[i] ^= ds.lastFrame[i];
+            ds.lastFrame[i] = cur;
+        }
+    }
+    if (!deflateBuffer(job.data, payload)) {
+        warn("Unable to compress frame dump %s\n", job.path.c_str());
+        //the next frame must not be a delta against a frame never written
+        ds.lastFrame.clear();
+        return;
+    }
+
+    std::ofstream out(ds.path, std::ios::out | std::ios::binary
+          | std::ios::app);
+    if (!out) {
+        warn("Unable to open frame dump %s\n", ds.path.c_str());
+        return;
+    }
+    std::string name = job.path.substr(job.path.rfind('/') + 1);
+    const Layout& layout = job.layout;
+    putLe32(out, name.size());
+    out.write(name.data(), name.size());
+    putLe32(out, layout.width);
+    putLe32(out, layout.height);
+    putLe32(out, layout.bitDepth);
+    putLe32(out, layout.channels.size());
+    out.write(layout.channels.data(), layout.channels.size());
+    out.put((keyframe? 1 : 0) | (layout.flip? 2 : 0));
+    putLe32(out, job.data.size());
+    putLe32(out, payload.size());
+    out.write((const char*) payload.data(), payload.size());
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_bytesOut += 29 + name.size() + layout.channels.size() + payload.size();
+}
+
+void
+ImageWriter::printStats(std::ostream& out) const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_queued == 0)
+        return;
+    out << "frame dumps queued: " << m_queued << "\n";
+    out << "frame dumps written: " << m_written << "\n";
+    out << "frame dump bytes in: " << m_bytesIn << "\n";
+    out << "frame dump bytes out: " << m_bytesOut << "\n";
+    out << "frame dump queue stalls: " << m_stalls << "\n";
+    out << "frame dump encode time (s): " << m_encodeSeconds << "\n";
+}
@@ -0,0 +1,142 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef __IMAGE_WRITER_HH__
+#define __IMAGE_WRITER_HH__
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Writes framebuffer and texture dumps from a background thread. Callers hand
+ * over a copy of the buffer and return immediately; the writer thread does the
+ * vertical flip, channel swizzle and encoding. The queue is bounded, when it is
+ * full the simulation waits for the writer to catch up instead of growing the
+ * host memory footprint without limit.
+ *
+ * Supported formats:
+ *  png:   RGBA8 for color buffers, 8/16-bit gray for depth buffers
+ *  ppm:   binary P6/P5
+ *  raw:   the unmodified buffer bytes
+ *  delta: all frames of a stream appended to a single container file, each
+ *         frame XORed with the previous frame of the same stream and deflated
+ *  none:  dumps are disabled
+ *
+ * Delta container layout (little-endian), one file per stream:
+ *  "GSFRAMES" then per frame:
+ *  u32 name length, name, u32 width, u32 height, u32 bit depth,
+ *  u32 channels length, channels, u8 flags (1: keyframe, 2: rows bottom-up),
+ *  u32 raw size,
+ *  u32 payload size, payload (zlib, XOR with the previous frame unless keyframe)
+ */
+class ImageWriter {
+  public:
+    enum class Format { None, Png, Ppm, Raw, Delta };
+
+    //how the source buffer is laid out
+    struct Layout {
+        Layout(): width(0), height(0), bitDepth(8), flip(false) {}
+        unsigned width;
+        unsigned height;
+        //channel order in memory, e.g., "bgra", "rgba" or "gray"
+        std::string channels;
+        //bits per channel
+        unsigned bitDepth;
+        //rows are stored bottom-up
+        bool flip;
+    };
+
+    ImageWriter();
+    ~ImageWriter();
+
+    void init(const std::string& format, unsigned queueDepth);
+    bool enabled() const { return m_format != Format::None; }
+    Format format() const { return m_format; }
+
+    //queues a copy of data, stream groups frames in the delta container
+    void write(const std::string& path, const std::string& stream,
+          const uint8_t* data, size_t size, const Layout& layout);
+    //blocks until all queued images are on disk
+    void flush();
+    void printStats(std::ostream& out) const;
+
+  private:
+    struct Job {
+        std::string path;
+        std::string stream;
+        Layout layout;
+        std::vector<uint8_t> data;
+    };
+
+    struct DeltaStream {
+        std::string path;
+        std::vector<uint8_t> lastFrame;
+        unsigned framesSinceKey;
+    };
+
+    void run();
+    void encode(Job& job);
+    void writePng(const Job& job);
+    void writePpm(const Job& job);
+    void writeRaw(const Job& job);
+    void appendDelta(Job& job);
+    //converts the source rows to top-down RGBA8/RGB8 or gray8/gray16 (big-endian)
+    unsigned toPixels(const Job& job, bool alpha,
+          std::vector<uint8_t>& out) const;
+
+    Format m_format;
+    unsigned m_queueDepth;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+    std::condition_variable m_idle;
+    std::deque<Job> m_queue;
+    bool m_busy;
+    bool m_stop;
+    std::thread* m_thread;
+
+    //only touched by the writer thread
+    std::map<std::string, DeltaStream> m_deltaStreams;
+
+    //statistics, guarded by m_mutex
+    uint64_t m_queued;
+    uint64_t m_written;
+    uint64_t m_bytesIn;
+    uint64_t m_bytesOut;
+    uint64_t m_stalls;
+    double m_encodeSeconds;
+};
+
+#endif // __IMAGE_WRITER_HH__
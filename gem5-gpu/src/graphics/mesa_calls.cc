@@ -1,4 +1,5 @@
 #include <cmath> 
+#include <algorithm>
 #include "mesa_gpgpusim.h"
 #include "base/output.hh"
 
@@ -64,22 +65,17 @@ extern "C" void gpgpusimAddFragQuad(struct  tgsi_exec_machine *mach,
     }
 
     //add input files
+    fragmentAttribStore_t& attribs = g_renderData.getFragmentAttribs();
+    attribs.setInputsCount(std::max(lastInput - firstInput + 1, 0));
     for (int j = 0; j < TGSI_QUAD_SIZE; j++) {
+      frags[j].attribIdx = attribs.addFragment();
       for (int i = firstInput; i <= lastInput; ++i) {
-        ch4_t elm;
-        elm[0] = mach->Inputs[i].xyzw[0].f[j];
-        elm[1] = mach->Inputs[i].xyzw[1].f[j];
-        elm[2] = mach->Inputs[i].xyzw[2].f[j];
-        elm[3] = mach->Inputs[i].xyzw[3].f[j];
-        frags[j].inputs.push_back(elm);
+        for (int c = 0; c < TGSI_NUM_CHANNELS; c++) {
+          attribs.input(frags[j].attribIdx, i - firstInput, c) =
+            mach->Inputs[i].xyzw[c].f[j];
+        }
       }
     }
-
-    for (int j = 0; j < TGSI_QUAD_SIZE; j++) {
-       for (int k= 0; k < TGSI_QUAD_SIZE; k++) {
-          frags[j].mesaQuadFrags[k] = &frags[k];
-       }
-    }
     g_renderData.addFragmentsQuad(frags);
 }
 
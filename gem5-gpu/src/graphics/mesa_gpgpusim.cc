@@ -26,6 +26,7 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <assert.h>
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <fstream>
@@ -35,6 +36,7 @@
 #include <map>
 #include <sstream>
 #include <stack>
+#include <string.h>
 #include <sys/stat.h>
 #include <time.h>
 #include <thread>
@@ -173,6 +175,10 @@ shaderAttrib_t primitiveFragmentsData_t::getFragmentData(unsigned utid, unsigned
 void primitiveFragmentsData_t::addFragment(fragmentData_t fd) {
     maxDepth = std::max(maxDepth, (uint64_t) fd.uintPos(2));
     minDepth = std::min(minDepth, (uint64_t) fd.uintPos(2));
+    m_minXPos = std::min(m_minXPos, (unsigned) fd.uintPos(0));
+    m_maxXPos = std::max(m_maxXPos, (unsigned) fd.uintPos(0));
+    m_minYPos = std::min(m_minYPos, (unsigned) fd.uintPos(1));
+    m_maxYPos = std::max(m_maxYPos, (unsigned) fd.uintPos(1));
     m_fragments.push_back(fd);
 }
 
@@ -305,7 +311,9 @@ void renderData_t::runEarlyZ(CudaGPU * cudaGPU, unsigned tileH, unsigned tileW,
             m_tile_H, m_tile_W, 
             m_hTiles, m_wTiles,
             m_tilesCount,
-            blockH, blockW, dir, clusterCount);
+            blockH, blockW, dir, clusterCount,
+            &m_sShading_info.rasterArena,
+            getHizPyramid());
       RasterTiles& primTiles = drawPrimitives[prim].getRasterTiles();
       DPRINTF(MesaGpgpusim, "prim %d tiles = %ld\n", prim, primTiles.size());
       for(int tile=0; tile < primTiles.size(); tile++){
@@ -338,7 +346,9 @@ void primitiveFragmentsData_t::sortFragmentsInTiles(
       unsigned tcH,
       unsigned tcW,
       unsigned tcBlockDim,
-      unsigned clusterCount) {
+      unsigned clusterCount,
+      drawCallArena_t* arena,
+      HizPyramid* hiz) {
    
     assert(m_rasterTiles.size() == 0);
     assert(rasterDir==RasterDirection::HorizontalRaster);
@@ -363,92 +373,118 @@ void primitiveFragmentsData_t::sortFragmentsInTiles(
     
 
 
-    DPRINTF(MesaGpgpusim, "Sorting %d framgents in %d tiles \n", m_fragments.size(), tilesCount);
-
-    int minX, maxX, minY, maxY;
-    minX = minY = -1;
-    maxX = maxY = -1;
-
-    std::unordered_map<unsigned, RasterTile* > fragmentTiles;
-    /*std::vector<RasterTile* > fragmentTiles;
-    for (unsigned tileId = 0; tileId < tilesCount; tileId++) {
-        //std::vector<fragmentData_t>* aSet = new std::vector<fragmentData_t>();
-        unsigned xCoord = tileId%wTiles;
-        unsigned yCoord = tileId/wTiles;
-        RasterTile * rtile = new RasterTile(this, primId, tileId,
-              tileH, tileW, xCoord, yCoord);
-        fragmentTiles.push_back(rtile);
-    }
-    assert(fragmentTiles.size() == tilesCount);
-     */
-
     assert((frameWidth%tileW) == 0);
     //assert((frameHeight%tileH) == 0);
-            
-    //unsigned const numberOfHorizontalTiles = frameWidth / tileW;
-    
-    //now we figure which tile every fragment belongs to
-    for (int frag = 0; frag < m_fragments.size(); frag++) {
-        unsigned xPosition = m_fragments[frag].uintPos(0);
-        unsigned yPosition = m_fragments[frag].uintPos(1);
-        unsigned tileXCoord = xPosition / tileW;
-        unsigned tileYCoord = yPosition / tileH; //normalize this guy
-        minX = (minX == -1)? tileXCoord: std::min(minX, (int)tileXCoord);
-        maxX = (maxX == -1)? tileXCoord: std::max(maxX, (int)tileXCoord);
-        minY = (minY == -1)? tileYCoord: std::min(minY, (int)tileYCoord);
-        maxY = (maxY == -1)? tileYCoord: std::max(maxY, (int)tileYCoord);
-        assert(tileXCoord<wTiles);
-        unsigned tileIndex = tileYCoord * wTiles + tileXCoord;
-        if(fragmentTiles.find(tileIndex) == fragmentTiles.end()){
-           fragmentTiles[tileIndex] = new RasterTile(this, primId, tileIndex,
-              tileH, tileW, tileXCoord, tileYCoord);
-        }
-        fragmentTiles[tileIndex]->addFragment(&m_fragments[frag]);
-        //make sure that we do not add more fragments in each tile than we should have
-        assert(fragmentTiles[tileIndex]->size() <= (tileH * tileW));
-    }
-
-    //we need to set active frags count tally
-    unsigned fragCount = 0;
-    for(int i=0; i< tilesCount; i++){
-       if(fragmentTiles.find(i)!= fragmentTiles.end())
-          fragCount += fragmentTiles[i]->resetActiveCount();
-    }
-    assert(fragCount == m_fragments.size());
 
     m_simtRasterTiles.resize(clusterCount);
-    unsigned tcSize = tcH*tcW;
-    unsigned tcBlockInTilesH = tcBlockDim*tcH;
-    unsigned tcBlockInTilesW = tcBlockDim*tcW;
-    unsigned tbpw = tcBlockInTilesW * tileW;
-    unsigned xTCBlocks = frameWidth%tbpw>0? 
-       ((frameWidth - (frameWidth % tbpw)) + tbpw)/tbpw : frameWidth/tbpw;
-    for(int tile=0; tile < tilesCount; tile++){
-       if(fragmentTiles.find(tile)!= fragmentTiles.end()){
-          if(fragmentTiles[tile]->xCoord >= minX and 
-                fragmentTiles[tile]->xCoord <= maxX and 
-                fragmentTiles[tile]->yCoord >= minY and 
-                fragmentTiles[tile]->yCoord <= maxY){
-             unsigned tcBlockX = fragmentTiles[tile]->xCoord/tcBlockInTilesW;
-             unsigned tcBlockY = fragmentTiles[tile]->yCoord/tcBlockInTilesH;
-             unsigned tcBlockId = (tcBlockY * xTCBlocks) + tcBlockX;
-             m_simtRasterTiles[tcBlockId%clusterCount].push_back(fragmentTiles[tile]);
-             assert(fragmentTiles[tile]->getActiveCount() != 0);
-             /*printf("assigning tile %d to cluster %d\n", tile,
-               tcBlockId%clusterCount);*/
-             //m_rasterTiles.push_back(fragmentTiles[tile]);
-          } else {
-             //all tiles should have some frags
-             assert(0);
-             /*assert(fragmentTiles[tile]->getActiveCount() == 0);
-             delete fragmentTiles[tile];*/
+
+    if(m_fragments.size() > 0 and hiz != NULL
+          and hiz->rejectRect(m_minXPos / tileW, m_minYPos / tileH,
+             m_maxXPos / tileW, m_maxYPos / tileH, minDepth, maxDepth)){
+       //the whole primitive is hidden, no tiles are created for it
+       hiz->recordPrimCull(m_fragments.size());
+    } else if(m_fragments.size() > 0){
+       //tiles are only created inside the primitive bounding box, which is
+       //tracked as fragments are added, so the tile table is a flat array
+       //indexed relative to the box instead of a hash map over the frame
+       const unsigned minX = m_minXPos / tileW;
+       const unsigned maxX = m_maxXPos / tileW;
+       const unsigned minY = m_minYPos / tileH;
+       const unsigned maxY = m_maxYPos / tileH;
+       assert(maxX < wTiles);
+       const unsigned bboxW = maxX - minX + 1;
+       const unsigned bboxH = maxY - minY + 1;
+       RasterTile** fragmentTiles =
+          arena->createArray<RasterTile*>(bboxW*bboxH);
+
+       unsigned tcBlockInTilesH = tcBlockDim*tcH;
+       unsigned tcBlockInTilesW = tcBlockDim*tcW;
+       unsigned tbpw = tcBlockInTilesW * tileW;
+       unsigned xTCBlocks = frameWidth%tbpw>0? 
+          ((frameWidth - (frameWidth % tbpw)) + tbpw)/tbpw : frameWidth/tbpw;
+
+       //depth range of the primitive inside each TC block it touches,
+       //blocks that are entirely hidden are culled as a whole
+       const unsigned minBX = minX/tcBlockInTilesW;
+       const unsigned minBY = minY/tcBlockInTilesH;
+       const unsigned bboxBW = maxX/tcBlockInTilesW - minBX + 1;
+       const unsigned bboxBH = maxY/tcBlockInTilesH - minBY + 1;
+       tcBlockCull_t* blocks = NULL;
+       if(hiz != NULL and hiz->active() and bboxBW*bboxBH > 1){
+          blocks = arena->createArray<tcBlockCull_t>(bboxBW*bboxBH);
+       }
+
+       //now we figure which tile every fragment belongs to
+       for (int frag = 0; frag < m_fragments.size(); frag++) {
+          unsigned tileXCoord = m_fragments[frag].uintPos(0) / tileW;
+          unsigned tileYCoord = m_fragments[frag].uintPos(1) / tileH;
+          unsigned bboxIndex = (tileYCoord - minY) * bboxW + (tileXCoord - minX);
+          assert(bboxIndex < bboxW*bboxH);
+          RasterTile*& rtile = fragmentTiles[bboxIndex];
+          tcBlockCull_t* block = blocks == NULL? NULL :
+             &blocks[(tileYCoord/tcBlockInTilesH - minBY)*bboxBW
+                + tileXCoord/tcBlockInTilesW - minBX];
+          if(rtile == NULL){
+             unsigned tileIndex = tileYCoord * wTiles + tileXCoord;
+             rtile = arena->create<RasterTile>(arena, this, primId, tileIndex,
+                   tileH, tileW, tileXCoord, tileYCoord);
+             if(block != NULL) block->tiles++;
+          }
+          rtile->addFragment(&m_fragments[frag]);
+          //make sure that we do not add more fragments in each tile than we should have
+          assert(rtile->size() <= (tileH * tileW));
+          if(block != NULL){
+             const uint64_t depth = m_fragments[frag].uintPos(2);
+             if(block->fragments++ == 0){
+                block->minDepth = block->maxDepth = depth;
+             } else {
+                block->minDepth = std::min(block->minDepth, depth);
+                block->maxDepth = std::max(block->maxDepth, depth);
+             }
+          }
+       }
+
+       if(blocks != NULL){
+          for(unsigned b=0; b < bboxBW*bboxBH; b++){
+             if(blocks[b].fragments == 0)
+                continue;
+             const unsigned bx = minBX + b%bboxBW;
+             const unsigned by = minBY + b/bboxBW;
+             blocks[b].culled = hiz->rejectRect(
+                   std::max(minX, bx*tcBlockInTilesW),
+                   std::max(minY, by*tcBlockInTilesH),
+                   std::min(maxX, (bx+1)*tcBlockInTilesW - 1),
+                   std::min(maxY, (by+1)*tcBlockInTilesH - 1),
+                   blocks[b].minDepth, blocks[b].maxDepth);
+             if(blocks[b].culled)
+                hiz->recordBlockCull(blocks[b].tiles, blocks[b].fragments);
           }
        }
+
+       //box is walked row by row, i.e., in increasing tile index order
+       unsigned fragCount = 0;
+       for(unsigned tile=0; tile < bboxW*bboxH; tile++){
+          RasterTile* rtile = fragmentTiles[tile];
+          if(rtile == NULL)
+             continue;
+          //we need to set active frags count tally
+          fragCount += rtile->resetActiveCount();
+          assert(rtile->getActiveCount() != 0);
+          unsigned tcBlockX = rtile->xCoord/tcBlockInTilesW;
+          unsigned tcBlockY = rtile->yCoord/tcBlockInTilesH;
+          if(blocks != NULL
+                and blocks[(tcBlockY - minBY)*bboxBW + tcBlockX - minBX].culled)
+             continue;
+          unsigned tcBlockId = (tcBlockY * xTCBlocks) + tcBlockX;
+          m_simtRasterTiles[tcBlockId%clusterCount].push_back(rtile);
+       }
+       assert(fragCount == m_fragments.size());
     }
 
     //add terminating tiles
     for(unsigned s=0; s<clusterCount; s++){
-       RasterTile* rtile = new RasterTile(NULL, -1, -1, -1, -1, -1, -1);
+       RasterTile* rtile = arena->create<RasterTile>(arena,
+             (primitiveFragmentsData_t*) NULL, -1, -1, -1, -1, -1, -1);
        m_simtRasterTiles[s].push_back(rtile);
        rtile->lastPrimTile=true;
     }
@@ -475,6 +511,12 @@ renderData_t::renderData_t():
     m_usedFragShaderRegs = -1;
     m_currentRenderBufferBytes = NULL;
     m_last_vert_core = 0;
+    m_shaderCachePid = -1;
+    m_recordTexelFetches = true;
+    m_fastForward = false;
+    m_resumed = false;
+    m_resumeFrame = 0;
+    m_cptPending = false;
 }
 
 renderData_t::~renderData_t() {
@@ -506,8 +548,23 @@ shaderAttrib_t renderData_t::getFragmentData(unsigned utid, unsigned tid, unsign
    shaderAttrib_t retVal;
    bool isRetVal = false;
    assert((utid%tcSize) < tcTilePtr->size());
-   fragmentData_t* frag = tcTilePtr->at(utid%tcSize) == NULL? 
-      NULL: tcTilePtr->at(utid%tcSize)->frag;
+   RasterTile::rasterFragment_t* rfrag = tcTilePtr->at(utid%tcSize);
+   fragmentData_t* frag = rfrag == NULL? NULL: rfrag->frag;
+
+   //inputs, liveness and quad index are read by every fragment thread
+   if(attribID == TGSI_FILE_INPUT){
+      retVal.f32 = m_fragAttribs.input(frag->attribIdx, fileIdx, attribIndex);
+      return retVal;
+   }
+   if(attribID == FRAG_ACTIVE){
+      retVal.u32 = (frag != NULL and frag->isLive)? 1 : 0;
+      return retVal;
+   }
+   if(attribID == QUAD_INDEX){
+      assert(frag->quadIdx < TGSI_QUAD_SIZE);
+      retVal.u32 = frag->quadIdx;
+      return retVal;
+   }
 
    switch(attribID){
       case QUAD_ACTIVE: {
@@ -524,27 +581,11 @@ shaderAttrib_t renderData_t::getFragmentData(unsigned utid, unsigned tid, unsign
          isRetVal = true;
          break;
       }
-      case FRAG_ACTIVE: {
-         if(frag == NULL){
-            retVal.u32 = 0;
-         } else {
-            //retVal.u32 =  frag->isLive? (frag->passedDepth? 1 : 0) : 0;
-            retVal.u32 =  frag->isLive? 1 : 0;
-         }
-         isRetVal = true;
-         break;
-      }
       case DEPTH_TEST_NOT_ACTIVE: {
         retVal.u32 = tcTilePtr->skipDepthTest? 1: 0;
         isRetVal = true;
         break;
       }
-      case QUAD_INDEX: {
-        assert(frag->quadIdx < TGSI_QUAD_SIZE);
-        retVal.u32 =  frag->quadIdx;
-        isRetVal = true;
-        break;
-                       }
       case FRAG_UINT_POS: {
            retVal.u32 =  frag->uintPos(attribIndex);
            isRetVal = true;
@@ -561,17 +602,10 @@ shaderAttrib_t renderData_t::getFragmentData(unsigned utid, unsigned tid, unsign
            isRetVal = true;
            break;
        }
-      case TGSI_FILE_INPUT: {
-             retVal.f32 = frag->inputs[fileIdx][attribIndex];
-             isRetVal = true;
-             break;
-          }
    }
 
-   if(isRetVal)
-      return retVal;
-
-   retVal.f32 = frag->attribs[attribID][attribIndex];
+   if(!isRetVal)
+      panic("Unexpected fragment attribute %d\n", attribID);
    return retVal;
 }
 
@@ -717,11 +751,14 @@ void renderData_t::endDrawCall() {
    putDataOnColorBuffer();
    if(isDepthTestEnabled())
        putDataOnDepthBuffer();
-    delete [] lastFatCubin->ident;
-    delete [] lastFatCubin->ptx[0].gpuProfileName;
-    delete [] lastFatCubin->ptx[0].ptx;
-    delete [] lastFatCubin->ptx;
-    delete lastFatCubin;
+    //no fat binary is built when a resident cached binary is reused
+    if(lastFatCubin != NULL){
+       delete [] lastFatCubin->ident;
+       delete [] lastFatCubin->ptx[0].gpuProfileName;
+       delete [] lastFatCubin->ptx[0].ptx;
+       delete [] lastFatCubin->ptx;
+       delete lastFatCubin;
+    }
     if(m_sShading_info.allocAddr) graphicsFree(m_sShading_info.allocAddr);
     if(m_sShading_info.deviceVertsInputAttribs) 
        graphicsFree(m_sShading_info.deviceVertsInputAttribs);
@@ -740,10 +777,8 @@ void renderData_t::endDrawCall() {
     lastFatCubin = NULL;
     RasterTiles * tiles = m_sShading_info.earlyZTiles;
     m_sShading_info.earlyZTiles = NULL;
+    //the tiles themselves are released with the raster arena
     if(tiles !=NULL){
-       for(int i=0; i < tiles->size(); i++){
-          delete (*tiles)[i];
-       }
        delete tiles;
     }
     graphicsStreamDestroy(m_sShading_info.cudaStreamVert);
@@ -753,6 +788,7 @@ void renderData_t::endDrawCall() {
        delete tr;
     textureRefs.clear();
     drawPrimitives.clear();
+    m_fragAttribs.clear();
     if(m_depthBuffer!=NULL) {
        delete [] m_depthBuffer;
        m_depthBuffer = NULL;
@@ -851,8 +887,11 @@ void renderData_t::checkExitCond(){
 }
 
 void renderData_t::incCurrentFrame(){
-   m_currentFrame++;
-   m_drawcall_num = 0;
+   {
+      std::lock_guard<std::mutex> lock(m_frameMutex);
+      m_currentFrame++;
+      m_drawcall_num = 0;
+   }
    checkpoint();
    checkExitCond();
 }
@@ -860,6 +899,7 @@ void renderData_t::incCurrentFrame(){
 bool renderData_t::GPGPUSimActiveFrame() {
    bool isFrame = ((m_currentFrame >= m_startFrame)
           and (m_currentFrame <= m_endFrame) 
+          and !(m_resumed and (m_currentFrame < m_resumeFrame))
           and !checkpointGraphics::SerializeObject.isUnserializingCp());
 
    return isFrame;
@@ -879,20 +919,70 @@ bool renderData_t::GPGPUSimSkipCpFrames(){
 }
 
 void renderData_t::checkpoint(){
-   std::string cptMsg = "graphics checkpoint";
+   //frames up to the one we resumed at are already in the checkpoint
+   if(m_resumed and (m_currentFrame <= m_resumeFrame))
+      return;
+
    if(m_cptStartFrame == m_currentFrame){
-      CheckPointRequest_t::Request.setCheckPoint(cptMsg);
+      requestCheckpoint();
       if(m_cptPeroid > 0){
          m_cptNextFrame = m_cptStartFrame + m_cptPeroid;
       }
    }
 
    if((m_cptNextFrame == m_currentFrame) and (m_currentFrame <= m_cptEndFrame)){
-      CheckPointRequest_t::Request.setCheckPoint(cptMsg);
+      requestCheckpoint();
       m_cptNextFrame+= m_cptPeroid;
    }
 }
 
+void renderData_t::requestCheckpoint(){
+   std::string cptMsg = "graphics checkpoint";
+   CheckPointRequest_t::Request.setCheckPoint(cptMsg);
+   if(!m_standaloneMode)
+      return;
+
+   //there is no guest to take the checkpoint in standalone mode, hold the 
+   //trace at this frame boundary until GraphicsStandalone takes it
+   std::unique_lock<std::mutex> lock(m_frameMutex);
+   m_cptPending = true;
+   m_frameCond.notify_all();
+   m_frameCond.wait(lock, [this]{ return !m_cptPending; });
+}
+
+void renderData_t::setResumeFrame(unsigned frame){
+   std::lock_guard<std::mutex> lock(m_frameMutex);
+   m_resumed = true;
+   m_resumeFrame = frame;
+}
+
+//called with m_frameMutex held
+bool renderData_t::isFastForwarding(){
+   if(!m_standaloneMode)
+      return false;
+   if(m_resumed and (m_currentFrame < m_resumeFrame))
+      return true;
+   return m_fastForward and (m_currentFrame < m_startFrame);
+}
+
+bool renderData_t::fastForwardingFrame(){
+   std::lock_guard<std::mutex> lock(m_frameMutex);
+   return isFastForwarding();
+}
+
+bool renderData_t::checkpointPending(){
+   std::lock_guard<std::mutex> lock(m_frameMutex);
+   return m_cptPending;
+}
+
+void renderData_t::releaseCheckpoint(){
+   {
+      std::lock_guard<std::mutex> lock(m_frameMutex);
+      m_cptPending = false;
+   }
+   m_frameCond.notify_all();
+}
+
 
 void renderData_t::endOfFrame(){
     printf("gpgpusim: end of frame %u\n", getCurrentFrame());
@@ -1035,9 +1125,8 @@ void renderData_t::addFragmentsQuad(std::vector<fragmentData_t>& quad) {
       addFragment(quad[i]);
 }
 
-void* renderData_t::getShaderFatBin(std::string vertexShaderFile,
-                                    std::string fragmentShaderFile){
-    const unsigned charArraySize = 200;
+std::string renderData_t::getShaderPtx(std::string vertexShaderFile,
+                                       std::string fragmentShaderFile){
     modifyCodeForVertexFetch(vertexShaderFile);
     modifyCodeForVertexWrite(vertexShaderFile);
     modifyCodeForDepth(fragmentShaderFile);
@@ -1045,7 +1134,25 @@ void* renderData_t::getShaderFatBin(std::string vertexShaderFile,
     std::string vcode = Utils::getFile(vertexShaderFile);
     std::string fcode = Utils::getFile(fragmentShaderFile);
 
-    std::string vfCode = vcode + "\n\n" + fcode;
+    return vcode + "\n\n" + fcode;
+}
+
+//state that changes how the modifyCodeFor* functions rewrite the shaders
+//or the ptxinfo we generate for them
+std::string renderData_t::getShaderVariant(){
+    std::stringstream variant;
+    variant << m_sShading_info.currPrimType << ","
+       << m_sShading_info.vertOutputAttribs << ","
+       << isDepthTestEnabled() << ","
+       << isBlendingEnabled() << ","
+       << m_fbPixelSizeSim << ","
+       << m_usedVertShaderRegs << ","
+       << m_usedFragShaderRegs;
+    return variant.str();
+}
+
+void* renderData_t::getShaderFatBin(const std::string& vfCode){
+    const unsigned charArraySize = 200;
     
     __cudaFatCudaBinary* fatBin = new __cudaFatCudaBinary();
     
@@ -1066,6 +1173,17 @@ void* renderData_t::getShaderFatBin(std::string vertexShaderFile,
     return fatBin;
 }
 
+void renderData_t::initShaderCache(bool enabled, const char* cacheDir){
+    //"none" keeps the cache in memory only
+    if(cacheDir == NULL or strcmp(cacheDir, "none") == 0)
+       cacheDir = "";
+    m_shaderCache.init(enabled, cacheDir);
+}
+
+void renderData_t::initFrameDumps(const char* format, unsigned queueDepth){
+    m_imageWriter.init(format, queueDepth);
+}
+
 std::string renderData_t::getShaderPTXInfo(int usedRegs, std::string functionName) {
     assert(usedRegs >= 0);
     std::stringstream ptxInfo;
@@ -1075,28 +1193,24 @@ std::string renderData_t::getShaderPTXInfo(int usedRegs, std::string functionNam
 }
 
 void renderData_t::writeTexture(byte* data, unsigned size, unsigned texNum, unsigned h, unsigned w, std::string typeEx) {
-    //image file for the result buffer, used for testing
-    std::ofstream bufferImage;
+    if(!m_imageWriter.enabled()) return;
+    //image file for the texture, used for testing
     std::stringstream ss;
     ss << getFbFolder() << "/frame" << getCurrentFrame() <<
             "_drawcall" << getDrawcallNum() << "_texture"<<texNum<<"_"<<w<<"x"<<h<<
             "_" << m_tcPid << "." << m_tcTid << "." << typeEx;
-    bufferImage.open(ss.str(), std::ios::binary | std::ios::out);
-    for (int i = 0; i < size; i++) {
-        bufferImage << data[i];
-    }
-    bufferImage.close();
-    std::string convertCommand = "convert -depth 8 -size " + std::to_string(w) + "x" + std::to_string(h) 
-                                 + " " + ss.str() + " " + ss.str() + ".jpg";
-    system(convertCommand.c_str());
-    system(std::string("rm " + ss.str()).c_str());
+    ImageWriter::Layout layout;
+    layout.width = w;
+    layout.height = h;
+    layout.channels = typeEx;
+    layout.bitDepth = 8;
+    m_imageWriter.write(ss.str(), "texture" + std::to_string(texNum), data, size, layout);
 }
 
 void renderData_t::writeDrawBuffer(std::string time, byte * buffer, int bufferSize, unsigned w, unsigned h, std::string extOrder, int depth) {
-    //copying the result render buffer to mesa
+    if(!m_imageWriter.enabled()) return;
     bool diffFileNames = true;
     //image file for the result buffer, used for testing
-    std::ofstream bufferImage;
     std::stringstream ss;
 
     if (diffFileNames) ss << getFbFolder()
@@ -1104,22 +1218,14 @@ void renderData_t::writeDrawBuffer(std::string time, byte * buffer, int bufferSi
             << "_" << w << "x" << h << "_" << m_tcPid << "." << m_tcTid << "." << extOrder;
     else ss << getFbFolder() << "gpgpusimBuffer." << extOrder;
 
-    bufferImage.open(ss.str(), std::ios::binary | std::ios::out);
-
-    if(!bufferImage.is_open()){
-      printf("Error opening file: %s\n", ss.str().c_str());
-      abort();
-    }
-
-    for (int i = 0; i < bufferSize; i++) {
-        bufferImage << buffer[i];
-    }
-
-    bufferImage.close();
-    std::string convertCommand = "convert -flip -depth " + std::to_string(depth) + " -size " + std::to_string(w) + "x" + std::to_string(h) 
-                                 + " " + ss.str() + " " + ss.str() + ".jpg";
-    system(convertCommand.c_str());
-    system(std::string("rm " + ss.str()).c_str());
+    //the writer thread flips and swizzles a copy, buffer can be released on return
+    ImageWriter::Layout layout;
+    layout.width = w;
+    layout.height = h;
+    layout.channels = extOrder;
+    layout.bitDepth = depth;
+    layout.flip = true;
+    m_imageWriter.write(ss.str(), time, buffer, bufferSize, layout);
 }
 
 unsigned renderData_t::getFramebufferFormat(){
@@ -1306,35 +1412,87 @@ void renderData_t::registerPtxCode(){
     std::string frame_drawcall = std::to_string(m_currentFrame) + "_" + std::to_string(m_drawcall_num);
     std::string vertexPTXFile = m_vPTXPrfx +frame_drawcall+".ptx";
     std::string fragmentPTXFile = m_fPTXPrfx +frame_drawcall+".ptx"; 
-    void* cudaFatBin = getShaderFatBin(vertexPTXFile, fragmentPTXFile);
-
-    std::string vertexPtxInfo = getShaderPTXInfo(m_usedVertShaderRegs, getCurrentShaderName(VERTEX_PROGRAM));
-    std::string fragmentPtxInfo = getShaderPTXInfo(m_usedFragShaderRegs, getCurrentShaderName(FRAGMENT_PROGRAM));
-
-    std::string ptxInfoFileName = m_fPtxInfoPrfx +
-        std::to_string(m_currentFrame) + "_" + std::to_string(getDrawcallNum());
-    std::ofstream ptxInfoFile(ptxInfoFileName.c_str());
-    assert(ptxInfoFile.is_open());
-    ptxInfoFile<< vertexPtxInfo + fragmentPtxInfo; 
-    ptxInfoFile.close();
-
-    void ** fatCubinHandle = graphicsRegisterFatBinary(cudaFatBin, ptxInfoFileName.c_str(), &m_sShading_info.allocAddr);
+    std::string vertexName = getCurrentShaderName(VERTEX_PROGRAM);
+    std::string fragmentName = getCurrentShaderName(FRAGMENT_PROGRAM);
+    auto startTime = std::chrono::steady_clock::now();
+
+    ShaderCache::Entry* cached = NULL;
+    uint64_t cacheKey = 0;
+    if(m_shaderCache.enabled()){
+       //parsed symbol tables are dropped when the graphics process changes
+       int pid = CudaGPU::getCudaGPU(g_active_device)->getCurrGraphicsPid();
+       if(pid != m_shaderCachePid){
+          m_shaderCache.dropResidentBinaries();
+          m_shaderCachePid = pid;
+       }
+       cacheKey = m_shaderCache.computeKey(
+             Utils::getFile(vertexPTXFile), Utils::getFile(fragmentPTXFile),
+             vertexName, fragmentName, getShaderVariant());
+       cached = m_shaderCache.lookup(cacheKey);
+    }
+    const bool cacheHit = (cached != NULL);
+
+    void ** fatCubinHandle = NULL;
+    //device names the functions were parsed with, differ from this draw
+    //call's names when a resident binary is reused
+    std::string vertexDeviceName = vertexName;
+    std::string fragmentDeviceName = fragmentName;
+    bool resident = (cached != NULL) and (cached->fatCubinHandle != 0);
+    if(resident){
+        fatCubinHandle = graphicsReloadFatBinary(cached->fatCubinHandle, &m_sShading_info.allocAddr);
+        vertexDeviceName = cached->vertexName;
+        fragmentDeviceName = cached->fragmentName;
+        lastFatCubin = NULL;
+    } else {
+        std::string ptxCode = (cached != NULL)?
+           m_shaderCache.expand(cached, vertexName, fragmentName) :
+           getShaderPtx(vertexPTXFile, fragmentPTXFile);
+        void* cudaFatBin = getShaderFatBin(ptxCode);
+
+        std::string vertexPtxInfo = getShaderPTXInfo(m_usedVertShaderRegs, vertexName);
+        std::string fragmentPtxInfo = getShaderPTXInfo(m_usedFragShaderRegs, fragmentName);
+
+        std::string ptxInfoFileName = m_fPtxInfoPrfx +
+            std::to_string(m_currentFrame) + "_" + std::to_string(getDrawcallNum());
+        std::ofstream ptxInfoFile(ptxInfoFileName.c_str());
+        assert(ptxInfoFile.is_open());
+        ptxInfoFile<< vertexPtxInfo + fragmentPtxInfo; 
+        ptxInfoFile.close();
+
+        fatCubinHandle = graphicsRegisterFatBinary(cudaFatBin, ptxInfoFileName.c_str(), &m_sShading_info.allocAddr);
+        lastFatCubin = (__cudaFatCudaBinary*)cudaFatBin;
+
+        if(m_shaderCache.enabled()){
+           if(cached == NULL)
+              cached = m_shaderCache.insert(cacheKey, ptxCode, vertexName, fragmentName);
+           cached->fatCubinHandle = (unsigned)(unsigned long long)fatCubinHandle;
+           cached->vertexName = vertexName;
+           cached->fragmentName = fragmentName;
+        }
+    }
 
     //assert(m_sShading_info.allocAddr != NULL); //we always have some constants in the shaders
-    lastFatCubin = (__cudaFatCudaBinary*)cudaFatBin;
     lastFatCubinHandle = fatCubinHandle;
 
     graphicsRegisterFunction(fatCubinHandle,
             getCurrentShaderId(VERTEX_PROGRAM),
-            (char*)getCurrentShaderName(VERTEX_PROGRAM).c_str(),
-            getCurrentShaderName(VERTEX_PROGRAM).c_str(),
+            (char*)vertexDeviceName.c_str(),
+            vertexDeviceName.c_str(),
             -1, (uint3*)0, (uint3*)0, (dim3*)0, (dim3*)0, (int*)0);
 
     graphicsRegisterFunction(fatCubinHandle,
             getCurrentShaderId(FRAGMENT_PROGRAM),
-            (char*)getCurrentShaderName(FRAGMENT_PROGRAM).c_str(),
-            getCurrentShaderName(FRAGMENT_PROGRAM).c_str(),
+            (char*)fragmentDeviceName.c_str(),
+            fragmentDeviceName.c_str(),
             -1, (uint3*)0, (uint3*)0, (dim3*)0, (dim3*)0, (int*)0);
+
+    if(m_shaderCache.enabled()){
+       std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+       if(cacheHit)
+          m_shaderCache.recordHit(elapsed.count(), resident);
+       else
+          m_shaderCache.recordMiss(elapsed.count());
+    }
 }
 
 void renderData_t::initializeCurrentDraw(struct tgsi_exec_machine* tmachine, void* sp, void* mapped_indices) {
@@ -1391,6 +1549,8 @@ void renderData_t::initializeCurrentDraw(struct tgsi_exec_machine* tmachine, voi
     m_tilesCount = m_wTiles * m_hTiles;
 
     m_depthBuffer = NULL;
+    //resolve the depth comparison once for the whole draw call
+    m_depthTester.setFunc(ctx->Depth.Func);
     if(isDepthTestEnabled()){
         m_depthBuffer = setDepthBuffer();
         graphicsMalloc((void**) &m_deviceData, m_colorBufferByteSize + m_depthBufferSize); 
@@ -1422,6 +1582,7 @@ void renderData_t::initializeCurrentDraw(struct tgsi_exec_machine* tmachine, voi
 }
 
 void renderData_t::addTexelFetch(int x, int y, int level){
+   if(!m_recordTexelFetches) return;
    texelInfo_t* ti = &m_textureInfo[m_currSamplingUnit];
    uint64_t texelAddr = ti->getTexelAddr(x, y, level);
    m_texelFetches.push_back(texelAddr);
@@ -1434,7 +1595,18 @@ std::vector<uint64_t> renderData_t::fetchTexels(
       unsigned utid, void* stream,
       texModifier tmodifier){
   m_currSamplingUnit = unit;
-  texelInfo_t* ti = &m_textureInfo[m_currSamplingUnit];
+
+  unsigned tcSize = 0;
+  tileStream_t* tst = m_sShading_info.getTCTile(utid, &tcSize);
+  unsigned qid = (utid%tcSize)/TGSI_QUAD_SIZE;
+  std::unordered_map<unsigned, quadTexCoords_t>::iterator quadIt =
+     tst->quadCoords.find(qid);
+  assert(quadIt != tst->quadCoords.end());
+  quadTexCoords_t& quad = quadIt->second;
+
+  //the sampler reports the texels of the whole quad, only the first
+  //fragment of the quad records them
+  m_recordTexelFetches = !quad.footprintValid;
 
   unsigned  quadIdx = getShaderData(utid, utid, QUAD_INDEX, -1, -1, -1, stream).u32;
   if(tmodifier==texModifier::NONE) {
@@ -1452,26 +1624,36 @@ std::vector<uint64_t> renderData_t::fetchTexels(
     modifier = 0; //TEX_MODIFIER_NONE
     mesaFetchTexture(m_tmachine, modifier, unit, 1/*sampler*/, dim, coords, num_coords , dst, num_dst, quadIdx);
   }
+  m_recordTexelFetches = true;
+
+  if(!quad.footprintValid){
+    setQuadFootprint(quad);
+  }
+  assert(m_texelFetches.size() == 0);
   std::vector<uint64_t> texelFetches;
-  //fetches for all quad fragments are included, filter out relevant ones based
-  //on the quadIdx
+  texelFetches.swap(quad.texels[quadIdx]);
+
+  assert(quad.remainingAccesses > 0);
+  quad.remainingAccesses--;
+  if(quad.remainingAccesses == 0)
+     tst->quadCoords.erase(quadIt);
+  return texelFetches;
+}
+
+//split the texels the sampler fetched for a quad between its fragments
+void renderData_t::setQuadFootprint(quadTexCoords_t& quad){
   assert(m_texelFetches.size() >= TGSI_QUAD_SIZE); //at least 1 texel per fragment
-  int texelsPerFragment = (m_texelFetches.size()+TGSI_QUAD_SIZE-1)/TGSI_QUAD_SIZE;
-  int startTexel = texelsPerFragment*quadIdx;
-  int endTexel = (texelsPerFragment*(quadIdx +1)) - 1;
-  int curTexel = 0;
-  std::unordered_set<uint64_t> checker;
-  for(auto it= m_texelFetches.begin(); it != m_texelFetches.end(); it++){
-    if(curTexel >= startTexel and curTexel <= endTexel){
-      if(checker.find(*it) == checker.end()){
-        texelFetches.push_back(*it);
-        checker.insert(*it);
-      }
+  unsigned texelsPerFragment = (m_texelFetches.size()+TGSI_QUAD_SIZE-1)/TGSI_QUAD_SIZE;
+  for(unsigned t=0; t < m_texelFetches.size(); t++){
+    std::vector<uint64_t>& fragTexels = quad.texels[t/texelsPerFragment];
+    //footprints are a handful of texels, a linear search is enough
+    if(std::find(fragTexels.begin(), fragTexels.end(), m_texelFetches[t])
+          == fragTexels.end()){
+      fragTexels.push_back(m_texelFetches[t]);
     }
-    curTexel++;
   }
   m_texelFetches.clear();
-  return texelFetches;
+  quad.footprintValid = true;
 }
 
 
@@ -1690,36 +1872,54 @@ GLboolean renderData_t::doVertexShading(GLvector4f ** inputParams, vp_stage_data
 */
 
 void renderData_t::setHizTiles(RasterDirection rasterDir) {
-   const unsigned frameDim = m_bufferHeight * m_bufferWidth;
-   std::vector<uint64_t> depthValues(frameDim);
-
+   assert(rasterDir == RasterDirection::HorizontalRaster);
+   m_hizBuff.setSize(m_tilesCount);
+   if(m_hizPyramid.enabled()){
+      m_hizPyramid.reset(m_wTiles, m_hTiles, m_depthTester.func());
+   }
+   //assert((m_bufferWidth%m_tile_W) == 0);
+   //assert((m_bufferHeight%m_tile_H) == 0);
    if(m_depthSize == DepthSize::Z16) {
-      uint16_t* p = (uint16_t*) m_depthBuffer;
-      for(unsigned i =0; i< frameDim; i++)
-         depthValues[i] = p[i];
+      setHizTilesFrom((const uint16_t*) m_depthBuffer);
    } else if(m_depthSize == DepthSize::Z32){
-      uint32_t* p = (uint32_t*) m_depthBuffer;
-      for(unsigned i =0; i< frameDim; i++)
-         depthValues[i] = p[i];
+      setHizTilesFrom((const uint32_t*) m_depthBuffer);
    } else assert(0);
+   if(m_hizPyramid.enabled()){
+      m_hizPyramid.build();
+   }
+}
 
-   std::vector<bool> touchedTiles(m_tilesCount, false);
-   m_hizBuff.setSize(m_tilesCount);
-   //assert((m_bufferWidth%m_tile_W) == 0);
-   //assert((m_bufferHeight%m_tile_H) == 0);
+HizPyramid* renderData_t::getHizPyramid(){
+   if(m_hizPyramid.enabled() and isDepthTestEnabled())
+      return &m_hizPyramid;
+   return NULL;
+}
+
+//reduces each row span of a tile at once rather than one depth at a time
+template <typename T>
+void renderData_t::setHizTilesFrom(const T* depthValues) {
    const unsigned tileRow = (m_bufferWidth+m_tile_W-1) / m_tile_W;
-   for(unsigned i=0; i < depthValues.size(); i++){
-      unsigned tileIdx = -1;
-      unsigned xPos = i%m_bufferWidth;
-      unsigned yPos = i/m_bufferWidth;
-      unsigned tileXCoord = xPos/m_tile_W;
+   for(unsigned yPos=0; yPos < m_bufferHeight; yPos++){
+      const T* row = depthValues + yPos*m_bufferWidth;
       unsigned tileYCoord = yPos/m_tile_H;
-      if(rasterDir == RasterDirection::HorizontalRaster){
-         tileIdx = tileYCoord*tileRow + tileXCoord;
-      } else {
-         assert(0);
-      } 
-      m_hizBuff.setDepth(tileIdx, tileXCoord, tileYCoord, depthValues[i]);
+      for(unsigned xPos=0; xPos < m_bufferWidth; xPos+= m_tile_W){
+         unsigned tileXCoord = xPos/m_tile_W;
+         unsigned tileIdx = tileYCoord*tileRow + tileXCoord;
+         unsigned spanW = std::min(m_tile_W, m_bufferWidth - xPos);
+         if(m_hizPyramid.enabled()){
+            uint64_t minDepth, maxDepth;
+            DepthTester::minMax(row + xPos, spanW, minDepth, maxDepth);
+            m_hizPyramid.addTileRange(tileXCoord, tileYCoord, minDepth, maxDepth);
+         }
+         if(m_depthTester.ordered()){
+            uint64_t front, back;
+            m_depthTester.range(row + xPos, spanW, front, back);
+            m_hizBuff.setDepthRange(tileIdx, tileXCoord, tileYCoord, front, back);
+         } else {
+            for(unsigned i=0; i < spanW; i++)
+               m_hizBuff.setDepth(tileIdx, tileXCoord, tileYCoord, row[xPos + i]);
+         }
+      }
    }
 }
 
@@ -1732,15 +1932,20 @@ bool renderData_t::testHiz(RasterTile* tile){
    assert(tile->xCoord == m_hizBuff.m_hizEntries[tileId].xCoord);
    assert(tile->yCoord == m_hizBuff.m_hizEntries[tileId].yCoord);
 
-   if(m_mesaCtx->Depth.Func==GL_NOTEQUAL 
-         or m_mesaCtx->Depth.Func==GL_EQUAL){ 
-      warn_once("Unsupported depth test (GL_NOTEQUAL or GL_EQUAL), skipping HiZ\n");
+   if(not m_depthTester.ordered()){
+      warn_once("Unsupported depth test (GL_NOTEQUAL, GL_EQUAL or GL_ALWAYS), skipping HiZ\n");
       return true;
    } else if(depthTest(m_hizBuff.m_hizEntries[tileId].frontDepth,
             tile->backDepth())){
       m_hizBuff.m_hizEntries[tileId].frontDepth = tile->frontDepth();
       if(tile->fullyCovered()){
          m_hizBuff.m_hizEntries[tileId].backDepth = tile->backDepth();
+         //the tile overwrites every depth value it covers
+         if(m_hizPyramid.enabled()){
+            m_hizPyramid.updateTile(tile->xCoord, tile->yCoord,
+                  std::min(tile->frontDepth(), tile->backDepth()),
+                  std::max(tile->frontDepth(), tile->backDepth()));
+         }
       }
       tile->setSkipFineDepth();
       return true;
@@ -1751,44 +1956,6 @@ bool renderData_t::testHiz(RasterTile* tile){
    return false;
 }
 
-bool renderData_t::depthTest(uint64_t oldDepthVal, uint64_t newDepthVal){
-   bool returnVal = false;
-   switch(m_mesaCtx->Depth.Func){
-      case GL_LESS: 
-         if(newDepthVal < oldDepthVal)
-            returnVal = true;
-         break;
-      case GL_LEQUAL:
-         if(newDepthVal <= oldDepthVal)
-            returnVal = true;
-         break;
-      case GL_GEQUAL: 
-         if(newDepthVal >= oldDepthVal)
-            returnVal = true;
-         break;
-      case GL_GREATER: 
-         if(newDepthVal > oldDepthVal)
-            returnVal = true;
-         break;
-      case GL_NOTEQUAL:
-         if(newDepthVal != oldDepthVal)
-            returnVal = true;
-         break;
-      case GL_EQUAL:
-         if(newDepthVal == oldDepthVal)
-            returnVal = true;
-         break;
-      case GL_NEVER:
-         returnVal = false;
-         break;
-      case GL_ALWAYS:
-         returnVal = true;
-      default: 
-         panic("Unsupported depth function %x\n", m_mesaCtx->Depth.Func);
-   }
-   return returnVal;
-}
-
 /*pvbFetch_t renderData_t::checkVerts(unsigned newVerts, unsigned oldVerts){
    bool primReady = false;
    unsigned fetch;
@@ -2015,7 +2182,7 @@ void renderData_t::gpgpusim_cycle(){
    }*/
 }
 
-std::set<unsigned> renderData_t::getClustersCoveredByPrim(unsigned primId){
+void renderData_t::sortPrimTiles(unsigned primId, drawCallArena_t* arena, HizPyramid* hiz){
    drawPrimitives[primId].sortFragmentsInTiles(
          m_bufferHeight, m_bufferWidth, 
          m_tile_H, m_tile_W, 
@@ -2025,7 +2192,38 @@ std::set<unsigned> renderData_t::getClustersCoveredByPrim(unsigned primId){
          RasterDirection::HorizontalRaster, 
          m_tc_h, m_tc_w,
          m_tc_block_dim,
-         m_numClusters);
+         m_numClusters,
+         arena, hiz);
+}
+
+//primitives of a batch are binned independently on the raster workers, 
+//each one into the arena of the worker that takes it
+void renderData_t::sortPrimBatch(const std::vector<unsigned>& primIds){
+   std::vector<unsigned> pending;
+   for(unsigned primId: primIds){
+      assert(primId < drawPrimitives.size());
+      if(drawPrimitives[primId].hasTiles())
+         continue;
+      DPRINTF(MesaGpgpusim, "Sorting %d fragments of prim %d in %d tiles\n",
+            drawPrimitives[primId].size(), primId, m_tilesCount);
+      pending.push_back(primId);
+   }
+   //arenas are only added here, never while the workers are running
+   while(m_sShading_info.workerArenas.size() + 1 < m_rasterWorkers.threads())
+      m_sShading_info.workerArenas.emplace_back();
+   //depth state is read by this thread only
+   HizPyramid* hiz = getHizPyramid();
+   m_rasterWorkers.run(pending.size(), [&](unsigned job, unsigned worker){
+         sortPrimTiles(pending[job], m_sShading_info.getArena(worker), hiz);
+   });
+}
+
+std::set<unsigned> renderData_t::getClustersCoveredByPrim(unsigned primId){
+   if(!drawPrimitives[primId].hasTiles()){
+      DPRINTF(MesaGpgpusim, "Sorting %d fragments of prim %d in %d tiles\n",
+            drawPrimitives[primId].size(), primId, m_tilesCount);
+      sortPrimTiles(primId, &m_sShading_info.rasterArena, getHizPyramid());
+   }
 
    std::set<unsigned> coveredClusters;
    for(unsigned clusterId=0; clusterId < m_numClusters; clusterId++){
@@ -2063,7 +2261,9 @@ primitiveFragmentsData_t* renderData_t::getPrimData(unsigned primId){
          RasterDirection::HorizontalRaster, 
          m_tc_h, m_tc_w,
          m_tc_block_dim,
-         m_numClusters);
+         m_numClusters,
+         &m_sShading_info.rasterArena,
+         getHizPyramid());
    for(unsigned clusterId=0; clusterId < m_numClusters; clusterId++){
       bool res = simt_clusters[clusterId]->getGraphicsPipeline()->add_primitive(&drawPrimitives[prim]);
       assert(res);
@@ -2799,11 +2999,12 @@ void RasterTile::addFragment(fragmentData_t* frag){
    unsigned quadIdx = fragY%qd == 0? 
       (fragX%qd == 0? 0 : 1): 
       (fragX%qd == 0? 2 : 3);
-   assert(tidx < tileH*tileW/QUAD_SIZE);
-   assert(not m_fragmentsQuads[tidx][quadIdx].alive);
-   m_fragmentsQuads[tidx][quadIdx].frag = frag;
-   m_fragmentsQuads[tidx][quadIdx].alive = true;
-   m_fragmentsQuads[tidx][quadIdx].tile = this;
+   assert(tidx < m_quadsCount);
+   rasterFragment_t& rfrag = m_fragments[tidx*QUAD_SIZE + quadIdx];
+   assert(not rfrag.alive);
+   rfrag.frag = frag;
+   rfrag.alive = true;
+   rfrag.tile = this;
    if(m_addedFragsCount==0){
       //first frag, set front and back depths
       m_frontDepth = frag->uintPos(2);
@@ -2821,16 +3022,30 @@ void RasterTile::addFragment(fragmentData_t* frag){
 
 void RasterTile::testHizThresh(){
    assert(m_hizThreshSet);
-   for(unsigned quadId=0; quadId < m_fragmentsQuads.size(); quadId++)
-      for(unsigned fragId=0; fragId < m_fragmentsQuads[quadId].size(); fragId++){
-         rasterFragment_t* frag = &m_fragmentsQuads[quadId][fragId];
-         if(frag->alive){
-            if(g_renderData.depthTest(frag->frag->uintPos(2), m_hizThresh)){
-               frag->alive = false;
-               m_activeCount--;
-            }
-         } 
+   //test the tile in chunks against the threshold
+   const unsigned chunkSize = 64;
+   uint64_t depths[chunkSize];
+   uint8_t culled[chunkSize];
+   unsigned idx[chunkSize];
+   const DepthTester& tester = g_renderData.getDepthTester();
+   for(unsigned base=0; base < size(); base+= chunkSize){
+      unsigned count = 0;
+      const unsigned end = std::min(size(), base + chunkSize);
+      for(unsigned i=base; i < end; i++){
+         if(m_fragments[i].alive){
+            idx[count] = i;
+            depths[count++] = m_fragments[i].frag->uintPos(2);
+         }
+      }
+      if(count == 0 or tester.testOld(depths, m_hizThresh, count, culled) == 0)
+         continue;
+      for(unsigned c=0; c < count; c++){
+         if(culled[c]){
+            m_fragments[idx[c]].alive = false;
+            m_activeCount--;
+         }
       }
+   }
 }
 
 void renderData_t::modifyCodeForVertexFetch(std::string file){
@@ -2926,15 +3141,14 @@ float* renderData_t::getTexCoords(unsigned utid, void* stream){
    unsigned tcSize = 0;
    tileStream_t* tst =  m_sShading_info.getTCTile(utid, &tcSize);
    unsigned qid = (utid%tcSize)/TGSI_QUAD_SIZE;
-   if(tst->quadCoords.find(qid) == tst->quadCoords.end()){
+   std::unordered_map<unsigned, quadTexCoords_t>::iterator it =
+      tst->quadCoords.find(qid);
+   if(it == tst->quadCoords.end()){
       return NULL;
    } else {
-      float* fcoords = tst->quadCoords[qid].getCoords();
-      assert(tst->quadCoords[qid].remainingAccesses > 0);
-      tst->quadCoords[qid].remainingAccesses--;
-      if(tst->quadCoords[qid].remainingAccesses == 0)
-         tst->quadCoords.erase(qid);
-      return fcoords;
+      //released by fetchTexels once all the quad fragments sampled
+      assert(it->second.remainingAccesses > 0);
+      return it->second.getCoords();
    }
 }
 
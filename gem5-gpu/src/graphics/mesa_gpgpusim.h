@@ -38,9 +38,13 @@
 #include <iostream>
 #include <vector>
 #include <mutex>
+#include <condition_variable>
 #include <map>
+#include <new>
 #include <queue>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <GL/gl.h>
 #include <unordered_map>
 #include <unordered_set>
@@ -58,7 +62,13 @@ extern "C" {
 
 #define SKIP_API_GEM5
 #include "api/cuda_syscalls.hh"
+#include "graphics/depth_test.hh"
+#include "graphics/draw_call_arena.hh"
 #include "graphics/gpgpusim_to_graphics_calls.h"
+#include "graphics/hiz_pyramid.hh"
+#include "graphics/image_writer.hh"
+#include "graphics/raster_workers.hh"
+#include "graphics/shader_cache.hh"
 #include "abstract_hardware_model.h"
 
 
@@ -118,28 +128,64 @@ struct vertexData_t {
    std::vector<ch4_t> outputs;
 };
 
+//shader inputs are kept in the draw call fragmentAttribStore_t
 struct fragmentData_t {
-   fragmentData_t(): passedDepth(false) {}
-   GLfloat attribs[PIPE_MAX_SHADER_INPUTS][4];
-   std::vector<ch4_t> inputs;
+   fragmentData_t(): attribIdx(-1), passedDepth(false) {}
+   unsigned attribIdx;
    unsigned quadIdx;
    bool passedDepth;
    bool isLive;
    uint64_t _uintPos[3];
-   fragmentData_t* mesaQuadFrags[TGSI_QUAD_SIZE];
 
    uint64_t& uintPos (const int pos)
    {
       assert(pos < 3);
       return _uintPos[pos];
    }
+};
 
-   bool hasLiveQuad(){
-      for(unsigned q=0; q<TGSI_QUAD_SIZE; q++)
-         if(mesaQuadFrags[q]->isLive)
-            return true;
-      return false;
-   }
+//fragment shader inputs of a draw call, one array per input channel sized
+//to the inputs the shader reads, fragments are addressed by the index 
+//returned by addFragment
+class fragmentAttribStore_t {
+   public:
+      fragmentAttribStore_t(): m_inputsCount(0), m_size(0) {}
+
+      //all fragments of a draw call come from the same shader
+      void setInputsCount(unsigned count){
+         if(m_size == 0 and count != m_inputsCount){
+            m_inputsCount = count;
+            m_channels.resize(count*TGSI_NUM_CHANNELS);
+         }
+         assert(count == m_inputsCount);
+      }
+
+      unsigned addFragment(){
+         for(unsigned c=0; c<m_channels.size(); c++)
+            m_channels[c].push_back(0.0);
+         return m_size++;
+      }
+
+      GLfloat& input(unsigned fragIdx, unsigned inputIdx, unsigned channel){
+         assert(fragIdx < m_size);
+         assert(inputIdx < m_inputsCount and channel < TGSI_NUM_CHANNELS);
+         return m_channels[inputIdx*TGSI_NUM_CHANNELS + channel][fragIdx];
+      }
+
+      //keeps the channel arrays for the next draw call
+      void clear(){
+         for(unsigned c=0; c<m_channels.size(); c++)
+            m_channels[c].clear();
+         m_size = 0;
+      }
+
+      unsigned size() const { return m_size; }
+      unsigned inputsCount() const { return m_inputsCount; }
+
+   private:
+      unsigned m_inputsCount;
+      unsigned m_size;
+      std::vector<std::vector<GLfloat> > m_channels;
 };
 
 class primitiveFragmentsData_t;
@@ -154,7 +200,9 @@ class RasterTile {
       RasterTile* tile;
    };
    public:
-      RasterTile(primitiveFragmentsData_t* const _prim,
+      //fragment quads are carved out of the draw call arena
+      RasterTile(drawCallArena_t* arena,
+            primitiveFragmentsData_t* const _prim,
             int _primId, int _tilePos, 
             unsigned _tileH, unsigned _tileW,
             unsigned _xCoord, unsigned _yCoord):
@@ -163,15 +211,16 @@ class RasterTile {
          xCoord(_xCoord), yCoord(_yCoord),
          m_tilePos(_tilePos), 
          lastPrimTile(false),
-         m_fragmentsQuads(_tileH*_tileW/QUAD_SIZE, 
-         std::vector<rasterFragment_t>(QUAD_SIZE)),
+         m_quadsCount(_tileH*_tileW/QUAD_SIZE),
+         m_fragments(arena->createArray<rasterFragment_t>(
+                  m_quadsCount*QUAD_SIZE)),
          m_prim(_prim), m_addedFragsCount(0),
          m_skipFineDepth(false), m_hizThreshSet(false)
       {}
 
       void addFragment(fragmentData_t* frag);
 
-      unsigned size() const { return m_fragmentsQuads.size()*QUAD_SIZE;} 
+      unsigned size() const { return m_quadsCount*QUAD_SIZE;} 
 
       void setSkipFineDepth(){
          m_skipFineDepth = true;
@@ -183,23 +232,21 @@ class RasterTile {
 
       fragmentData_t& getFragment (const int index)
       {
-         return *(m_fragmentsQuads[index/QUAD_SIZE][index%QUAD_SIZE].frag);
+         return *(m_fragments[index].frag);
       }
 
       rasterFragment_t& getRasterFragment (const int quadId, unsigned fragId){
-         return m_fragmentsQuads[quadId][fragId];
+         return m_fragments[quadId*QUAD_SIZE + fragId];
       }
 
       unsigned setActiveFragmentsIndices() {
          m_fragmentIndices.clear();
          unsigned activeCount = 0;
-         for(unsigned i=0; i<m_fragmentsQuads.size(); i++){
-            for(unsigned f=0; f<QUAD_SIZE; f++){
-               if(m_fragmentsQuads[i][f].frag->isLive 
-                     and m_fragmentsQuads[i][f].frag->passedDepth){
-                  m_fragmentIndices.push_back(i*QUAD_SIZE+f);
-                  activeCount++;
-               }
+         for(unsigned i=0; i<size(); i++){
+            if(m_fragments[i].frag->isLive 
+                  and m_fragments[i].frag->passedDepth){
+               m_fragmentIndices.push_back(i);
+               activeCount++;
             }
          }
          assert(m_fragmentIndices.size() == activeCount);
@@ -216,11 +263,10 @@ class RasterTile {
 
       unsigned resetActiveCount(){
          m_activeCount = 0;
-         for(unsigned quadId=0; quadId < m_fragmentsQuads.size(); quadId++)
-            for(unsigned fragId=0; fragId < m_fragmentsQuads[quadId].size(); fragId++){
-               if(m_fragmentsQuads[quadId][fragId].alive)
-                  m_activeCount++;
-            }
+         for(unsigned i=0; i < size(); i++){
+            if(m_fragments[i].alive)
+               m_activeCount++;
+         }
          return m_activeCount;
       }
 
@@ -254,7 +300,9 @@ class RasterTile {
       const unsigned m_tilePos;
       bool lastPrimTile;
    private:
-      std::vector <std::vector <rasterFragment_t> > m_fragmentsQuads;
+      const unsigned m_quadsCount;
+      //quad-major, QUAD_SIZE fragments per quad
+      rasterFragment_t* const m_fragments;
       std::vector<unsigned> m_fragmentIndices;
       std::vector<bool> m_validFragments;
       primitiveFragmentsData_t* const m_prim;
@@ -287,12 +335,23 @@ class tcTile_t {
          done=false;
          skipDepthTest=false;
       }
+   //tiles are pooled by the tc engines, reset keeps the fragment storage
+   void reset(unsigned _x, unsigned _y){
+      x = _x;
+      y = _y;
+      done=false;
+      skipDepthTest=false;
+      m_frags.clear();
+   }
    unsigned size(){
       return m_frags.size();
    }
    void push_back(RasterTile::rasterFragment_t* frag){
       m_frags.push_back(frag);
    }
+   void assign(RasterTile::rasterFragment_t* const* frags, unsigned count){
+      m_frags.assign(frags, frags + count);
+   }
    RasterTile::rasterFragment_t*& at(unsigned idx){
       assert(idx < m_frags.size());
       return m_frags.at(idx);
@@ -309,27 +368,32 @@ class tcTile_t {
       return res;
    }
 
-   const unsigned x;
-   const unsigned y;
+   unsigned x;
+   unsigned y;
    bool done;
    bool skipDepthTest;
    private:
       std::vector<RasterTile::rasterFragment_t*> m_frags;
 };
 
+//texture request of a quad, shared by the quad fragments until all of
+//them sampled the texture
 struct quadTexCoords_t {
    quadTexCoords_t():
-      remainingAccesses(TGSI_QUAD_SIZE){}
+      remainingAccesses(TGSI_QUAD_SIZE), footprintValid(false){}
    void setCoords(float* _fcoords){
       std::memcpy((void*) fcoords, (void*) _fcoords, 
             sizeof(float)*TGSI_QUAD_SIZE*4);
-      remainingAccesses--;
    }
    float* getCoords(){
       return fcoords;
    }
    unsigned remainingAccesses;
    float fcoords[TGSI_QUAD_SIZE*4];
+   //texel addresses of each quad fragment, generated once by the first
+   //fragment of the quad that samples the texture
+   bool footprintValid;
+   std::vector<uint64_t> texels[TGSI_QUAD_SIZE];
 };
 
 typedef tcTile_t* tcTilePtr_t;
@@ -401,8 +465,20 @@ struct stage_shading_info_t {
     kernel_info_t* vertKernel;
     kernel_info_t* fragKernel;
     std::unordered_map<unsigned, tileStream_t*> threadTileMap;
+    tileStream_t* lastTile;
     std::vector< std::vector<ch4_t> > vertConsts;
     std::vector< std::vector<ch4_t> > fragConsts;
+    //raster tiles and their fragment quads for the current draw call
+    drawCallArena_t rasterArena;
+    //tiles sorted by raster worker w>0 come from workerArenas[w-1]
+    std::deque<drawCallArena_t> workerArenas;
+
+    drawCallArena_t* getArena(unsigned worker){
+       if(worker == 0)
+          return &rasterArena;
+       assert(worker <= workerArenas.size());
+       return &workerArenas[worker-1];
+    }
     
     inline tileStream_t* getTCTile(unsigned tid, unsigned* size){
        tileStream_t* tile = getTCTile(tid);
@@ -411,8 +487,15 @@ struct stage_shading_info_t {
     }
 
     inline tileStream_t* getTCTile(unsigned tid){
-       assert(threadTileMap.find(tid)!=threadTileMap.end());
-       return threadTileMap[tid];
+       //consecutive queries mostly come from threads of the same tile
+       if(lastTile != NULL 
+             and tid >= lastTile->t_start and tid <= lastTile->t_end)
+          return lastTile;
+       std::unordered_map<unsigned, tileStream_t*>::iterator it =
+          threadTileMap.find(tid);
+       assert(it!=threadTileMap.end());
+       lastTile = it->second;
+       return lastTile;
        /*for(auto& tile: cudaStreamTiles){
           if(tid>=tile->t_start and tid<=tile->t_end){
              return tile;
@@ -468,23 +551,35 @@ struct stage_shading_info_t {
            delete t;
         cudaStreamTiles.clear();
         threadTileMap.clear();
+        lastTile = NULL;
         vertConsts.clear();
         fragConsts.clear();
+        rasterArena.reset();
+        for(auto& arena: workerArenas)
+           arena.reset();
     }
 };
 
+//depth range of a primitive inside one TC block, used for coarse HiZ culling
+struct tcBlockCull_t {
+    uint64_t minDepth;
+    uint64_t maxDepth;
+    unsigned tiles;
+    unsigned fragments;
+    bool culled;
+};
+
 class primitiveFragmentsData_t {
 public:
     primitiveFragmentsData_t(int _primId): primId(_primId){
-       maxDepth = (uint64_t) -1;
-       minDepth = 0;
+       maxDepth = 0;
+       minDepth = (uint64_t) -1;
        m_validTiles = false;
+       m_minXPos = m_minYPos = (unsigned) -1;
+       m_maxXPos = m_maxYPos = 0;
     }
-    ~primitiveFragmentsData_t(){
-       for(unsigned t=0; t<m_rasterTiles.size(); t++){
-          delete m_rasterTiles[t];
-       }
-    }
+    //raster tiles are owned by the draw call arena in stage_shading_info_t
+    ~primitiveFragmentsData_t(){}
 
     shaderAttrib_t getFragmentData(unsigned utid, unsigned tid, unsigned attribID, unsigned attribIndex, 
           unsigned fileIdx, unsigned idx2D, void * stream, stage_shading_info_t* shadingData, bool z_unit_disabled);
@@ -504,7 +599,9 @@ public:
         const RasterDirection rasterDir,
         unsigned tcH, unsigned tcW,
         unsigned tcBlockDim,
-        unsigned clusterCount);
+        unsigned clusterCount,
+        drawCallArena_t* arena,
+        HizPyramid* hiz);
 
     //primitive max and min depth values, used for z-culling
     const int primId; //unique prim id for draw call
@@ -515,6 +612,9 @@ public:
     {
        return m_fragments[index];
     }
+    bool hasTiles() const {
+       return m_validTiles;
+    }
     RasterTiles& getRasterTiles(){
        assert(m_validTiles);
        return m_rasterTiles;
@@ -531,6 +631,11 @@ private:
     RasterTiles m_rasterTiles;
     std::vector<RasterTiles> m_simtRasterTiles;
     bool m_validTiles;
+    //screen space bounding box of the fragments in pixels
+    unsigned m_minXPos;
+    unsigned m_maxXPos;
+    unsigned m_minYPos;
+    unsigned m_maxYPos;
 };
 
 enum class texModifier {
@@ -566,6 +671,7 @@ public:
     //bool runNextPrim();
     primitiveFragmentsData_t* getPrimData(unsigned primId);
     std::set<unsigned> getClustersCoveredByPrim(unsigned primId);
+    void sortPrimBatch(const std::vector<unsigned>& primIds);
     
     bool isVertWarpDone(unsigned warpId, unsigned vertCount);
     void allocateVertBuffers();
@@ -575,6 +681,9 @@ public:
     void setVertexAttribsCount(struct tgsi_exec_machine *mach, int inputAttribsCount, int outputAttribsCount);
     void addVertex(struct tgsi_exec_machine* mach, int pos);
     void addFragmentsQuad(std::vector<fragmentData_t>& quad);
+    fragmentAttribStore_t& getFragmentAttribs(){
+       return m_fragAttribs;
+    }
 
     //gpgpusim calls
     bool isDepthTestEnabled();
@@ -625,6 +734,7 @@ public:
                                       texModifier tmodifier);
     unsigned  getTexelSize(int samplingUnit);
     void addTexelFetch(int x, int y, int level);
+    void setQuadFootprint(quadTexCoords_t& quad);
 
     unsigned getFramebufferFormat();
     void setPixelSize();
@@ -642,7 +752,10 @@ public:
     const char* getShaderOutputDir(){
       return m_intFolder.c_str();
     }
-    bool depthTest(uint64_t oldDepth, uint64_t newDepth);
+    bool depthTest(uint64_t oldDepth, uint64_t newDepth){
+       return m_depthTester.test(oldDepth, newDepth);
+    }
+    const DepthTester& getDepthTester() const { return m_depthTester; }
     bool testHiz(RasterTile* tile);
     struct gl_context * getMesaCtx(){return m_mesaCtx;}
     void modifyCodeForVertexFetch(std::string file);
@@ -650,11 +763,44 @@ public:
     void modifyCodeForDepth(std::string file);
     void modifyCodeForBlend(std::string file);
     unsigned getDepthSize(){ return (unsigned)m_depthSize;}
+    void initShaderCache(bool enabled, const char* cacheDir);
+    void printShaderCacheStats(std::ostream& out){
+       m_shaderCache.printStats(out);
+    }
+    void initFrameDumps(const char* format, unsigned queueDepth);
+    void initHizPyramid(unsigned levels){
+       m_hizPyramid.configure(levels);
+    }
+    void printHizStats(std::ostream& out){
+       m_hizPyramid.printStats(out);
+    }
+    void initRasterWorkers(unsigned threads){
+       m_rasterWorkers.init(threads);
+    }
+    void printRasterStats(std::ostream& out){
+       m_rasterWorkers.printStats(out);
+    }
+    void flushFrameDumps(){
+       m_imageWriter.flush();
+    }
+    void initFastForward(bool enabled){
+       m_fastForward = enabled;
+    }
+    void setResumeFrame(unsigned frame);
+    unsigned getResumeFrame(){ return m_resumeFrame; }
+    bool isFastForwarding();
+    bool fastForwardingFrame();
+    bool checkpointPending();
+    void releaseCheckpoint();
+    void printFrameDumpStats(std::ostream& out){
+       m_imageWriter.printStats(out);
+    }
     void modeMemcpy(byte* dst, byte *src, 
       unsigned count, enum cudaMemcpyKind kind);
     float* getTexCoords(unsigned utid, void* stream);
     void setTexCoords(unsigned utid, void* stream, float* coords);
     void setFragLiveStatus(unsigned utid, void* stream, bool status);
+    unsigned int getCurrentFrame() const {return m_currentFrame;}
 
 private:
     bool useInShaderBlending() const;
@@ -682,7 +828,7 @@ private:
 
     void checkExitCond();
     void checkpoint();
-    unsigned int getCurrentFrame(){return m_currentFrame;}
+    void requestCheckpoint();
     long long unsigned getDrawcallNum(){return m_drawcall_num;}
     const char* getCurrentShaderId(int shaderType);
     std::string getCurrentShaderName(int shaderType){
@@ -710,7 +856,9 @@ private:
     byte** getpDeviceData(){return &m_deviceData;}
     //std::string getShaderPTXInfo(std::string arbFileName, std::string functionName);
     std::string getShaderPTXInfo(int usedRegs, std::string functionName);
-    void* getShaderFatBin(std::string vertexShader, std::string fragmentShader);
+    std::string getShaderPtx(std::string vertexShader, std::string fragmentShader);
+    void* getShaderFatBin(const std::string& ptxCode);
+    std::string getShaderVariant();
     gl_state_index getParamStateIndexes(gl_state_index index);
     void setHizTiles(RasterDirection rasterDir);
 
@@ -730,6 +878,15 @@ private:
     bool m_skipCpFrames;
     unsigned int m_cptNextFrame;
     unsigned int m_currentFrame;
+    //standalone traces: frames before the simulated region (or before the
+    //frame a checkpoint was taken at) are replayed by Mesa only
+    bool m_fastForward;
+    bool m_resumed;
+    unsigned int m_resumeFrame;
+    //the trace thread waits at a frame boundary until the checkpoint is taken
+    bool m_cptPending;
+    std::mutex m_frameMutex;
+    std::condition_variable m_frameCond;
     int m_startDrawcall;
     unsigned int m_endDrawcall;
     uint64_t m_colorBufferByteSize;
@@ -761,6 +918,7 @@ private:
     bool m_inShaderBlending; //1 in shader, 0 in z-unit
     bool m_inShaderDepth; //1 in shader, 0 in z-unit
     std::vector<primitiveFragmentsData_t> drawPrimitives;
+    fragmentAttribStore_t m_fragAttribs;
     stage_shading_info_t m_sShading_info;
     std::vector<textureReference*> textureRefs;
     void** lastFatCubinHandle;
@@ -769,6 +927,9 @@ private:
     int m_tcTid;
     std::string m_outdir;
     std::mutex vertexFragmentLock;
+    ShaderCache m_shaderCache;
+    ImageWriter m_imageWriter;
+    int m_shaderCachePid;
     int m_usedVertShaderRegs;
     int m_usedFragShaderRegs;
     struct tgsi_exec_machine* m_tmachine;
@@ -819,6 +980,7 @@ private:
     std::vector<texelInfo_t> m_textureInfo;
     int m_currSamplingUnit;
     std::vector<uint64_t> m_texelFetches;
+    bool m_recordTexelFetches;
     unsigned m_fbPixelSizeSim;
     byte* m_currentRenderBufferBytes;
 
@@ -832,6 +994,30 @@ private:
           m_hizEntries.resize(psize);
        }
 
+       //merges the range of a span of depths, depth function must be ordered
+       void setDepthRange(unsigned tileIdx,
+             unsigned xCoord, unsigned yCoord,
+             uint64_t front, uint64_t back){
+          assert(tileIdx < m_hizEntries.size());
+          hiz_entry_t& entry = m_hizEntries[tileIdx];
+          if(!entry.depthValid){
+             entry.depthValid = true;
+             entry.frontDepth = front;
+             entry.backDepth  = back;
+             entry.xCoord = xCoord;
+             entry.yCoord = yCoord;
+          } else {
+             assert(entry.xCoord == xCoord);
+             assert(entry.yCoord == yCoord);
+             if(m_renderData->depthTest(entry.frontDepth, front)){
+                entry.frontDepth = front;
+             }
+             if(m_renderData->depthTest(back, entry.backDepth)){
+                entry.backDepth = back;
+             }
+          }
+       }
+
        void setDepth(unsigned tileIdx,
              unsigned xCoord, unsigned yCoord,
              uint64_t depth){
@@ -870,6 +1056,15 @@ private:
     };
 
     hizBuffer_t m_hizBuff;
+    template <typename T>
+    void setHizTilesFrom(const T* depthValues);
+    DepthTester m_depthTester;
+    //coarse culling before raster tiles are created
+    HizPyramid m_hizPyramid;
+    HizPyramid* getHizPyramid();
+    //bins the fragments of primitive batches into raster tiles
+    RasterWorkers m_rasterWorkers;
+    void sortPrimTiles(unsigned primId, drawCallArena_t* arena, HizPyramid* hiz);
     unsigned m_numClusters;
     unsigned m_coresPerCluster;
 
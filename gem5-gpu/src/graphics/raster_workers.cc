@@ -0,0 +1,130 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cassert>
+
+#include "base/misc.hh"
+#include "graphics/raster_workers.hh"
+
+RasterWorkers::RasterWorkers():
+    m_threads(1), m_generation(0), m_stop(false), m_busy(0), m_task(NULL),
+    m_jobs(0), m_nextJob(0), m_batches(0), m_parallelBatches(0), m_jobsRun(0)
+{}
+
+RasterWorkers::~RasterWorkers()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_start.notify_all();
+    for (auto& t: m_workers)
+        t.join();
+}
+
+void
+RasterWorkers::init(unsigned threads)
+{
+    if (!m_workers.empty())
+        fatal("Raster worker threads are already running\n");
+    m_threads = threads > 0? threads : 1;
+}
+
+void
+RasterWorkers::run(unsigned jobs, const Task& task)
+{
+    m_batches++;
+    m_jobsRun += jobs;
+    if (m_threads == 1 or jobs < 2) {
+        for (unsigned j = 0; j < jobs; j++)
+            task(j, 0);
+        return;
+    }
+
+    m_parallelBatches++;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    //workers are started with the first batch worth splitting
+    while (m_workers.size() + 1 < m_threads)
+        m_workers.push_back(
+              std::thread(&RasterWorkers::work, this, m_workers.size() + 1));
+    m_task = &task;
+    m_jobs = jobs;
+    m_nextJob = 0;
+    m_busy = m_workers.size();
+    m_generation++;
+    lock.unlock();
+    m_start.notify_all();
+
+    drain(0);
+
+    lock.lock();
+    m_done.wait(lock, [this] { return m_busy == 0; });
+    m_task = NULL;
+}
+
+void
+RasterWorkers::work(unsigned worker)
+{
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start.wait(lock, [this, seen] {
+                return m_stop or m_generation != seen;
+            });
+            if (m_stop)
+                return;
+            seen = m_generation;
+        }
+        drain(worker);
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            assert(m_busy > 0);
+            if (--m_busy == 0)
+                m_done.notify_one();
+        }
+    }
+}
+
+void
+RasterWorkers::drain(unsigned worker)
+{
+    unsigned job;
+    while ((job = m_nextJob++) < m_jobs)
+        (*m_task)(job, worker);
+}
+
+void
+RasterWorkers::printStats(std::ostream& out) const
+{
+    if (m_batches == 0)
+        return;
+    out << "raster worker threads: " << m_threads << "\n";
+    out << "raster batches: " << m_batches << "\n";
+    out << "raster parallel batches: " << m_parallelBatches << "\n";
+    out << "raster primitives sorted: " << m_jobsRun << "\n";
+}
@@ -0,0 +1,90 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef __RASTER_WORKERS_HH__
+#define __RASTER_WORKERS_HH__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+/*
+ * A small pool of host threads that bins the fragments of a primitive batch
+ * into raster tiles. Every job is a single primitive and only touches that
+ * primitive and the arena of the worker running it, so the tiles produced
+ * are the same as with the serial loop no matter which thread runs a job or
+ * in which order the jobs finish.
+ *
+ * The calling thread is worker 0 and takes jobs as well, run() returns once
+ * every job of the batch is done. With one thread, or a single job, run()
+ * is a plain loop and no thread is started.
+ */
+class RasterWorkers {
+  public:
+    typedef std::function<void(unsigned job, unsigned worker)> Task;
+
+    RasterWorkers();
+    ~RasterWorkers();
+
+    //total number of threads, including the calling one
+    void init(unsigned threads);
+    unsigned threads() const { return m_threads; }
+
+    void run(unsigned jobs, const Task& task);
+    void printStats(std::ostream& out) const;
+
+  private:
+    void work(unsigned worker);
+    void drain(unsigned worker);
+
+    unsigned m_threads;
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+    uint64_t m_generation;
+    bool m_stop;
+    unsigned m_busy;
+
+    //the batch being run, set under m_mutex before m_generation is bumped
+    const Task* m_task;
+    unsigned m_jobs;
+    std::atomic<unsigned> m_nextJob;
+
+    //statistics, only touched by the calling thread
+    uint64_t m_batches;
+    uint64_t m_parallelBatches;
+    uint64_t m_jobsRun;
+};
+
+#endif // __RASTER_WORKERS_HH__
@@ -0,0 +1,238 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "base/misc.hh"
+#include "base/trace.hh"
+#include "debug/MesaGpgpusim.hh"
+#include "graphics/shader_cache.hh"
+
+const std::string ShaderCache::vertexNameTag = "__gpgpusim_vertex_shader__";
+const std::string ShaderCache::fragmentNameTag = "__gpgpusim_fragment_shader__";
+
+static std::string replaceAll(std::string str, const std::string& from,
+      const std::string& to)
+{
+    if (from.empty())
+        return str;
+    size_t pos = 0;
+    while ((pos = str.find(from, pos)) != std::string::npos) {
+        str.replace(pos, from.size(), to);
+        pos += to.size();
+    }
+    return str;
+}
+
+//64-bit FNV-1a
+static uint64_t hashBytes(uint64_t hash, const std::string& str)
+{
+    const uint64_t prime = 0x100000001b3ULL;
+    for (size_t i = 0; i < str.size(); i++) {
+        hash ^= (unsigned char) str[i];
+        hash *= prime;
+    }
+    //separator so that ("ab", "c") and ("a", "bc") differ
+    hash ^= 0xff;
+    hash *= prime;
+    return hash;
+}
+
+ShaderCache::ShaderCache():
+    m_enabled(false), m_lookups(0), m_hits(0), m_residentHits(0),
+    m_diskHits(0), m_misses(0), m_missSeconds(0), m_hitSeconds(0)
+{}
+
+void
+ShaderCache::init(bool enabled, const std::string& cacheDir)
+{
+    m_enabled = enabled;
+    m_cacheDir = cacheDir;
+    if (!m_enabled or m_cacheDir.empty())
+        return;
+    if (mkdir(m_cacheDir.c_str(), 0755) != 0 and errno != EEXIST) {
+        warn("Unable to create shader cache directory %s, "
+              "the shader cache will not persist\n", m_cacheDir.c_str());
+        m_cacheDir.clear();
+    }
+}
+
+std::string
+ShaderCache::normalize(const std::string& code,
+      const std::string& vertexName, const std::string& fragmentName) const
+{
+    std::string res = replaceAll(code, vertexName, vertexNameTag);
+    return replaceAll(res, fragmentName, fragmentNameTag);
+}
+
+std::string
+ShaderCache::expand(const Entry* entry, const std::string& vertexName,
+      const std::string& fragmentName) const
+{
+    std::string res = replaceAll(entry->ptx, vertexNameTag, vertexName);
+    return replaceAll(res, fragmentNameTag, fragmentName);
+}
+
+uint64_t
+ShaderCache::computeKey(const std::string& vertexCode,
+      const std::string& fragmentCode,
+      const std::string& vertexName,
+      const std::string& fragmentName,
+      const std::string& variant) const
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    hash = hashBytes(hash, normalize(vertexCode, vertexName, fragmentName));
+    hash = hashBytes(hash, normalize(fragmentCode, vertexName, fragmentName));
+    hash = hashBytes(hash, variant);
+    return hash;
+}
+
+std::string
+ShaderCache::diskPath(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.ptx", (unsigned long long) key);
+    return m_cacheDir + "/" + name;
+}
+
+bool
+ShaderCache::readFromDisk(uint64_t key, std::string& ptx) const
+{
+    if (m_cacheDir.empty())
+        return false;
+    std::ifstream in(diskPath(key), std::ios::in | std::ios::binary);
+    if (!in)
+        return false;
+    std::stringstream contents;
+    contents << in.rdbuf();
+    ptx = contents.str();
+    return !ptx.empty();
+}
+
+void
+ShaderCache::writeToDisk(uint64_t key, const std::string& ptx) const
+{
+    if (m_cacheDir.empty())
+        return;
+    //write then rename so concurrent runs never see a partial entry
+    std::string path = diskPath(key);
+    std::string tmpPath = path + ".tmp." + std::to_string(getpid());
+    std::ofstream out(tmpPath, std::ios::out | std::ios::binary);
+    if (!out) {
+        warn("Unable to write shader cache entry %s\n", tmpPath.c_str());
+        return;
+    }
+    out << ptx;
+    out.close();
+    if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+        warn("Unable to write shader cache entry %s\n", path.c_str());
+        unlink(tmpPath.c_str());
+    }
+}
+
+ShaderCache::Entry*
+ShaderCache::lookup(uint64_t key)
+{
+    assert(m_enabled);
+    m_lookups++;
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        DPRINTF(MesaGpgpusim, "shader cache hit, key=%016llx, resident=%d\n",
+                key, it->second.fatCubinHandle != 0);
+        return &it->second;
+    }
+    std::string ptx;
+    if (readFromDisk(key, ptx)) {
+        DPRINTF(MesaGpgpusim, "shader cache disk hit, key=%016llx\n", key);
+        m_diskHits++;
+        Entry& entry = m_entries[key];
+        entry.ptx = ptx;
+        return &entry;
+    }
+    DPRINTF(MesaGpgpusim, "shader cache miss, key=%016llx\n", key);
+    return NULL;
+}
+
+ShaderCache::Entry*
+ShaderCache::insert(uint64_t key, const std::string& ptx,
+      const std::string& vertexName, const std::string& fragmentName)
+{
+    assert(m_enabled);
+    Entry& entry = m_entries[key];
+    entry.ptx = normalize(ptx, vertexName, fragmentName);
+    writeToDisk(key, entry.ptx);
+    return &entry;
+}
+
+void
+ShaderCache::dropResidentBinaries()
+{
+    for (auto& it: m_entries)
+        it.second.fatCubinHandle = 0;
+}
+
+void
+ShaderCache::recordMiss(double seconds)
+{
+    m_misses++;
+    m_missSeconds += seconds;
+}
+
+void
+ShaderCache::recordHit(double seconds, bool resident)
+{
+    m_hits++;
+    if (resident)
+        m_residentHits++;
+    m_hitSeconds += seconds;
+}
+
+void
+ShaderCache::printStats(std::ostream& out) const
+{
+    if (!m_enabled)
+        return;
+    uint64_t hits = m_hits;
+    double hitRate = m_lookups > 0 ? (double) hits / m_lookups : 0;
+    double avgMiss = m_misses > 0 ? m_missSeconds / m_misses : 0;
+    double saved = hits * avgMiss - m_hitSeconds;
+    out << "\nshader cache lookups = " << m_lookups << "\n";
+    out << "shader cache hits = " << hits
+        << " (resident binaries = " << m_residentHits
+        << ", from disk = " << m_diskHits << ")\n";
+    out << "shader cache misses = " << m_misses << "\n";
+    out << "shader cache hit rate = " << hitRate << "\n";
+    out << "shader cache miss time (s) = " << m_missSeconds << "\n";
+    out << "shader cache hit time (s) = " << m_hitSeconds << "\n";
+    out << "shader cache estimated time saved (s) = "
+        << (saved > 0 ? saved : 0) << "\n";
+}
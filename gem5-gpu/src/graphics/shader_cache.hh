@@ -0,0 +1,109 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef __SHADER_CACHE_HH__
+#define __SHADER_CACHE_HH__
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+/*
+ * Content-addressed cache of the PTX generated for each draw call's shader
+ * pair. Entries are keyed by a hash of the unmodified vertex and fragment
+ * shader code plus the pipeline state that changes how the code is rewritten
+ * (vertex write, depth and blend variants). The rewritten PTX is stored with
+ * the per-draw shader names replaced by tags so it can be reused by any draw
+ * call. While the symbol table parsed for an entry is still resident the
+ * fat binary handle is kept as well, so later draws skip the PTX front end.
+ */
+class ShaderCache {
+  public:
+    struct Entry {
+        Entry(): fatCubinHandle(0) {}
+        //rewritten PTX, shader names replaced by the name tags
+        std::string ptx;
+        //handle of the resident parsed binary, 0 when not resident
+        unsigned fatCubinHandle;
+        //device function names the resident binary was parsed with
+        std::string vertexName;
+        std::string fragmentName;
+    };
+
+    ShaderCache();
+
+    void init(bool enabled, const std::string& cacheDir);
+    bool enabled() const { return m_enabled; }
+
+    uint64_t computeKey(const std::string& vertexCode,
+          const std::string& fragmentCode,
+          const std::string& vertexName,
+          const std::string& fragmentName,
+          const std::string& variant) const;
+
+    //looks up memory first then the on-disk cache, NULL on a miss
+    Entry* lookup(uint64_t key);
+    Entry* insert(uint64_t key, const std::string& ptx,
+          const std::string& vertexName, const std::string& fragmentName);
+
+    //parsed symbol tables were discarded, e.g., on a graphics process change
+    void dropResidentBinaries();
+
+    std::string expand(const Entry* entry, const std::string& vertexName,
+          const std::string& fragmentName) const;
+
+    void recordMiss(double seconds);
+    void recordHit(double seconds, bool resident);
+    void printStats(std::ostream& out) const;
+
+  private:
+    std::string normalize(const std::string& code,
+          const std::string& vertexName,
+          const std::string& fragmentName) const;
+    std::string diskPath(uint64_t key) const;
+    bool readFromDisk(uint64_t key, std::string& ptx) const;
+    void writeToDisk(uint64_t key, const std::string& ptx) const;
+
+    static const std::string vertexNameTag;
+    static const std::string fragmentNameTag;
+
+    bool m_enabled;
+    std::string m_cacheDir;
+    std::unordered_map<uint64_t, Entry> m_entries;
+
+    //statistics
+    uint64_t m_lookups;
+    uint64_t m_hits;
+    uint64_t m_residentHits;
+    uint64_t m_diskHits;
+    uint64_t m_misses;
+    double m_missSeconds;
+    double m_hitSeconds;
+};
+
+#endif // __SHADER_CACHE_HH__
@@ -0,0 +1,129 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Checks ShaderCache keys, name tagging and on-disk persistence, and times the
+// work a hit does in place of regenerating the PTX: key, lookup and expand.
+// Usage: shader_cache_test [hits to time]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+#include <string>
+
+#include "graphics/shader_cache.hh"
+
+static int errors_found = 0;
+
+static void check(bool cond, const char* what)
+{
+    if (!cond) {
+        printf("ERROR ** %s\n", what);
+        errors_found = 1;
+    }
+}
+
+//a shader of about the size the PTX generator emits for a draw call
+static std::string makeShader(const std::string& name, unsigned lines)
+{
+    std::string code = ".entry " + name + "(\n.param .u64 " + name + "_p)\n{\n";
+    for (unsigned i = 0; i < lines; i++)
+        code += "   mad.f32 %f" + std::to_string(i % 32) + ", %f1, %f2, %f3;\n";
+    return code + "   ret;\n}\n";
+}
+
+int main(int argc, char *argv[])
+{
+    char dirTemplate[] = "/tmp/shader_cache_testXXXXXX";
+    const char* dir = mkdtemp(dirTemplate);
+    check(dir != NULL, "unable to create a cache directory");
+    if (dir == NULL)
+        return 1;
+
+    const std::string vs = makeShader("vp_1", 400);
+    const std::string fs = makeShader("fp_2", 800);
+    const std::string ptx = vs + fs;
+
+    ShaderCache cache;
+    cache.init(true, dir);
+    //the same shaders under other per-draw names share a key, a variant does not
+    uint64_t key = cache.computeKey(vs, fs, "vp_1", "fp_2", "depth");
+    check(key == cache.computeKey(makeShader("vp_7", 400),
+                makeShader("fp_9", 800), "vp_7", "fp_9", "depth"),
+          "key depends on the shader names");
+    check(key != cache.computeKey(vs, fs, "vp_1", "fp_2", "blend"),
+          "key ignores the variant");
+    check(key != cache.computeKey(fs, vs, "vp_1", "fp_2", "depth"),
+          "key ignores which code is the vertex shader");
+
+    check(cache.lookup(key) == NULL, "hit on an empty cache");
+    ShaderCache::Entry* entry = cache.insert(key, ptx, "vp_1", "fp_2");
+    entry->fatCubinHandle = 3;
+    check(cache.lookup(key) == entry, "miss after insert");
+    check(cache.expand(entry, "vp_7", "fp_9") ==
+          makeShader("vp_7", 400) + makeShader("fp_9", 800),
+          "expanded PTX does not carry the new shader names");
+    cache.dropResidentBinaries();
+    check(entry->fatCubinHandle == 0, "resident binary kept after drop");
+
+    //a later run finds the entry on disk
+    ShaderCache later;
+    later.init(true, dir);
+    ShaderCache::Entry* diskEntry = later.lookup(key);
+    check(diskEntry != NULL and diskEntry->fatCubinHandle == 0,
+          "entry did not persist on disk");
+    if (diskEntry != NULL)
+        check(later.expand(diskEntry, "vp_1", "fp_2") == ptx,
+              "entry read from disk differs");
+
+    typedef std::chrono::steady_clock bench_clock;
+    unsigned hits = (argc > 1) ? atoi(argv[1]) : 20000;
+    size_t sum = 0;
+    bench_clock::time_point t0 = bench_clock::now();
+    for (unsigned i = 0; i < hits; i++) {
+        std::string vName = "vp_" + std::to_string(i);
+        std::string fName = "fp_" + std::to_string(i);
+        uint64_t k = cache.computeKey(vs, fs, "vp_1", "fp_2", "depth");
+        sum += cache.expand(cache.lookup(k), vName, fName).size();
+    }
+    bench_clock::time_point t1 = bench_clock::now();
+    printf("%zu byte shader pair: %.1f us per hit (key, lookup, expand), "
+           "checksum %zu\n", ptx.size(),
+           std::chrono::duration<double, std::micro>(t1 - t0).count() / hits,
+           sum);
+
+    std::string cmd = std::string("rm -rf ") + dir;
+    if (system(cmd.c_str()) != 0)
+        printf("unable to remove %s\n", dir);
+
+    if (errors_found) {
+        printf("SUMMARY:  ERRORS FOUND\n");
+    } else {
+        printf("SUMMARY: UNIT TEST PASSED\n");
+    }
+    return errors_found;
+}
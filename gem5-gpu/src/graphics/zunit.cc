@@ -111,41 +111,6 @@ ZUnit::recvDepthResponse(PacketPtr pkt){
    return true; 
 }
 
-bool
-ZUnit::depthTest(uint64_t oldDepthVal, uint64_t newDepthVal){
-   bool returnVal = false;
-   switch(depthFunc){
-      case GL_LESS: 
-         if(newDepthVal < oldDepthVal)
-            returnVal = true;
-         break;
-      case GL_LEQUAL:
-         if(newDepthVal <= oldDepthVal)
-            returnVal = true;
-         break;
-      case GL_GEQUAL: 
-         if(newDepthVal >= oldDepthVal)
-            returnVal = true;
-         break;
-      case GL_GREATER: 
-         if(newDepthVal > oldDepthVal)
-            returnVal = true;
-         break;
-      case GL_NOTEQUAL:
-         if(newDepthVal != oldDepthVal)
-            returnVal = true;
-         break;
-      case GL_EQUAL:
-         if(newDepthVal == oldDepthVal)
-            returnVal = true;
-         break;
-      default: 
-         panic("Unsupported depth function %x\n", depthFunc);
-   }
-
-   return returnVal;
-}
-
 void
 ZUnit::processDepthResponse(){
    assert(depthResponseQ.size() > 0);
@@ -367,7 +332,7 @@ void ZUnit::regStats(){
 
 void
 ZUnit::setDepthFunc(GLenum _depthFunc){
-   depthFunc = _depthFunc;
+   depthTester.setFunc(_depthFunc);
 }
 
 void ZUnit::startEarlyZ(uint64_t depthBuffStart, uint64_t depthBuffEnd, uint32_t bufWidth, RasterTiles& tiles, DepthSize dSize, GLenum _depthFunc,
@@ -375,18 +340,16 @@ void ZUnit::startEarlyZ(uint64_t depthBuffStart, uint64_t depthBuffEnd, uint32_t
    depthSize = dSize;
    depthAddrStart = depthBuffStart;
    depthAddrEnd = depthBuffEnd;
-   depthFunc = _depthFunc;
+   depthTester.setFunc(_depthFunc);
    tileWidth = tileW;
    tileHeight = tileH;
 
    //if this case we kill all the fragments; TODO: check that the shader doesn't modify the depth
-   if(depthFunc == GL_NEVER){
+   if(depthTester.func() == GL_NEVER){
       return;
    }
 
-   // this case needs a special handling
-   assert(depthFunc != GL_ALWAYS);
-   
+
    initHizBuffer(depthBuffer, frameWidth, frameHeight, dSize, tileW, tileH, blockH, blockW, rasterDir);
 
    depthTiles.resize(tiles.size(), NULL);
@@ -402,8 +365,7 @@ void ZUnit::startEarlyZ(uint64_t depthBuffStart, uint64_t depthBuffEnd, uint32_t
       if(tiles[i]->size() == 0)
          continue;
 
-      depthTiles[i]->hizDepthFront = (*(tiles[i])).getFragment(0).uintPos(2);
-      depthTiles[i]->hizDepthBack = (*(tiles[i])).getFragment(0).uintPos(2);
+      depthScratch.resize(tiles[i]->size());
       for(int j=0; j< tiles[i]->size();  j++){
          unsigned xPos = (*(tiles[i])).getFragment(j).uintPos(0);
          unsigned yPos = (*(tiles[i])).getFragment(j).uintPos(1);
@@ -414,14 +376,25 @@ void ZUnit::startEarlyZ(uint64_t depthBuffStart, uint64_t depthBuffEnd, uint32_t
          DepthFragmentTile::DepthFragment df(j, addr, zPos, depthTiles[i], &rasterFrag);
          df.unsetPassed();
          depthTiles[i]->addFragment(df);
-         if(depthTest(depthTiles[i]->hizDepthFront, zPos)){
-            depthTiles[i]->hizDepthFront = zPos;
-         }
-         if(depthTest(zPos, depthTiles[i]->hizDepthBack)){
-            depthTiles[i]->hizDepthBack = zPos;
-         }
+         depthScratch[j] = zPos;
          totalFragments++;
       }
+
+      uint64_t& front = depthTiles[i]->hizDepthFront;
+      uint64_t& back = depthTiles[i]->hizDepthBack;
+      if(depthTester.ordered()){
+         depthTester.range(depthScratch.data(), depthScratch.size(), front, back);
+      } else {
+         front = back = depthScratch[0];
+         for(unsigned j=1; j < depthScratch.size(); j++){
+            if(depthTest(front, depthScratch[j])){
+               front = depthScratch[j];
+            }
+            if(depthTest(depthScratch[j], back)){
+               back = depthScratch[j];
+            }
+         }
+      }
    }
 
    DPRINTF(ZUnit, "Total tiles %d, fragments = %d\n", depthTiles.size(), totalFragments);
@@ -429,6 +402,17 @@ void ZUnit::startEarlyZ(uint64_t depthBuffStart, uint64_t depthBuffEnd, uint32_t
    schedule(tickEvent, nextCycle());
 }
 
+void ZUnit::pushHizTile(DepthFragmentTile* dt){
+   depthScratch.resize(dt->size());
+   for(unsigned i=0; i < dt->size(); i++){
+      depthScratch[i] = dt->getFragment(i)->getDepthVal();
+   }
+   dt->hizPass.resize(dt->size());
+   depthTester.testNew(dt->hizThresh(), depthScratch.data(), dt->size(),
+         dt->hizPass.data());
+   hizQ.push(dt);
+}
+
 void ZUnit::checkAndReleaseTickEvent(){
    if(!tickEvent.scheduled())
       schedule(tickEvent, nextCycle());
@@ -450,12 +434,10 @@ void ZUnit::tick(){
          active = true;
          //only proceed if we have enough space in the ztable
          DepthFragmentTile * dt = hizQ.front();
-         uint64_t hizThresh = dt->hizThresh();
          DepthFragmentTile::DepthFragment * df = dt->getFragment(currFragment);
 
          //first check if this fragment can even pass the hiZ value 
-         uint64_t fragDepthVal = df->getDepthVal();
-         if(!depthTest(hizThresh, fragDepthVal)){
+         if(!dt->hizPass[currFragment]){
             //fragment fail hiz
             currFragment++;
             doneFrags++;
@@ -548,10 +530,10 @@ void ZUnit::tick(){
          DepthFragmentTile* dt = depthTiles[currTile];
          unsigned posId = dt->getRasterTile()->m_tilePos;
          assert(posId < hizBuff.size());
-         if(depthFunc == GL_NOTEQUAL or depthFunc==GL_EQUAL){ 
-            warn_once("Unsupported depth test (GL_NOTEQUAL or GL_EQUAL), skipping HiZ\n");
+         if(not depthTester.ordered()){
+            warn_once("Unsupported depth test (GL_NOTEQUAL, GL_EQUAL or GL_ALWAYS), skipping HiZ\n");
             //skip hiZ
-            hizQ.push(dt);
+            pushHizTile(dt);
          } else if(depthTest(hizBuff.depthFront[posId], dt->hizDepthBack)){
             //the whole tile passes in this case
             hizBuff.depthFront[posId] = dt->hizDepthFront;
@@ -565,7 +547,7 @@ void ZUnit::tick(){
             for(unsigned dfi = 0; dfi < dt->size(); dfi++){
                dt->getFragment(dfi)->setPassed();
             }
-            hizQ.push(dt);
+            pushHizTile(dt);
             //DPRINTF(ZUnit, "Tile %d done at HiZ\n", dt->getId());
             //g_renderData.launchFragmentTile(dt->getRasterTile(), dt->getId());
          } else if(depthTest(hizBuff.depthBack[posId], dt->hizDepthFront)){
@@ -575,7 +557,7 @@ void ZUnit::tick(){
             if(dt->size() == tileWidth*tileHeight){
                hizBuff.depthBack[posId] = dt->hizDepthBack;
             }
-            hizQ.push(dt);
+            pushHizTile(dt);
             DPRINTF(ZUnit, "Tile %d passed HiZ\n", dt->getId());
          } else {
             //failed tile
@@ -661,44 +643,44 @@ void ZUnit::initHizBuffer(uint8_t* depthBuffer, unsigned frameWidth, unsigned fr
     }
 
 
-    std::vector<uint64_t> depthValues(frameDim);
-
-    if(dSize == DepthSize::Z16) {
-       uint16_t* p = (uint16_t*) depthBuffer;
-       for(unsigned i =0; i< frameDim; i++)
-          depthValues[i] = p[i];
-    } else if(dSize == DepthSize::Z32){
-       uint32_t* p = (uint32_t*) depthBuffer;
-       for(unsigned i =0; i< frameDim; i++)
-          depthValues[i] = p[i];
-    } else assert(0);
-    
     const unsigned fragmentsPerTile = tileH * tileW;
     assert(0 == ((frameHeight* frameWidth) % fragmentsPerTile));
     unsigned tilesCount = frameDim / fragmentsPerTile;
 
-    std::vector<bool> touchedTiles(tilesCount, false);
     hizBuff.setSize(tilesCount);
 
-    
     assert((frameWidth%tileW) == 0);
     assert((frameHeight%tileH) == 0);
-            
-    const unsigned tileRow = frameWidth / tileW;
+    if(rasterDir == RasterDirection::BlockedHorizontal){
+       assert(0); //TODO
+    } else assert(rasterDir == RasterDirection::HorizontalRaster);
 
-    for(unsigned i=0; i < depthValues.size(); i++){
-       unsigned tileIdx = -1;
-       unsigned xPos = i%frameWidth;
-       unsigned yPos = i/frameWidth;
-       unsigned tileXCoord = xPos/tileW;
-       unsigned tileYCoord = yPos/tileH;
-       if(rasterDir == RasterDirection::HorizontalRaster){
-          tileIdx = tileYCoord*tileRow + tileXCoord;
-       } else if (rasterDir == RasterDirection::BlockedHorizontal){
-          assert(0); //TODO
-       } else assert(0);
+    if(dSize == DepthSize::Z16) {
+       initHizTiles((const uint16_t*) depthBuffer, frameWidth, frameHeight, tileW, tileH);
+    } else if(dSize == DepthSize::Z32){
+       initHizTiles((const uint32_t*) depthBuffer, frameWidth, frameHeight, tileW, tileH);
+    } else assert(0);
+}
 
-       hizBuff.setDepth(tileIdx, depthValues[i]);
+//reduces each row span of a tile at once rather than one depth at a time
+template <typename T>
+void ZUnit::initHizTiles(const T* depthValues, unsigned frameWidth,
+      unsigned frameHeight, unsigned tileW, unsigned tileH){
+    const unsigned tileRow = frameWidth / tileW;
+    for(unsigned yPos=0; yPos < frameHeight; yPos++){
+       const T* row = depthValues + yPos*frameWidth;
+       unsigned tileYCoord = yPos/tileH;
+       for(unsigned xPos=0; xPos < frameWidth; xPos+= tileW){
+          unsigned tileIdx = tileYCoord*tileRow + xPos/tileW;
+          if(depthTester.ordered()){
+             uint64_t front, back;
+             depthTester.range(row + xPos, tileW, front, back);
+             hizBuff.setDepthRange(tileIdx, front, back);
+          } else {
+             for(unsigned i=0; i < tileW; i++)
+                hizBuff.setDepth(tileIdx, row[xPos + i]);
+          }
+       }
     }
 }
 
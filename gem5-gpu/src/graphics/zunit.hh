@@ -32,6 +32,7 @@
 #include <queue>
 #include <unordered_map>
 //#include <GL/gl.h>
+#include "graphics/depth_test.hh"
 #include "graphics/mesa_gpgpusim.h"
 #include "base/callback.hh"
 #include "mem/mem_object.hh"
@@ -97,7 +98,8 @@ class ZUnit : public MemObject
       Addr depthAddrStart;
       Addr depthAddrEnd;
       DepthSize depthSize;
-      GLenum depthFunc;
+      //comparison kernels for the current draw call's depth function
+      DepthTester depthTester;
 
       class DepthFragmentTile {
          public:
@@ -163,6 +165,9 @@ class ZUnit : public MemObject
             void setHizThresh(uint64_t thresh) { hizPassThresh = thresh;}
             uint64_t hizThresh() { return hizPassThresh;}
 
+            //per fragment result of the test against hizThresh()
+            std::vector<uint8_t> hizPass;
+
          private:
             std::vector<DepthFragment> depthFragments;
             unsigned doneFragments;
@@ -190,6 +195,23 @@ class ZUnit : public MemObject
             depthValid.resize(psize, false);
          }
 
+         //merges the range of a span of depths, depth function must be ordered
+         void setDepthRange(unsigned tileIdx, uint64_t front, uint64_t back){
+            assert(tileIdx < depthFront.size() and tileIdx < depthBack.size());
+            if(!depthValid[tileIdx]){
+               depthValid[tileIdx] = true;
+               depthFront[tileIdx] = front;
+               depthBack [tileIdx] = back;
+            } else {
+               if(m_zunit->depthTest(depthFront[tileIdx], front)){
+                  depthFront[tileIdx] = front;
+               }
+               if(m_zunit->depthTest(back, depthBack[tileIdx])){
+                  depthBack[tileIdx] = back;
+               }
+            }
+         }
+
          void setDepth(unsigned tileIdx, uint64_t depth){
             assert(tileIdx < depthFront.size() and tileIdx < depthBack.size());
             if(!depthValid[tileIdx]){
@@ -218,6 +240,9 @@ class ZUnit : public MemObject
       hizBuffer_t hizBuff;
 
       std::queue<DepthFragmentTile*> hizQ;
+      //tests a whole tile against its HiZ threshold before queuing it
+      void pushHizTile(DepthFragmentTile* dt);
+      std::vector<uint32_t> depthScratch;
       
       std::queue<DepthFragmentTile::DepthFragment*> depthUpdateQ;
       void pushRequest();
@@ -265,6 +290,9 @@ class ZUnit : public MemObject
 
       void printStats();
 
+      template <typename T>
+      void initHizTiles(const T* depthValues, unsigned frameWidth,
+            unsigned frameHeight, unsigned tileW, unsigned tileH);
       void initHizBuffer(uint8_t* depthBuffer, unsigned frameWidth, unsigned frameHeight, 
                DepthSize dSize, const unsigned tileW, const unsigned tileH,
                const unsigned blockH, const unsigned blockW, const RasterDirection rasterDir);
@@ -290,7 +318,9 @@ class ZUnit : public MemObject
       void startEarlyZ(uint64_t depthBuffStart, uint64_t depthBuffEnd, uint32_t bufWidth, RasterTiles& tiles, DepthSize dSize, GLenum _depthFunc,
           uint8_t* depthBuf, uint32_t frameWidth, uint32_t frameHeight, uint32_t tileH, uint32_t tileW, uint32_t blockH, uint32_t blockW, RasterDirection dir);
 
-      bool depthTest(uint64_t oldDepthVal, uint64_t newDepthVal);
+      bool depthTest(uint64_t oldDepthVal, uint64_t newDepthVal){
+         return depthTester.test(oldDepthVal, newDepthVal);
+      }
 };
 
 #endif
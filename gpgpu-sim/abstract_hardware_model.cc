@@ -86,6 +86,9 @@ void gpgpu_functional_sim_config::reg_options(class OptionParser * opp)
    option_parser_register(opp, "-gpgpu_ptx_inst_debug_thread_uid", OPT_INT32, &g_ptx_inst_debug_thread_uid, 
                "Thread UID for executed instructions' debug output", 
                "1");
+   option_parser_register(opp, "-gpgpu_ptx_sim_threads", OPT_UINT32, &m_ptx_sim_threads, 
+               "Host threads executing CTAs in pure functional simulation mode (at most one per shader core)", 
+               "1");
 }
 
 void gpgpu_functional_sim_config::ptx_set_tex_cache_linesize(unsigned linesize)
@@ -597,6 +600,8 @@ kernel_info_t::kernel_info_t( dim3 gridDim, dim3 blockDim, class function_info *
     m_uid = m_next_uid++;
     m_param_mem = new memory_space_impl<8192>("param",64*1024);
     m_stream = stream;
+    m_warp_trace = NULL;
+    m_cta_sampler = NULL;
     m_tc = tc;
     m_isGraphicsKernel = false;
     m_drawCallDone = false;
@@ -824,17 +829,34 @@ void simt_stack::update( simt_mask_t &thread_done, addr_vector_t &next_pc, addre
 
 void core_t::execute_warp_inst_t(warp_inst_t &inst, unsigned warpId)
 {
+    const ptx_instruction *alu_inst = NULL;
+    ptx_thread_info *alu_thread = NULL;
+    unsigned alu_lanes = 0;
+    unsigned alu_executed = 0;
     for ( unsigned t=0; t < m_warp_size; t++ ) {
         if( inst.active(t) ) {
             if(warpId==(unsigned (-1)))
                 warpId = inst.warp_id();
             unsigned tid=m_warp_size*warpId+t;
-            m_thread[tid]->ptx_exec_inst(inst,t);
+            if( alu_thread == NULL ) {
+                //the first active lane decides how the whole warp executes
+                alu_thread = m_thread[tid];
+                alu_inst = alu_thread->decode_warp_alu(inst);
+            }
+            if( alu_inst != NULL ) {
+                alu_lanes++;
+                if( m_thread[tid]->ptx_exec_alu_lane(alu_inst,inst,t) )
+                    alu_executed++;
+            } else {
+                m_thread[tid]->ptx_exec_inst(inst,t);
+            }
             
             //virtual function
             checkExecutionStatusAndUpdate(inst,t,tid);
         }
     } 
+    if( alu_inst != NULL )
+        alu_thread->record_warp_alu(alu_inst,alu_lanes,alu_executed);
 }
 
 void core_t::writeRegister(const warp_inst_t &inst, unsigned warpSize, unsigned lane_id, char *data) {
@@ -233,6 +233,11 @@ public:
        return m_tc;
    }
 
+   class warp_trace *get_warp_trace() const { return m_warp_trace; }
+   void set_warp_trace( class warp_trace *trace ) { m_warp_trace = trace; }
+   class cta_sampler *get_cta_sampler() const { return m_cta_sampler; }
+   void set_cta_sampler( class cta_sampler *sampler ) { m_cta_sampler = sampler; }
+
 private:
    kernel_info_t( const kernel_info_t & ); // disable copy constructor
    void operator=( const kernel_info_t & ); // disable copy operator
@@ -252,6 +257,8 @@ private:
    std::list<class ptx_thread_info *> m_active_threads;
    class memory_space *m_param_mem;
    struct CUstream_st *m_stream;
+   class warp_trace *m_warp_trace; // instruction trace captured or replayed by the timing model
+   class cta_sampler *m_cta_sampler; // CTAs simulated in detail when sampling
    
    //Thread context of the current 
    ThreadContext *m_tc;
@@ -498,6 +505,7 @@ public:
     const char* get_ptx_inst_debug_file() const  { return g_ptx_inst_debug_file; }
     int         get_ptx_inst_debug_thread_uid() const { return g_ptx_inst_debug_thread_uid; }
     unsigned    get_texcache_linesize() const { return m_texcache_linesize; }
+    unsigned    get_ptx_sim_threads() const { return m_ptx_sim_threads; }
 
 private:
     // PTX options
@@ -511,6 +519,8 @@ private:
     int   g_ptx_inst_debug_thread_uid;
 
     unsigned m_texcache_linesize;
+
+    unsigned m_ptx_sim_threads;
 };
 
 class gpgpu_t {
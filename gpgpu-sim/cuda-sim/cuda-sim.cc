@@ -40,6 +40,10 @@
 #include "../statwrapper.h"
 #include <set>
 #include <map>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "../abstract_hardware_model.h"
 #include "memory.h"
 #include "ptx-stats.h"
@@ -248,6 +252,8 @@ void function_info::ptx_assemble()
    fflush(stdout);
    printf("GPGPU-Sim PTX: finding reconvergence points for \'%s\'...\n", m_name.c_str() );
 
+   typedef std::chrono::steady_clock analysis_clock;
+   analysis_clock::time_point t_start = analysis_clock::now();
    create_basic_blocks();
    connect_basic_blocks();
    bool modified = false; 
@@ -256,6 +262,7 @@ void function_info::ptx_assemble()
       find_idominators();
       modified = connect_break_targets(); 
    } while (modified == true);
+   analysis_clock::time_point t_dom = analysis_clock::now();
 
    if ( g_debug_execution>=50 ) {
       print_basic_blocks();
@@ -265,8 +272,14 @@ void function_info::ptx_assemble()
    if ( g_debug_execution>=2 ) {
       print_dominators();
    }
+   analysis_clock::time_point t_pdom_start = analysis_clock::now();
    find_postdominators();
    find_ipostdominators();
+   analysis_clock::time_point t_pdom = analysis_clock::now();
+   printf("GPGPU-Sim PTX: reconvergence analysis for \'%s\': %zu basic blocks, dominators %.3f ms, postdominators %.3f ms\n",
+          m_name.c_str(), m_basic_blocks.size(),
+          std::chrono::duration<double,std::milli>(t_dom - t_start).count(),
+          std::chrono::duration<double,std::milli>(t_pdom - t_pdom_start).count() );
    if ( g_debug_execution>=50 ) {
       print_postdominators();
       print_ipostdominators();
@@ -814,8 +827,46 @@ static unsigned datatype2size( unsigned data_type )
    return data_size; 
 }
 
+static const ptx_inst_impl_t g_ptx_inst_impl[NUM_OPCODES] = {
+#define OP_DEF(OP,FUNC,STR,DST,CLASSIFICATION) FUNC,
+#include "opcodes.def"
+#undef OP_DEF
+};
+
+static const int g_ptx_inst_classification[NUM_OPCODES] = {
+#define OP_DEF(OP,FUNC,STR,DST,CLASSIFICATION) CLASSIFICATION,
+#include "opcodes.def"
+#undef OP_DEF
+};
+
+// resolves what ptx_exec_inst would otherwise look up on every execution:
+// the handler of the opcode, the predicate operand and the .param space
+void ptx_instruction::lower()
+{
+   if ( m_opcode >= 0 && m_opcode < NUM_OPCODES ) {
+      m_uop.impl = g_ptx_inst_impl[m_opcode];
+      m_uop.classification = g_ptx_inst_classification[m_opcode];
+   }
+   if ( m_pred != NULL ) 
+      m_uop.pred = operand_info( m_pred );
+
+   m_uop.space = m_space_spec;
+   if ( m_space_spec == param_space_unclassified && (has_memory_read() || has_memory_write()) ) {
+      const operand_info &op = has_memory_write()? dst() : src1();
+      const symbol *s = op.get_symbol();
+      if ( s != NULL && s->type() != NULL ) {
+         type_info_key ti = s->type()->get_key();
+         if ( ti.is_param_kernel() ) 
+            m_uop.space = param_space_kernel;
+         else if ( ti.is_param_local() ) 
+            m_uop.space = param_space_local;
+      }
+   }
+}
+
 void ptx_instruction::pre_decode()
 {
+   lower();
    pc = m_PC;
    isize = m_inst_size;
    for( unsigned i=0; i<4; i++) {
@@ -1363,16 +1414,8 @@ void ptx_thread_info::writeRegister(const warp_inst_t &inst, unsigned lane_id, c
    }
 }
 
-void ptx_thread_info::ptx_exec_inst( warp_inst_t &inst, unsigned lane_id)
+static void set_vector_length( warp_inst_t &inst, const ptx_instruction *pI )
 {
-    
-   bool skip = false;
-   int op_classification = 0;
-   addr_t pc = next_instr();
-   assert( pc == inst.pc ); // make sure timing model and functional model are in sync
-   const ptx_instruction *pI = m_func_info->get_instruction(pc);
-   set_npc( pc + pI->inst_size() );
-   
    unsigned vector_spec = pI->get_vector();
    //TODO: fix how the vector len is calculated for all cases
    if (vector_spec && (pI->get_opcode()!=TEX_OP)) { 
@@ -1389,6 +1432,39 @@ void ptx_thread_info::ptx_exec_inst( warp_inst_t &inst, unsigned lane_id)
    } else {
       inst.vectorLength = 1;
    }
+}
+
+// functional simulation workers count the instructions they execute locally,
+// gpgpu_cuda_ptx_sim_main_func merges the counts once the kernel is done
+static thread_local unsigned *g_ptx_sim_worker_insn = NULL;
+
+static void count_ptx_sim_insn( ptx_thread_info *thd )
+{
+   if ( g_ptx_sim_worker_insn ) {
+      (*g_ptx_sim_worker_insn)++;
+      return;
+   }
+   g_ptx_sim_num_insn++;
+   if ( (g_ptx_sim_num_insn % 100000) == 0 ) {
+      dim3 ctaid = thd->get_ctaid();
+      dim3 tid = thd->get_tid();
+      printf("GPGPU-Sim PTX: %u instructions simulated : ctaid=(%u,%u,%u) tid=(%u,%u,%u)\n",
+             g_ptx_sim_num_insn, ctaid.x,ctaid.y,ctaid.z,tid.x,tid.y,tid.z );
+      fflush(stdout);
+   }
+}
+
+void ptx_thread_info::ptx_exec_inst( warp_inst_t &inst, unsigned lane_id)
+{
+    
+   bool skip = false;
+   int op_classification = 0;
+   addr_t pc = next_instr();
+   assert( pc == inst.pc ); // make sure timing model and functional model are in sync
+   const ptx_instruction *pI = m_func_info->get_instruction(pc);
+   set_npc( pc + pI->inst_size() );
+   
+   set_vector_length(inst,pI);
 
 
    try {
@@ -1431,11 +1507,11 @@ void ptx_thread_info::ptx_exec_inst( warp_inst_t &inst, unsigned lane_id)
          *((warp_inst_t*)pJ) = inst; // copy active mask information
          pI = pJ;
       }
-      switch ( pI->get_opcode() ) {
-#define OP_DEF(OP,FUNC,STR,DST,CLASSIFICATION) case OP: FUNC(pI,this); op_classification = CLASSIFICATION; break;
-#include "opcodes.def"
-#undef OP_DEF
-      default: printf( "Execution error: Invalid opcode (0x%x)\n", pI->get_opcode() ); break;
+      if ( pI->get_impl() != NULL ) {
+         pI->get_impl()(pI,this);
+         op_classification = pI->get_classification();
+      } else {
+         printf( "Execution error: Invalid opcode (0x%x)\n", pI->get_opcode() );
       }
       delete pJ;
       pI = pI_saved;
@@ -1516,7 +1592,7 @@ void ptx_thread_info::ptx_exec_inst( warp_inst_t &inst, unsigned lane_id)
          dump_regs(stdout);
    }
    update_pc();
-   g_ptx_sim_num_insn++;
+   count_ptx_sim_insn(this);
    
    //not using it with functional simulation mode
    if(!(this->m_functionalSimulationMode))
@@ -1543,13 +1619,6 @@ void ptx_thread_info::ptx_exec_inst( warp_inst_t &inst, unsigned lane_id)
       if (space_type) StatAddSample( g_inst_classification_stat[g_ptx_kernel_count], ( int )space_type);
       StatAddSample( g_inst_op_classification_stat[g_ptx_kernel_count], (int)  pI->get_opcode() );
    }
-   if ( (g_ptx_sim_num_insn % 100000) == 0 ) {
-      dim3 ctaid = get_ctaid();
-      dim3 tid = get_tid();
-      printf("GPGPU-Sim PTX: %u instructions simulated : ctaid=(%u,%u,%u) tid=(%u,%u,%u)\n",
-             g_ptx_sim_num_insn, ctaid.x,ctaid.y,ctaid.z,tid.x,tid.y,tid.z );
-      fflush(stdout);
-   }
    
    // "Return values"
    if(!skip) {
@@ -1584,6 +1653,96 @@ void ptx_thread_info::ptx_exec_inst( warp_inst_t &inst, unsigned lane_id)
       
 }
 
+// Integer, floating point and SFU instructions only touch the registers of
+// their own thread, so the instruction lookup, vector decode and debug
+// checks of ptx_exec_inst are done once per warp. Returns NULL if the
+// instruction has to go through ptx_exec_inst.
+const ptx_instruction *ptx_thread_info::decode_warp_alu( warp_inst_t &inst )
+{
+   if ( g_debug_execution >= 5 || gpgpu_ptx_instruction_classification ) 
+      return NULL;
+   if ( m_gpu->get_config().get_ptx_inst_debug_to_file() != 0 ) 
+      return NULL;
+   const ptx_instruction *pI = m_func_info->get_instruction(inst.pc);
+   if ( pI == NULL || pI->is_exit() || pI->has_memory_read() || pI->has_memory_write() ) 
+      return NULL;
+   switch ( pI->get_classification() ) {
+   case 1: // integer
+   case 2: // floating point
+   case 4: // SFU
+      break;
+   default:
+      return NULL;
+   }
+   assert( inst.memory_op == no_memory_op );
+   set_vector_length(inst,pI);
+   return pI;
+}
+
+// lane part of ptx_exec_inst for instructions accepted by decode_warp_alu,
+// returns false if the lane is predicated off
+bool ptx_thread_info::ptx_exec_alu_lane( const ptx_instruction *pI, warp_inst_t &inst, unsigned lane_id )
+{
+   bool skip = false;
+   addr_t pc = next_instr();
+   assert( pc == inst.pc ); // make sure timing model and functional model are in sync
+   set_npc( pc + pI->inst_size() );
+
+   try {
+
+   clearRPC();
+   m_last_set_operand_value.u64 = 0;
+
+   if(is_done())
+   {
+      printf("attempted to execute instruction on a thread that is already done.\n");
+      assert(0);
+   }
+
+   if( pI->has_pred() ) {
+      const operand_info &pred = pI->get_pred();
+      ptx_reg_t pred_value = get_operand_value(pred, pred, PRED_TYPE, this, 0);
+      if(pI->get_pred_mod() == -1) {
+            skip = (pred_value.pred & 0x0001) ^ pI->get_pred_neg(); //ptxplus inverts the zero flag
+      } else {
+            skip = !pred_lookup(pI->get_pred_mod(), pred_value.pred & 0x000F);
+      }
+   }
+
+   if( skip ) 
+      inst.set_not_active(lane_id);
+   else 
+      pI->get_impl()(pI,this);
+
+   inst.set_addr(lane_id, 0xFEEBDAED);
+   update_pc();
+   count_ptx_sim_insn(this);
+
+   // "Return values"
+   if(!skip) {
+      inst.space = undefined_space;
+      inst.set_addr(lane_id, last_eaddrs(), last_eaddrs_count());
+      inst.data_size = 0;
+   }
+
+   } catch ( int x  ) {
+      printf("GPGPU-Sim PTX: ERROR (%d) executing intruction (%s:%u)\n", x, pI->source_file(), pI->source_line() );
+      printf("GPGPU-Sim PTX:       '%s'\n", pI->get_source() );
+      abort();
+   }
+   return !skip;
+}
+
+// per lane statistics of ptx_exec_inst, added once for the whole warp
+void ptx_thread_info::record_warp_alu( const ptx_instruction *pI, unsigned lanes, unsigned executed )
+{
+   if( executed > 0 ) 
+      m_gpu->gem5CudaGPU->getCudaCore(m_hw_sid)->record_inst(pI->get_classification(), executed);
+   //not using it with functional simulation mode
+   if(!(this->m_functionalSimulationMode))
+      ptx_file_line_stats_add_exec_count(pI, lanes);
+}
+
 void set_param_gpgpu_num_shaders(int num_shaders)
 {
    gpgpu_param_num_shaders = num_shaders;
@@ -1962,6 +2121,38 @@ ptx_cta_info *g_func_cta_info = NULL;
 
 #define MAX(a,b) (((a)>(b))?(a):(b))
 
+// CTA setup and teardown go through the kernel's CTA dispenser and the
+// shared/local memory lookups of ptx_sim_init_thread, workers hold this lock
+// for those and only execute their CTAs concurrently
+static std::mutex g_functional_cta_lock;
+
+static void functional_sim_worker( kernel_info_t *kernel, unsigned sid, unsigned *num_insn )
+{
+    extern gpgpu_sim *g_the_gpu;
+
+    g_ptx_sim_worker_insn = num_insn;
+    while(true){
+        functionalCoreSim *cta;
+        {
+            std::lock_guard<std::mutex> lock(g_functional_cta_lock);
+            if(kernel->no_more_ctas_to_run())
+                break;
+            cta = new functionalCoreSim(
+                kernel,
+                g_the_gpu,
+                g_the_gpu->getShaderCoreConfig()->warp_size,
+                sid
+            );
+            cta->initializeCTA();
+        }
+        cta->run();
+
+        std::lock_guard<std::mutex> lock(g_functional_cta_lock);
+        delete cta;
+    }
+    g_ptx_sim_worker_insn = NULL;
+}
+
 /*!
 This function simulates the CUDA code functionally, it takes a kernel_info_t parameter 
 which holds the data for the CUDA kernel to be executed
@@ -1973,14 +2164,36 @@ void gpgpu_cuda_ptx_sim_main_func( kernel_info_t &kernel, bool openCL )
      //using a shader core object for book keeping, it is not needed but as most function built for performance simulation need it we use it here
     extern gpgpu_sim *g_the_gpu;
 
-    //we excute the kernel one CTA (Block) at the time, as synchronization functions work block wise
-    while(!kernel.no_more_ctas_to_run() && !kernel.isDrawCallDone()){
-        functionalCoreSim cta(
-            &kernel,
-            g_the_gpu,
-            g_the_gpu->getShaderCoreConfig()->warp_size
-        );
-        cta.execute();
+    //CTAs are independent apart from atomics, so they can run on several host threads,
+    //each worker impersonates its own shader core so that CTAs don't share shared memory
+    //or core stats. Graphics kernels update the renderer state as their threads exit and
+    //debug traces/instruction classification are order dependent, these run serially
+    unsigned threads = g_the_gpu->get_config().get_ptx_sim_threads();
+    if(threads > g_the_gpu->get_config().num_shader())
+        threads = g_the_gpu->get_config().num_shader();
+    if(kernel.isGraphicsKernel() || g_debug_execution != 0 || gpgpu_ptx_instruction_classification
+          || g_the_gpu->get_config().get_ptx_inst_debug_to_file())
+        threads = 1;
+
+    if(threads > 1){
+        std::vector<unsigned> num_insn(threads, 0);
+        std::vector<std::thread> workers;
+        for(unsigned i=0;i<threads;i++)
+            workers.push_back(std::thread(functional_sim_worker, &kernel, i, &num_insn[i]));
+        for(unsigned i=0;i<threads;i++){
+            workers[i].join();
+            g_ptx_sim_num_insn += num_insn[i];
+        }
+    } else {
+        //we excute the kernel one CTA (Block) at the time, as synchronization functions work block wise
+        while(!kernel.no_more_ctas_to_run() && !kernel.isDrawCallDone()){
+            functionalCoreSim cta(
+                &kernel,
+                g_the_gpu,
+                g_the_gpu->getShaderCoreConfig()->warp_size
+            );
+            cta.execute();
+        }
     }
     
    //registering this kernel as done      
@@ -2018,6 +2231,24 @@ void gpgpu_cuda_ptx_sim_main_func( kernel_info_t &kernel, bool openCL )
    fflush(stdout); 
 }
 
+/*!
+Executes the kernel's next CTA functionally while the timing model is running, for CTAs that
+CTA sampling does not simulate in detail. The CTA uses shader core sid's memories, with
+hardware thread ids starting at tid_base
+!*/
+void gpgpu_cuda_ptx_sim_cta( kernel_info_t &kernel, unsigned sid, unsigned tid_base )
+{
+    extern gpgpu_sim *g_the_gpu;
+    functionalCoreSim cta(
+        &kernel,
+        g_the_gpu,
+        g_the_gpu->getShaderCoreConfig()->warp_size,
+        sid,
+        tid_base
+    );
+    cta.execute();
+}
+
 void functionalCoreSim::initializeCTA()
 {
     int ctaLiveThreads=0;
@@ -2031,7 +2262,7 @@ void functionalCoreSim::initializeCTA()
     
     //get threads for a cta
     for(unsigned i=0; i<m_kernel->threads_per_cta();i++) {
-        ptx_sim_init_thread(*m_kernel,&m_thread[i],0,i,m_kernel->threads_per_cta()-i,m_kernel->threads_per_cta(),this,0,i/m_warp_size,(gpgpu_t*)m_gpu, true);
+        ptx_sim_init_thread(*m_kernel,&m_thread[i],m_sid,m_tid_base+i,m_kernel->threads_per_cta()-i,m_kernel->threads_per_cta(),this,0,i/m_warp_size,(gpgpu_t*)m_gpu, true);
         assert(m_thread[i]!=NULL && !m_thread[i]->is_done());
         ctaLiveThreads++;
     }
@@ -2058,7 +2289,11 @@ void  functionalCoreSim::createWarp(unsigned warpId)
 void functionalCoreSim::execute()
  {
     initializeCTA();
-    
+    run();
+ }
+
+void functionalCoreSim::run()
+ {
     //start executing the CTA
     while(true){
         bool someOneLive= false;
@@ -54,6 +54,7 @@ extern class kernel_info_t *gpgpu_opencl_ptx_sim_init_grid(class function_info *
                                             struct dim3 blockDim, 
                                                           class gpgpu_t *gpu );
 extern void gpgpu_cuda_ptx_sim_main_func( kernel_info_t &kernel, bool openCL = false );
+extern void gpgpu_cuda_ptx_sim_cta( kernel_info_t &kernel, unsigned sid, unsigned tid_base );
 extern void   print_splash();
 extern void   gpgpu_ptx_sim_register_const_variable(void*, const char *deviceName, size_t size );
 extern void   gpgpu_ptx_sim_register_global_variable(void *hostVar, const char *deviceName, size_t size );
@@ -86,8 +87,10 @@ C_DATA_TYPE blendU32(C_DATA_TYPE color_src, C_DATA_TYPE color_dst);
 class functionalCoreSim: public core_t
 {    
 public:
-    functionalCoreSim(kernel_info_t * kernel, gpgpu_sim *g, unsigned warp_size)
-        : core_t( g, kernel, warp_size, kernel->threads_per_cta() )
+    functionalCoreSim(kernel_info_t * kernel, gpgpu_sim *g, unsigned warp_size, unsigned sid = 0, unsigned tid_base = 0)
+        : core_t( g, kernel, warp_size, kernel->threads_per_cta() ),
+          m_sid( sid ),
+          m_tid_base( tid_base )
     {
         m_warpAtBarrier =  new bool [m_warp_count];
         m_liveThreadCount = new unsigned [m_warp_count];
@@ -99,6 +102,10 @@ public:
     }
     //! executes all warps till completion 
     void execute();
+    //initializes threads in the CTA block which we are executing
+    void initializeCTA();
+    //! executes the warps of an initialized CTA till completion
+    void run();
     virtual void warp_exit( unsigned warp_id );
     virtual bool warp_waiting_at_barrier( unsigned warp_id ) const  
     {
@@ -107,8 +114,6 @@ public:
     
 private:
     void executeWarp(unsigned, bool &, bool &);
-    //initializes threads in the CTA block which we are executing
-    void initializeCTA();
     virtual void checkExecutionStatusAndUpdate(warp_inst_t &inst, unsigned t, unsigned tid)
     {
     if(m_thread[tid]==NULL || m_thread[tid]->is_done()){
@@ -122,6 +127,10 @@ private:
     //each warp live thread count and barrier indicator
     unsigned * m_liveThreadCount;
     bool* m_warpAtBarrier;
+    //shader core whose shared/local memory and stats this CTA uses
+    unsigned m_sid;
+    //first hardware thread id of the CTA on that core
+    unsigned m_tid_base;
 };
 
 #define RECONVERGE_RETURN_PC ((address_type)-2)
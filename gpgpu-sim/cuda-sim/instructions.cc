@@ -41,6 +41,7 @@
 #include "cuda-math.h"
 #include "instructions.h"
 #include "instructions_extra.h"
+#include "memory.h"
 #include "ptx_ir.h"
 #include "opcodes.h"
 #include "ptx_sim.h"
@@ -64,6 +65,22 @@ void inst_not_implemented( const ptx_instruction * pI ) ;
 
 void sign_extend( ptx_reg_t &data, unsigned src_size, const operand_info &dst );
 
+// global and const memory of functionally simulated CTAs
+static gem5memorySpace g_functional_global_mem;
+// keeps global atomics of concurrently simulated functional CTAs indivisible
+static std::mutex g_functional_atomic_lock;
+
+// global, const and local data of timing simulated threads is moved by the
+// gem5 memory system when the access completes, not at execution
+static bool accessed_by_timing_model( memory_space_t space, ptx_thread_info *thread )
+{
+   if( thread->accessesMemoryFunctionally() )
+      return false;
+   return space.get_type() == global_space ||
+          space.get_type() == const_space ||
+          space.get_type() == local_space;
+}
+
 void writeVertexResultData(const operand_info &dst, const ptx_reg_t &data, unsigned type, ptx_thread_info *thread, const ptx_instruction *pI ){
 
     //TODO: remove this function
@@ -220,13 +237,24 @@ unsigned readBufferWidth(){
     return readMESABufferWidth();
 }
 
+// registers declared by the function of the frame are indexed by slot
+static inline ptx_reg_t &frame_reg( reg_frame_t &frame, const symbol *reg )
+{
+   return frame.at(reg,reg->reg_slot_owner(),reg->reg_slot());
+}
+
+static inline ptx_reg_t *frame_find( reg_frame_t &frame, const symbol *reg )
+{
+   return frame.find(reg,reg->reg_slot_owner(),reg->reg_slot());
+}
+
 void ptx_thread_info::set_reg( const symbol *reg, const ptx_reg_t &value ) 
 {
    assert( reg != NULL );
-   if( reg->name() == "_" ) return;
+   if( reg->is_null_reg() ) return;
    assert( !m_regs.empty() );
    assert( reg->uid() > 0 );
-   m_regs.back()[ reg ] = value;
+   frame_reg(m_regs.back(),reg) = value;
    if (m_enable_debug_trace ) 
       m_debug_trace_regs_modified.back()[ reg ] = value;
    m_last_set_operand_value = value;
@@ -237,8 +265,8 @@ ptx_reg_t ptx_thread_info::get_reg( const symbol *reg )
    static bool unfound_register_warned = false;
    assert( reg != NULL );
    assert( !m_regs.empty() );
-   reg_map_t::iterator regs_iter = m_regs.back().find(reg);
-   if (regs_iter == m_regs.back().end()) {
+   ptx_reg_t *value = frame_find(m_regs.back(),reg);
+   if (value == NULL) {
       assert( reg->type()->get_key().is_reg() );
       const std::string &name = reg->name();
       unsigned call_uid = m_callstack.back().m_call_uid;
@@ -252,14 +280,14 @@ ptx_reg_t ptx_thread_info::get_reg( const symbol *reg )
                  file_loc.c_str(), name.c_str(), call_uid );
           unfound_register_warned = true;
       }
-      regs_iter = m_regs.back().find(reg);
+      value = frame_find(m_regs.back(),reg);
    }
    if (m_enable_debug_trace ) 
-      m_debug_trace_regs_read.back()[ reg ] = regs_iter->second;
-   return regs_iter->second;
+      m_debug_trace_regs_read.back()[ reg ] = *value;
+   return *value;
 }
 
-ptx_reg_t ptx_thread_info::get_operand_value( const operand_info &op, operand_info dstInfo, unsigned opType, ptx_thread_info *thread, int derefFlag )
+ptx_reg_t ptx_thread_info::get_operand_value( const operand_info &op, const operand_info &dstInfo, unsigned opType, ptx_thread_info *thread, int derefFlag )
 {
    ptx_reg_t result;
 
@@ -471,9 +499,9 @@ void ptx_thread_info::get_vector_operand_values( const operand_info &op, ptx_reg
       const symbol *sym = NULL;
       sym = op.vec_symbol(idx);
       if( strcmp(sym->name().c_str(),"_") != 0) {
-         reg_map_t::iterator reg_iter = m_regs.back().find(sym);
-         assert( reg_iter != m_regs.back().end() );
-         ptx_regs[idx] = reg_iter->second;
+         ptx_reg_t *value = frame_find(m_regs.back(),sym);
+         assert( value != NULL );
+         ptx_regs[idx] = *value;
       }
    }
 }
@@ -509,7 +537,7 @@ void sign_extend( ptx_reg_t &data, unsigned src_size, const operand_info &dst )
         ptx_reg_t predValue;
         
         const symbol *sym = dst.vec_symbol(0);
-        predValue.u64 = (m_regs.back()[ sym ].u64) & ~(0x0C);
+        predValue.u64 = (frame_reg(m_regs.back(),sym).u64) & ~(0x0C);
         predValue.u64 |= ((overflow & 0x01)<<3);
         predValue.u64 |= ((carry & 0x01)<<2);
 
@@ -644,11 +672,11 @@ void ptx_thread_info::set_operand_value( const operand_info &dst, const ptx_reg_
 
           if(dst.get_operand_lohi() == 1)
           {
-              setValue.u64 = ((m_regs.back()[ regName ].u64) & (~(0xFFFF))) + (data.u64 & 0xFFFF);
+              setValue.u64 = ((frame_reg(m_regs.back(),regName).u64) & (~(0xFFFF))) + (data.u64 & 0xFFFF);
           }
           else if(dst.get_operand_lohi() == 2)
           {
-              setValue.u64 = ((m_regs.back()[ regName ].u64) & (~(0xFFFF0000))) + ((data.u64<<16) & 0xFFFF0000);
+              setValue.u64 = ((frame_reg(m_regs.back(),regName).u64) & (~(0xFFFF0000))) + ((data.u64<<16) & 0xFFFF0000);
           }
 
           set_reg(predName,predValue);
@@ -701,11 +729,11 @@ void ptx_thread_info::set_operand_value( const operand_info &dst, const ptx_reg_
       {
           if(dst.get_operand_lohi() == 1)
           {
-              setValue.u64 = ((m_regs.back()[ dst.get_symbol() ].u64) & (~(0xFFFF))) + (data.u64 & 0xFFFF);
+              setValue.u64 = ((frame_reg(m_regs.back(),dst.get_symbol()).u64) & (~(0xFFFF))) + (data.u64 & 0xFFFF);
           }
           else if(dst.get_operand_lohi() == 2)
           {
-              setValue.u64 = ((m_regs.back()[ dst.get_symbol() ].u64) & (~(0xFFFF0000))) + ((data.u64<<16) & 0xFFFF0000);
+              setValue.u64 = ((frame_reg(m_regs.back(),dst.get_symbol()).u64) & (~(0xFFFF0000))) + ((data.u64<<16) & 0xFFFF0000);
           }
           set_reg(dst.get_symbol(),setValue);
       }
@@ -1049,16 +1077,21 @@ void atom_callback( const inst_t* inst, ptx_thread_info* thread)
    assert( space == global_space || space == shared_space );
 
    memory_space *mem = NULL;
-   if(space == global_space)
-       panic("gem5-gpu: Global atomics shouldn't call atom_callback!\n");
-   else if(space == shared_space)
+   std::unique_lock<std::mutex> atomic_lock(g_functional_atomic_lock, std::defer_lock);
+   if(space == global_space) {
+       // the memory system performs global atomics of timing simulated threads
+       if(!thread->accessesMemoryFunctionally())
+           panic("gem5-gpu: Global atomics shouldn't call atom_callback!\n");
+       mem = &g_functional_global_mem;
+       atomic_lock.lock();
+   } else if(space == shared_space)
        mem = thread->m_shared_mem;
    else
        abort();
 
    // Copy value pointed to in operand 'a' into register 'd'
    // (i.e. copy src1_data to dst)
-   mem->read(effective_address,size/8,&data.s64);
+   mem->read(effective_address,size/8,&data.s64,thread,pI);
    if (dst.get_symbol()->type()){
      thread->set_operand_value(dst, data, to_type, thread, pI);                         // Write value into register 'd'
    }
@@ -1453,7 +1486,7 @@ void call_impl( const ptx_instruction *pI, ptx_thread_info *thread )
       assert( callee_pc == thread->get_pc() );
    }
 
-   thread->callstack_push(callee_pc + pI->inst_size(), callee_rpc, return_var_src, return_var_dst, call_uid_next++);
+   thread->callstack_push(callee_pc + pI->inst_size(), callee_rpc, return_var_src, return_var_dst, __sync_fetch_and_add(&call_uid_next,1));
 
    copy_buffer_list_into_frame(thread, arg_values);
 
@@ -1479,7 +1512,7 @@ void callp_impl( const ptx_instruction *pI, ptx_thread_info *thread )
       assert( callee_pc == thread->get_pc() );
    } 
 
-   thread->callstack_push_plus(callee_pc + pI->inst_size(), callee_rpc, return_var_src, return_var_dst, call_uid_next++);
+   thread->callstack_push_plus(callee_pc + pI->inst_size(), callee_rpc, return_var_src, return_var_dst, __sync_fetch_and_add(&call_uid_next,1));
    thread->set_npc(target_pc);
 }
 
@@ -2316,25 +2349,31 @@ void decode_space( memory_space_t &space, ptx_thread_info *thread, const operand
          abort(); 
       }
    }
+   // functionally simulated CTAs have no timing model behind them, their
+   // global and const accesses go straight to gem5 memory and local ones to
+   // the thread's own local memory space
+   bool functional = thread->accessesMemoryFunctionally();
+   memory_space *global_mem = functional ? &g_functional_global_mem : thread->get_global_memory();
+   memory_space *local_mem = functional ? thread->m_local_mem : thread->get_global_memory();
    switch ( space.get_type() ) {
-   case global_space: mem = thread->get_global_memory(); break;
+   case global_space: mem = global_mem; break;
    case param_space_local:
    case local_space:
-      mem = thread->get_global_memory();
+      mem = local_mem;
       addr += thread->get_local_mem_stack_pointer();
       break; 
    case tex_space:    mem = thread->get_tex_memory(); break; 
    case surf_space:   mem = thread->get_surf_memory(); break; 
    case param_space_kernel:  mem = thread->get_param_memory(); break;
    case shared_space:  mem = thread->m_shared_mem; break; 
-   case const_space:  mem = thread->get_global_memory(); break;
+   case const_space:  mem = global_mem; break;
    case generic_space:
       if( thread->get_ptx_version().ver() >= 2.0 ) {
          // convert generic address to memory space address
          space = whichspace(addr);
          switch ( space.get_type() ) {
-         case global_space: mem = thread->get_global_memory(); addr = generic_to_global(addr); break;
-         case local_space:  mem = thread->get_global_memory(); addr = generic_to_local(smid,hwtid,addr); break; 
+         case global_space: mem = global_mem; addr = generic_to_global(addr); break;
+         case local_space:  mem = local_mem; addr = generic_to_local(smid,hwtid,addr); break; 
          case shared_space: mem = thread->m_shared_mem; addr = generic_to_shared(smid,addr); break; 
          default: abort();
          }
@@ -2368,7 +2407,7 @@ void ld_exec( const ptx_instruction *pI, ptx_thread_info *thread )
 
    ptx_reg_t src1_data = thread->get_operand_value(src1, dst, type, thread, 1);
    ptx_reg_t data;
-   memory_space_t space = pI->get_space();
+   memory_space_t space = pI->get_resolved_space();
    unsigned vector_spec = pI->get_vector();
 
    memory_space *mem = NULL;
@@ -2378,9 +2417,7 @@ void ld_exec( const ptx_instruction *pI, ptx_thread_info *thread )
 
    thread->get_gpu()->gem5CudaGPU->getCudaCore(thread->get_hw_sid())->record_ld(space);
 
-   if (space.get_type() != global_space &&
-       space.get_type() != const_space &&
-       space.get_type() != local_space) {
+   if (!accessed_by_timing_model(space,thread)) {
        size_t size;
        int t;
        data.u64=0;
@@ -4297,12 +4334,14 @@ void vsub_impl( const ptx_instruction *pI, ptx_thread_info *thread ) { inst_not_
 
 void vote_impl( const ptx_instruction *pI, ptx_thread_info *thread ) 
 {
-   static bool first_in_warp = true;
-   static bool and_all;
-   static bool or_all;
-   static unsigned int ballot_result;
-   static std::list<ptx_thread_info*> threads_in_warp;
-   static unsigned last_tid;
+   // a warp's lanes execute back to back on one host thread, functional 
+   // simulation workers each collect their own warp
+   static thread_local bool first_in_warp = true;
+   static thread_local bool and_all;
+   static thread_local bool or_all;
+   static thread_local unsigned int ballot_result;
+   static thread_local std::list<ptx_thread_info*> threads_in_warp;
+   static thread_local unsigned last_tid;
 
    if( first_in_warp ) {
       first_in_warp = false;
@@ -4592,7 +4631,7 @@ void store_func( const ptx_instruction *pI, ptx_thread_info *thread )
    unsigned type = pI->get_type();
    ptx_reg_t addr_reg = thread->get_operand_value(dst, dst, type, thread, 1);
    ptx_reg_t data;
-   memory_space_t space = pI->get_space();
+   memory_space_t space = pI->get_resolved_space();
    unsigned vector_spec = pI->get_vector();
 
    memory_space *mem = NULL;
@@ -4600,9 +4639,7 @@ void store_func( const ptx_instruction *pI, ptx_thread_info *thread )
    decode_space(space,thread,dst,mem,addr);
    thread->get_gpu()->gem5CudaGPU->getCudaCore(thread->get_hw_sid())->record_st(space);
 
-   if (space.get_type() != global_space &&
-       space.get_type() != const_space &&
-       space.get_type() != local_space) {
+   if (!accessed_by_timing_model(space,thread)) {
    size_t size;
    int t;
    type_info_key::type_decode(type,size,t);
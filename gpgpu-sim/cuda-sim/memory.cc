@@ -27,14 +27,22 @@
 
 #include "memory.h"
 #include <stdlib.h>
+#include <sys/mman.h>
 #include "../debug.h"
 #include "ptx_sim.h"
 #include "api/gpu_syscall_helper.hh"
 
+static std::atomic<unsigned> g_memory_space_uid(0);
+
+template<unsigned BSIZE> thread_local mem_page_cache_t memory_space_impl<BSIZE>::sm_last_page[MEM_PAGE_CACHE_SIZE];
+
 template<unsigned BSIZE> memory_space_impl<BSIZE>::memory_space_impl( std::string name, unsigned hash_size )
 {
    m_name = name;
-   MEM_MAP_RESIZE(hash_size);
+   m_uid = ++g_memory_space_uid;
+   m_sparse_leaves = (size_t)BSIZE*hash_size >= MEM_SPARSE_LEAF_SIZE && 
+                     (size_t)BSIZE*radix_size >= MEM_SPARSE_LEAF_SIZE;
+   MEM_MAP_RESIZE(hash_size >> (2*radix_bits));
 
    m_log2_block_size = -1;
    for( unsigned n=0, mask=1; mask != 0; mask <<= 1, n++ ) {
@@ -46,37 +54,169 @@ template<unsigned BSIZE> memory_space_impl<BSIZE>::memory_space_impl( std::strin
    assert( m_log2_block_size != (unsigned)-1 );
 }
 
-template<unsigned BSIZE> void memory_space_impl<BSIZE>::write( mem_addr_t addr, size_t length, const void *data, class ptx_thread_info *thd, const ptx_instruction *pI)
+template<unsigned BSIZE> memory_space_impl<BSIZE>::~memory_space_impl()
 {
-   mem_addr_t index = addr >> m_log2_block_size;
-   if ( (addr+length) <= (index+1)*BSIZE ) {
-      // fast route for intra-block access 
-      unsigned offset = addr & (BSIZE-1);
-      unsigned nbytes = length;
-      m_data[index].write(offset,nbytes,(const unsigned char*)data);
+   typename map_t::iterator i_dir;
+   for( i_dir = m_data.begin(); i_dir != m_data.end(); ++i_dir ) {
+      dir_t *dir = i_dir->second;
+      for( unsigned l=0; l < radix_size; l++ ) {
+         leaf_t *leaf = dir->m_leaf[l].load(std::memory_order_relaxed);
+         if( leaf == NULL ) 
+            continue;
+         if( leaf->m_region ) {
+            munmap(leaf->m_region, (size_t)BSIZE*radix_size);
+         } else {
+            for( unsigned p=0; p < radix_size; p++ ) 
+               free(leaf->m_page[p].load(std::memory_order_relaxed));
+         }
+         delete leaf;
+      }
+      delete dir;
+   }
+}
+
+template<unsigned BSIZE> typename memory_space_impl<BSIZE>::leaf_t *memory_space_impl<BSIZE>::new_leaf() const
+{
+   leaf_t *leaf = new leaf_t;
+   leaf->m_region = NULL;
+   for( unsigned p=0; p < radix_size; p++ ) 
+      leaf->m_page[p].store(NULL, std::memory_order_relaxed);
+   if( m_sparse_leaves ) {
+      // pages of an anonymous mapping read as zero until they are written
+      void *region = mmap(NULL, (size_t)BSIZE*radix_size, PROT_READ|PROT_WRITE, 
+                          MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+      if( region != MAP_FAILED ) 
+         leaf->m_region = (unsigned char*)region;
+   }
+   return leaf;
+}
+
+template<unsigned BSIZE> typename memory_space_impl<BSIZE>::dir_t *memory_space_impl<BSIZE>::find_dir( mem_addr_t index, bool alloc ) const
+{
+   mem_page_cache_t &cache = sm_last_page[m_uid % MEM_PAGE_CACHE_SIZE];
+   mem_addr_t dir_index = index >> (2*radix_bits);
+   if( cache.m_dir != NULL && cache.m_dir_index == dir_index ) 
+      return (dir_t*)cache.m_dir;
+
+   dir_t *dir = NULL;
+   {
+      std::lock_guard<std::mutex> lock(m_page_lock);
+      typename map_t::iterator i = m_data.find(dir_index);
+      if( i != m_data.end() ) {
+         dir = i->second;
+      } else if( alloc ) {
+         dir = new dir_t;
+         for( unsigned l=0; l < radix_size; l++ ) 
+            dir->m_leaf[l].store(NULL, std::memory_order_relaxed);
+         m_data[dir_index] = dir;
+      }
+   }
+   if( dir != NULL ) {
+      cache.m_dir_index = dir_index;
+      cache.m_dir = dir;
+   }
+   return dir;
+}
+
+template<unsigned BSIZE> unsigned char *memory_space_impl<BSIZE>::find_page( mem_addr_t index, bool alloc, leaf_t *&leaf ) const
+{
+   mem_page_cache_t &cache = sm_last_page[m_uid % MEM_PAGE_CACHE_SIZE];
+   if( cache.m_space_uid == m_uid ) {
+      if( cache.m_page != NULL && cache.m_index == index ) {
+         leaf = (leaf_t*)cache.m_leaf;
+         return cache.m_page;
+      }
+   } else {
+      cache.m_space_uid = m_uid;
+      cache.m_page = NULL;
+      cache.m_dir = NULL;
+   }
+
+   dir_t *dir = find_dir(index, alloc);
+   if( dir == NULL ) 
+      return NULL;
+
+   std::atomic<leaf_t*> &leaf_slot = dir->m_leaf[(index >> radix_bits) & (radix_size-1)];
+   leaf = leaf_slot.load(std::memory_order_acquire);
+   if( leaf == NULL ) {
+      if( !alloc ) 
+         return NULL;
+      std::lock_guard<std::mutex> lock(m_page_lock);
+      leaf = leaf_slot.load(std::memory_order_relaxed);
+      if( leaf == NULL ) {
+         leaf = new_leaf();
+         leaf_slot.store(leaf, std::memory_order_release);
+      }
+   }
+
+   unsigned slot = index & (radix_size-1);
+   unsigned char *page;
+   if( leaf->m_region ) {
+      // the slot only records that the page was written, for print()
+      page = leaf->m_region + (size_t)slot*BSIZE;
+      if( alloc ) 
+         leaf->m_page[slot].store(page, std::memory_order_relaxed);
    } else {
-      // slow route for inter-block access
-      unsigned nbytes_remain = length;
-      unsigned src_offset = 0; 
-      mem_addr_t current_addr = addr; 
-
-      while (nbytes_remain > 0) {
-         unsigned offset = current_addr & (BSIZE-1);
-         mem_addr_t page = current_addr >> m_log2_block_size; 
-         mem_addr_t access_limit = offset + nbytes_remain; 
-         if (access_limit > BSIZE) {
-            access_limit = BSIZE;
-         } 
-         
-         size_t tx_bytes = access_limit - offset; 
-         m_data[page].write(offset, tx_bytes, &((const unsigned char*)data)[src_offset]);
-
-         // advance pointers 
-         src_offset += tx_bytes; 
-         current_addr += tx_bytes; 
-         nbytes_remain -= tx_bytes; 
+      page = leaf->m_page[slot].load(std::memory_order_acquire);
+      if( page == NULL ) {
+         if( !alloc ) 
+            return NULL;
+         std::lock_guard<std::mutex> lock(m_page_lock);
+         page = leaf->m_page[slot].load(std::memory_order_relaxed);
+         if( page == NULL ) {
+            page = (unsigned char*)calloc(1,BSIZE);
+            leaf->m_page[slot].store(page, std::memory_order_release);
+         }
       }
-      assert(nbytes_remain == 0); 
+   }
+   // pages of a sparse leaf are only cached once written, so that a later
+   // write through the cache still marks them
+   if( alloc || !leaf->m_region ) {
+      cache.m_index = index;
+      cache.m_page = page;
+      cache.m_leaf = leaf;
+   }
+   return page;
+}
+
+template<unsigned BSIZE> unsigned char *memory_space_impl<BSIZE>::find_run( mem_addr_t addr, size_t length, bool alloc, size_t &run ) const
+{
+   mem_addr_t index = addr >> m_log2_block_size;
+   unsigned offset = addr & (BSIZE-1);
+   run = BSIZE - offset;
+   leaf_t *leaf = NULL;
+   unsigned char *page = find_page(index, alloc, leaf);
+   if( run >= length ) {
+      run = length;
+   } else if( page != NULL && leaf->m_region ) {
+      // the following pages of a sparse leaf are contiguous with this one
+      unsigned slot = index & (radix_size-1);
+      size_t leaf_run = (size_t)(radix_size - slot)*BSIZE - offset;
+      run = (length < leaf_run)? length : leaf_run;
+      if( alloc ) {
+         unsigned last = slot + (offset + run - 1)/BSIZE;
+         for( unsigned p=slot+1; p <= last; p++ ) 
+            leaf->m_page[p].store(leaf->m_region + (size_t)p*BSIZE, std::memory_order_relaxed);
+      }
+   }
+   return (page != NULL)? page + offset : NULL;
+}
+
+template<unsigned BSIZE> void memory_space_impl<BSIZE>::write( mem_addr_t addr, size_t length, const void *data, class ptx_thread_info *thd, const ptx_instruction *pI)
+{
+   // copy run by run, a sparse leaf takes a multi-page access in one go
+   size_t nbytes_remain = length;
+   const unsigned char *src = (const unsigned char*)data;
+   mem_addr_t current_addr = addr; 
+   while (nbytes_remain > 0) {
+      size_t tx_bytes;
+      unsigned char *dst = find_run(current_addr, nbytes_remain, true, tx_bytes);
+      memcpy(dst, src, tx_bytes);
+
+      // advance pointers 
+      src += tx_bytes; 
+      current_addr += tx_bytes; 
+      nbytes_remain -= tx_bytes; 
    }
    if( !m_watchpoints.empty() ) {
       std::map<unsigned,mem_addr_t>::iterator i;
@@ -88,65 +228,58 @@ template<unsigned BSIZE> void memory_space_impl<BSIZE>::write( mem_addr_t addr,
    }
 }
 
-template<unsigned BSIZE> void memory_space_impl<BSIZE>::read_single_block( mem_addr_t blk_idx, mem_addr_t addr, size_t length, void *data) const
+template<unsigned BSIZE> void memory_space_impl<BSIZE>::read( mem_addr_t addr, size_t length, void *data, ptx_thread_info *thd, const ptx_instruction *pI ) const
 {
-   if ((addr + length) > (blk_idx + 1) * BSIZE) {
-      printf("GPGPU-Sim PTX: ERROR * access to memory \'%s\' is unaligned : addr=0x%x, length=%zu\n",
-             m_name.c_str(), addr, length);
-      printf("GPGPU-Sim PTX: (addr+length)=0x%lx > 0x%x=(index+1)*BSIZE, index=0x%x, BSIZE=0x%x\n",
-             (addr+length),(blk_idx+1)*BSIZE, blk_idx, BSIZE);
-      throw 1;
-   }
-   typename map_t::const_iterator i = m_data.find(blk_idx);
-   if( i == m_data.end() ) {
-      for( size_t n=0; n < length; n++ ) 
-         ((unsigned char*)data)[n] = (unsigned char) 0;
-      //printf("GPGPU-Sim PTX:  WARNING reading %zu bytes from unititialized memory at address 0x%x in space %s\n", length, addr, m_name.c_str() );
-   } else {
-      unsigned offset = addr & (BSIZE-1);
-      unsigned nbytes = length;
-      i->second.read(offset,nbytes,(unsigned char*)data);
+   size_t nbytes_remain = length;
+   unsigned char *dst = (unsigned char*)data;
+   mem_addr_t current_addr = addr; 
+   while (nbytes_remain > 0) {
+      size_t tx_bytes;
+      const unsigned char *src = find_run(current_addr, nbytes_remain, false, tx_bytes);
+      if( src == NULL ) {
+         memset(dst, 0, tx_bytes);
+         //printf("GPGPU-Sim PTX:  WARNING reading %zu bytes from unititialized memory at address 0x%x in space %s\n", length, addr, m_name.c_str() );
+      } else {
+         memcpy(dst, src, tx_bytes);
+      }
+
+      // advance pointers 
+      dst += tx_bytes; 
+      current_addr += tx_bytes; 
+      nbytes_remain -= tx_bytes; 
    }
 }
 
-template<unsigned BSIZE> void memory_space_impl<BSIZE>::read( mem_addr_t addr, size_t length, void *data, ptx_thread_info *thd, const ptx_instruction *pI ) const
+template<unsigned BSIZE> void memory_space_impl<BSIZE>::print_page( mem_addr_t index, const unsigned char *page, const char *format, FILE *fout ) const
 {
-   mem_addr_t index = addr >> m_log2_block_size;
-   if ((addr+length) <= (index+1)*BSIZE ) {
-      // fast route for intra-block access 
-      read_single_block(index, addr, length, data); 
-   } else {
-      // slow route for inter-block access 
-      unsigned nbytes_remain = length;
-      unsigned dst_offset = 0; 
-      mem_addr_t current_addr = addr; 
-
-      while (nbytes_remain > 0) {
-         unsigned offset = current_addr & (BSIZE-1);
-         mem_addr_t page = current_addr >> m_log2_block_size; 
-         mem_addr_t access_limit = offset + nbytes_remain; 
-         if (access_limit > BSIZE) {
-            access_limit = BSIZE;
-         } 
-         
-         size_t tx_bytes = access_limit - offset; 
-         read_single_block(page, current_addr, tx_bytes, &((unsigned char*)data)[dst_offset]); 
-
-         // advance pointers 
-         dst_offset += tx_bytes; 
-         current_addr += tx_bytes; 
-         nbytes_remain -= tx_bytes; 
+   fprintf(fout, "%s - %#llx:", m_name.c_str(), index);
+   const unsigned int *i_data = (const unsigned int*)page;
+   for (int d = 0; d < (BSIZE / sizeof(unsigned int)); d++) {
+      if (d % 8 == 0) {
+         fprintf(fout, "\n");
       }
-      assert(nbytes_remain == 0); 
+      fprintf(fout, format, i_data[d]);
+      fprintf(fout, " ");
    }
+   fprintf(fout, "\n");
+   fflush(fout);
 }
 
 template<unsigned BSIZE> void memory_space_impl<BSIZE>::print( const char *format, FILE *fout ) const
 {
-   typename map_t::const_iterator i_page;
-   for (i_page = m_data.begin(); i_page != m_data.end(); ++i_page) {
-      fprintf(fout, "%s - %#x:", m_name.c_str(), i_page->first);
-      i_page->second.print(format, fout);
+   std::lock_guard<std::mutex> lock(m_page_lock);
+   typename map_t::const_iterator i_dir;
+   for (i_dir = m_data.begin(); i_dir != m_data.end(); ++i_dir) {
+      for( unsigned l=0; l < radix_size; l++ ) {
+         const leaf_t *leaf = i_dir->second->m_leaf[l].load(std::memory_order_acquire);
+         if( leaf == NULL ) 
+            continue;
+         for( unsigned p=0; p < radix_size; p++ ) {
+            const unsigned char *page = leaf->m_page[p].load(std::memory_order_acquire);
+            if( page != NULL ) 
+               print_page((((i_dir->first << radix_bits) | l) << radix_bits) | p, page, format, fout);
+         }
+      }
    }
 }
 
@@ -165,13 +298,18 @@ void g_print_memory_space(memory_space *mem, const char *format = "%08x", FILE *
     mem->print(format,fout);
 }
 
+// gem5 functional accesses through the thread context are not reentrant
+static std::mutex g_gem5_mem_lock;
+
 void gem5memorySpace::write(mem_addr_t addr, size_t length, const void *data, ptx_thread_info *thd, const ptx_instruction *pI) {
+    std::lock_guard<std::mutex> lock(g_gem5_mem_lock);
     ThreadContext* tc = thd->get_kernel_info()->get_ThreadContext();
     GPUSyscallHelper helper(tc, NULL);
     helper.writeBlob((Addr) addr, (uint8_t*) data, length);
 }
 
 void gem5memorySpace::read(mem_addr_t addr, size_t length, void *data, ptx_thread_info *thd, const ptx_instruction *pI) const {
+    std::lock_guard<std::mutex> lock(g_gem5_mem_lock);
     ThreadContext* tc = thd->get_kernel_info()->get_ThreadContext();
     GPUSyscallHelper helper(tc, NULL);
     helper.readBlob((Addr) addr, (uint8_t*) data, length);
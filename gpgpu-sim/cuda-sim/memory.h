@@ -43,59 +43,14 @@
 #include <stdio.h>
 #include <string>
 #include <map>
+#include <atomic>
+#include <mutex>
 #include <stdlib.h>
 
 typedef address_type mem_addr_t;
 
 #define MEM_BLOCK_SIZE (4*1024)
 
-template<unsigned BSIZE> class mem_storage {
-public:
-   mem_storage( const mem_storage &another )
-   {
-      m_data = (unsigned char*)calloc(1,BSIZE);
-      memcpy(m_data,another.m_data,BSIZE);
-   }
-   mem_storage()
-   {
-      m_data = (unsigned char*)calloc(1,BSIZE);
-   }
-   ~mem_storage()
-   {
-      free(m_data);
-   }
-
-   void write( unsigned offset, size_t length, const unsigned char *data )
-   {
-      assert( offset + length <= BSIZE );
-      memcpy(m_data+offset,data,length);
-   }
-
-   void read( unsigned offset, size_t length, unsigned char *data ) const
-   {
-      assert( offset + length <= BSIZE );
-      memcpy(data,m_data+offset,length);
-   }
-
-   void print( const char *format, FILE *fout ) const
-   {
-      unsigned int *i_data = (unsigned int*)m_data;
-      for (int d = 0; d < (BSIZE / sizeof(unsigned int)); d++) {
-         if (d % 8 == 0) {
-            fprintf(fout, "\n");
-         }
-         fprintf(fout, format, i_data[d]);
-         fprintf(fout, " ");
-      }
-      fprintf(fout, "\n");
-      fflush(fout);
-   }
-
-private:
-   unsigned m_nbytes;
-   unsigned char *m_data;
-};
-
 class ptx_thread_info;
 class ptx_instruction;
 
@@ -109,9 +64,47 @@ public:
    virtual void set_watch( addr_t addr, unsigned watchpoint ) = 0;
 };
 
+// pages of a memory space are found through two radix levels below a hash
+// map keyed by the remaining high bits. A level is about a page worth of
+// pointers, between MEM_RADIX_MIN_BITS and MEM_RADIX_MAX_BITS of index, so
+// a space of 32 byte pages does not pay for 1024 entry tables
+#define MEM_RADIX_MIN_BITS 4
+#define MEM_RADIX_MAX_BITS 10
+
+// a leaf whose pages add up to at least this many bytes reserves one sparse
+// anonymous mapping for them, the host only backs the pages that get written.
+// Only spaces whose expected size (hash_size pages) reaches it use them
+#define MEM_SPARSE_LEAF_SIZE (4*1024*1024)
+
+// entries of the per host thread page cache, indexed by memory space uid so
+// that the local spaces of the lanes of a warp do not evict each other
+#define MEM_PAGE_CACHE_SIZE 64
+
+// most recently used page and directory of a memory space on a host thread,
+// both live as long as their memory space and uids are never reused, so
+// entries with a matching uid are valid
+struct mem_page_cache_t {
+   unsigned m_space_uid;
+   mem_addr_t m_index;
+   unsigned char *m_page;
+   void *m_leaf;
+   mem_addr_t m_dir_index;
+   void *m_dir;
+};
+
+constexpr unsigned mem_log2( unsigned n ) { return (n <= 1)? 0 : 1 + mem_log2(n >> 1); }
+
+constexpr unsigned mem_radix_bits( unsigned bsize ) 
+{
+   return (mem_log2(bsize/sizeof(void*)) < MEM_RADIX_MIN_BITS)? MEM_RADIX_MIN_BITS :
+          (mem_log2(bsize/sizeof(void*)) > MEM_RADIX_MAX_BITS)? MEM_RADIX_MAX_BITS :
+          mem_log2(bsize/sizeof(void*));
+}
+
 template<unsigned BSIZE> class memory_space_impl : public memory_space {
 public:
    memory_space_impl( std::string name, unsigned hash_size );
+   virtual ~memory_space_impl();
 
    virtual void write( mem_addr_t addr, size_t length, const void *data, ptx_thread_info *thd, const ptx_instruction *pI );
    virtual void read( mem_addr_t addr, size_t length, void *data, ptx_thread_info *thd = NULL, const ptx_instruction *pI = NULL ) const;
@@ -119,12 +112,37 @@ public:
    virtual void set_watch( addr_t addr, unsigned watchpoint ); 
 
 private:
-   void read_single_block( mem_addr_t blk_idx, mem_addr_t addr, size_t length, void *data) const; 
+   static const unsigned radix_bits = mem_radix_bits(BSIZE);
+   static const unsigned radix_size = 1 << radix_bits;
+   struct leaf_t {
+      unsigned char *m_region; // sparse mapping holding every page of the leaf, or NULL
+      std::atomic<unsigned char*> m_page[radix_size];
+   };
+   struct dir_t {
+      std::atomic<leaf_t*> m_leaf[radix_size];
+   };
+
+   // host copy of the byte at addr and in run the number of bytes from there,
+   // up to length, that are contiguous on the host: the rest of the page or of
+   // a sparse leaf. NULL if nothing around addr was written yet, unless alloc
+   unsigned char *find_run( mem_addr_t addr, size_t length, bool alloc, size_t &run ) const;
+   unsigned char *find_page( mem_addr_t index, bool alloc, leaf_t *&leaf ) const;
+   dir_t *find_dir( mem_addr_t index, bool alloc ) const;
+   leaf_t *new_leaf() const;
+   void print_page( mem_addr_t index, const unsigned char *page, const char *format, FILE *fout ) const;
+
    std::string m_name;
    unsigned m_log2_block_size;
-   typedef mem_map<mem_addr_t,mem_storage<BSIZE> > map_t;
-   map_t m_data;
+   unsigned m_uid;
+   bool m_sparse_leaves;
+   typedef mem_map<mem_addr_t,dir_t*> map_t;
+   mutable map_t m_data;
+   // guards m_data and allocation so that functional simulation workers can
+   // share a memory space, lookups within a cached directory are lock free
+   mutable std::mutex m_page_lock;
    std::map<unsigned,mem_addr_t> m_watchpoints;
+
+   static thread_local mem_page_cache_t sm_last_page[MEM_PAGE_CACHE_SIZE];
 };
 
 
@@ -147,9 +147,9 @@ void ptx_file_line_stats_write_file()
 
 // attribute one more execution count to this ptx instruction
 // counting the number of threads (not warps) executing this instruction
-void ptx_file_line_stats_add_exec_count(const ptx_instruction *pInsn)
+void ptx_file_line_stats_add_exec_count(const ptx_instruction *pInsn, unsigned count)
 {
-    ptx_file_line_stats_tracker[ptx_file_line(pInsn->source_file(), pInsn->source_line())].exec_count += 1;
+    ptx_file_line_stats_tracker[ptx_file_line(pInsn->source_file(), pInsn->source_line())].exec_count += count;
 }
 
 // attribute pipeline latency to this ptx instruction (specified by the pc)
@@ -40,7 +40,7 @@ void ptx_file_line_stats_write_file();
 #ifdef __cplusplus
 // stat collection interface to cuda-sim
 class ptx_instruction;
-void ptx_file_line_stats_add_exec_count(const ptx_instruction *pInsn);
+void ptx_file_line_stats_add_exec_count(const ptx_instruction *pInsn, unsigned count = 1);
 #endif
 
 // stat collection interface to gpgpu-sim
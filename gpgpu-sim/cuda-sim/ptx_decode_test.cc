@@ -0,0 +1,120 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Measures the per-lane decode work that ptx_instruction::lower() moved to
+// load time: building the predicate operand from its symbol on every
+// get_pred() call, and comparing register names against "_" on every
+// register write.  Checks that the cached values match what the per-lane
+// code computed.
+// Usage: ptx_decode_test [calls to time]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "ptx_ir.h"
+#include "ptx.tab.h"
+
+static unsigned g_errors = 0;
+
+//what execution did per lane before lowering
+static operand_info build_pred( const symbol *pred )
+{
+   return operand_info(pred);
+}
+
+static bool named_null_reg( const symbol *reg )
+{
+   return reg->name() == "_";
+}
+
+int main( int argc, char *argv[] )
+{
+   unsigned calls = (argc > 1)? atoi(argv[1]) : 1000000;
+
+   type_info pred_type(NULL, type_info_key(reg_space,PRED_TYPE,0,0,0,0));
+   type_info u32_type(NULL, type_info_key(reg_space,U32_TYPE,0,0,0,0));
+   std::vector<const symbol*> regs;
+   regs.push_back(new symbol("%p1",&pred_type,"test.ptx:1",1));
+   regs.push_back(new symbol("_",&u32_type,"test.ptx:2",4));
+   regs.push_back(new symbol("%r12",&u32_type,"test.ptx:3",4));
+   regs.push_back(new symbol("%rd_long_register_name",&u32_type,"test.ptx:4",4));
+
+   std::vector<operand_info> cached;
+   for( unsigned r=0; r < regs.size(); r++ ) {
+      cached.push_back(operand_info(regs[r]));
+      operand_info built = build_pred(regs[r]);
+      if( built.get_symbol() != cached[r].get_symbol() || built.is_reg() != cached[r].is_reg() ) {
+         printf("ERROR ** cached predicate operand differs for %s\n", regs[r]->name().c_str());
+         g_errors++;
+      }
+      if( regs[r]->is_null_reg() != named_null_reg(regs[r]) ) {
+         printf("ERROR ** is_null_reg differs for %s\n", regs[r]->name().c_str());
+         g_errors++;
+      }
+   }
+
+   //sums keep the compiler from dropping the timed loops
+   unsigned long long sum = 0;
+   std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+   for( unsigned i=0; i < calls; i++ ) {
+      operand_info p = build_pred(regs[i % regs.size()]);
+      sum += p.is_reg() + (p.get_symbol() != NULL);
+   }
+   std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+   for( unsigned i=0; i < calls; i++ ) {
+      const operand_info &p = cached[i % regs.size()];
+      sum += p.is_reg() + (p.get_symbol() != NULL);
+   }
+   std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+   for( unsigned i=0; i < calls; i++ ) 
+      sum += named_null_reg(regs[i % regs.size()]);
+   std::chrono::steady_clock::time_point t3 = std::chrono::steady_clock::now();
+   for( unsigned i=0; i < calls; i++ ) 
+      sum += regs[i % regs.size()]->is_null_reg();
+   std::chrono::steady_clock::time_point t4 = std::chrono::steady_clock::now();
+
+   printf("predicate operand: built %.2f ns, cached %.2f ns per lane\n",
+          std::chrono::duration<double>(t1-t0).count() * 1e9 / calls,
+          std::chrono::duration<double>(t2-t1).count() * 1e9 / calls);
+   printf("null register check: name compare %.2f ns, flag %.2f ns per write\n",
+          std::chrono::duration<double>(t3-t2).count() * 1e9 / calls,
+          std::chrono::duration<double>(t4-t3).count() * 1e9 / calls);
+   printf("(checksum %llu)\n", sum);
+
+   for( unsigned r=0; r < regs.size(); r++ ) 
+      delete regs[r];
+
+   if( g_errors ) {
+      printf("SUMMARY:  ERRORS FOUND\n");
+   } else {
+      printf("SUMMARY: UNIT TEST PASSED\n");
+   }
+   return g_errors != 0;
+}
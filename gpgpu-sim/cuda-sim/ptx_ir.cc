@@ -153,6 +153,10 @@ symbol *symbol_table::add_variable( const char *identifier, const type_info *typ
    if ( type != NULL && type->get_key().is_const()  ) {
       m_consts.push_back(s);
    }
+   if ( type != NULL && type->get_key().is_reg()  ) {
+      s->set_reg_slot(this,m_reg_slots.size());
+      m_reg_slots.push_back(s);
+   }
 
    return s;
 }
@@ -535,37 +539,55 @@ bool function_info::connect_break_targets() //connecting break instructions with
 
    return modified; 
 }
-void intersect( std::set<int> &A, const std::set<int> &B )
+// Fills tmp[n] with the immediate (post)dominator of every block n, given
+// the (post)dominator sets dom, using the algorithm of Muchnick's Adv.
+// Compiler Design & Implemmntation Fig 7.15.  When the sets of n and its
+// strict dominators form a chain, the result is the strict dominator d with
+// dom(d) == dom(n) - {n}, which is found directly; blocks are visited by
+// increasing set size so d is known to be part of a chain before n is.  The
+// set elimination of Fig 7.15 only runs for the remaining blocks (e.g.,
+// blocks that are not reachable from the entry).
+static void find_immediate( const std::vector<bb_set> &dom, std::vector<bb_set> &tmp )
 {
-   // return intersection of A and B in A
-   for( std::set<int>::iterator a=A.begin(); a!=A.end(); ) {    
-      std::set<int>::iterator a_next = a;
-      a_next++;
-      if( B.find(*a) == B.end() ) {
-         A.erase(*a);
-         a = a_next;
-      } else 
-         a++;
+   unsigned n_bb = dom.size();
+   std::vector<unsigned> size(n_bb);
+   std::vector<std::pair<unsigned,unsigned> > order(n_bb);
+   for (unsigned i=0; i<n_bb; i++) {
+      size[i] = dom[i].count();
+      order[i] = std::make_pair(size[i], i);
    }
-}
-
-bool is_equal( const std::set<int> &A, const std::set<int> &B )
-{
-   if( A.size() != B.size() ) 
-      return false;
-   for( std::set<int>::iterator b=B.begin(); b!=B.end(); b++ ) 
-      if( A.find(*b) == A.end() ) 
-         return false;
-   return true;
-}
-
-void print_set(const std::set<int> &A)
-{
-   std::set<int>::iterator a;
-   for (a= A.begin(); a != A.end(); a++) {
-      printf("%d ", (*a));
+   std::sort(order.begin(), order.end());
+   std::vector<bool> chain(n_bb, false);
+   for (unsigned k=0; k<n_bb; k++) {
+      unsigned n = order[k].second;
+      tmp[n] = dom[n];
+      tmp[n].reset(n);
+      if (dom[n].test(n)) {
+         if (size[n] == 1) {
+            chain[n] = true;
+            continue;
+         }
+         int d = -1;
+         unsigned d_size = 0;
+         for (int s = tmp[n].next(0); s != -1; s = tmp[n].next(s+1)) {
+            if (size[s] > d_size) {
+               d = s;
+               d_size = size[s];
+            }
+         }
+         if (chain[d] && d_size == size[n]-1 && dom[d].subset_of(tmp[n])) {
+            tmp[n].clear();
+            tmp[n].set(d);
+            chain[n] = true;
+            continue;
+         }
+      }
+      // remove every t in Tmp(n) that dominates another s in Tmp(n)
+      for (int s = tmp[n].next(0); s != -1; s = tmp[n].next(s+1)) {
+         tmp[n].subtract(dom[s]);
+         tmp[n].set(s);
+      }
    }
-   printf("\n");
 }
 
 void function_info::find_dominators( )
@@ -574,25 +596,24 @@ void function_info::find_dominators( )
    printf("GPGPU-Sim PTX: Finding dominators for \'%s\'...\n", m_name.c_str() );
    fflush(stdout);
    assert( m_basic_blocks.size() >= 2 ); // must have a distinquished entry block
+   unsigned n_bb = m_basic_blocks.size();
    std::vector<basic_block_t*>::iterator bb_itr = m_basic_blocks.begin();
-   (*bb_itr)->dominator_ids.insert((*bb_itr)->bb_id);  // the only dominator of the entry block is the entry
+   (*bb_itr)->dominator_ids.assign(n_bb, false);
+   (*bb_itr)->dominator_ids.set((*bb_itr)->bb_id);  // the only dominator of the entry block is the entry
    //copy all basic blocks to all dominator lists EXCEPT for the entry block
-   for (++bb_itr;bb_itr != m_basic_blocks.end(); bb_itr++) { 
-      for (unsigned i = 0; i < m_basic_blocks.size(); i++) 
-         (*bb_itr)->dominator_ids.insert(i);
-   }
+   for (++bb_itr;bb_itr != m_basic_blocks.end(); bb_itr++) 
+      (*bb_itr)->dominator_ids.assign(n_bb, true);
    bool change = true;
+   bb_set T;
    while (change) {
       change = false;
-      for ( int h = 1/*skip entry*/; h < m_basic_blocks.size(); ++h ) {
-         assert( m_basic_blocks[h]->bb_id == (unsigned)h );
-         std::set<int> T;
-         for (unsigned i=0;i< m_basic_blocks.size();i++) 
-            T.insert(i);
+      for ( unsigned h = 1/*skip entry*/; h < n_bb; ++h ) {
+         assert( m_basic_blocks[h]->bb_id == h );
+         T.assign(n_bb, true);
          for ( std::set<int>::iterator s = m_basic_blocks[h]->predecessor_ids.begin();s != m_basic_blocks[h]->predecessor_ids.end();s++) 
-            intersect(T, m_basic_blocks[*s]->dominator_ids);
-         T.insert(h);
-         if (!is_equal(T, m_basic_blocks[h]->dominator_ids)) {
+            T.intersect(m_basic_blocks[*s]->dominator_ids);
+         T.set(h);
+         if (T != m_basic_blocks[h]->dominator_ids) {
             change = true;
             m_basic_blocks[h]->dominator_ids = T;
          }
@@ -612,24 +633,23 @@ void function_info::find_postdominators( )
    printf("GPGPU-Sim PTX: Finding postdominators for \'%s\'...\n", m_name.c_str() );
    fflush(stdout);
    assert( m_basic_blocks.size() >= 2 ); // must have a distinquished exit block
+   unsigned n_bb = m_basic_blocks.size();
    std::vector<basic_block_t*>::reverse_iterator bb_itr = m_basic_blocks.rbegin();
-   (*bb_itr)->postdominator_ids.insert((*bb_itr)->bb_id);  // the only postdominator of the exit block is the exit
-   for (++bb_itr;bb_itr != m_basic_blocks.rend();bb_itr++) { //copy all basic blocks to all postdominator lists EXCEPT for the exit block
-      for (unsigned i=0; i<m_basic_blocks.size(); i++) 
-         (*bb_itr)->postdominator_ids.insert(i);
-   }
+   (*bb_itr)->postdominator_ids.assign(n_bb, false);
+   (*bb_itr)->postdominator_ids.set((*bb_itr)->bb_id);  // the only postdominator of the exit block is the exit
+   for (++bb_itr;bb_itr != m_basic_blocks.rend();bb_itr++) //copy all basic blocks to all postdominator lists EXCEPT for the exit block
+      (*bb_itr)->postdominator_ids.assign(n_bb, true);
    bool change = true;
+   bb_set T;
    while (change) {
       change = false;
-      for ( int h = m_basic_blocks.size()-2/*skip exit*/; h >= 0 ; --h ) {
+      for ( int h = n_bb-2/*skip exit*/; h >= 0 ; --h ) {
          assert( m_basic_blocks[h]->bb_id == (unsigned)h );
-         std::set<int> T;
-         for (unsigned i=0;i< m_basic_blocks.size();i++) 
-            T.insert(i);
+         T.assign(n_bb, true);
          for ( std::set<int>::iterator s = m_basic_blocks[h]->successor_ids.begin();s != m_basic_blocks[h]->successor_ids.end();s++) 
-            intersect(T, m_basic_blocks[*s]->postdominator_ids);
-         T.insert(h);
-         if (!is_equal(T,m_basic_blocks[h]->postdominator_ids)) {
+            T.intersect(m_basic_blocks[*s]->postdominator_ids);
+         T.set(h);
+         if (T != m_basic_blocks[h]->postdominator_ids) {
             change = true;
             m_basic_blocks[h]->postdominator_ids = T;
          }
@@ -644,35 +664,21 @@ void function_info::find_ipostdominators( )
    printf("GPGPU-Sim PTX: Finding immediate postdominators for \'%s\'...\n", m_name.c_str() );
    fflush(stdout);
    assert( m_basic_blocks.size() >= 2 ); // must have a distinquished exit block
-   for (unsigned i=0; i<m_basic_blocks.size(); i++) { //initialize Tmp(n) to all pdoms of n except for n
-      m_basic_blocks[i]->Tmp_ids = m_basic_blocks[i]->postdominator_ids;
+   unsigned n_bb = m_basic_blocks.size();
+   std::vector<bb_set> pdom(n_bb), tmp(n_bb);
+   for (unsigned i=0; i<n_bb; i++) {
       assert( m_basic_blocks[i]->bb_id == i );
-      m_basic_blocks[i]->Tmp_ids.erase(i);
-   }
-   for ( int n = m_basic_blocks.size()-2; n >=0;--n) {
-      // point iterator to basic block before the exit
-      for( std::set<int>::iterator s=m_basic_blocks[n]->Tmp_ids.begin(); s != m_basic_blocks[n]->Tmp_ids.end(); s++ ) {
-         int bb_s = *s;
-         for( std::set<int>::iterator t=m_basic_blocks[n]->Tmp_ids.begin(); t != m_basic_blocks[n]->Tmp_ids.end(); ) {
-            std::set<int>::iterator t_next = t; t_next++; // might erase thing pointed to be t, invalidating iterator t
-            if( *s == *t ) {
-               t = t_next;
-               continue;
-            }
-            int bb_t = *t;
-            if( m_basic_blocks[bb_s]->postdominator_ids.find(bb_t) != m_basic_blocks[bb_s]->postdominator_ids.end() ) 
-                m_basic_blocks[n]->Tmp_ids.erase(bb_t);
-            t = t_next;
-         }
-      }
+      pdom[i] = m_basic_blocks[i]->postdominator_ids;
    }
+   find_immediate(pdom, tmp);
    unsigned num_ipdoms=0;
-   for ( int n = m_basic_blocks.size()-1; n >=0;--n) {
-      assert( m_basic_blocks[n]->Tmp_ids.size() <= 1 ); 
+   for ( int n = n_bb-1; n >=0;--n) {
+      m_basic_blocks[n]->Tmp_ids = tmp[n];
+      assert( tmp[n].count() <= 1 ); 
          // if the above assert fails we have an error in either postdominator 
          // computation, the flow graph does not have a unique exit, or some other error
-      if( !m_basic_blocks[n]->Tmp_ids.empty() ) {
-         m_basic_blocks[n]->immediatepostdominator_id = *m_basic_blocks[n]->Tmp_ids.begin();
+      if( !tmp[n].empty() ) {
+         m_basic_blocks[n]->immediatepostdominator_id = tmp[n].next(0);
          num_ipdoms++;
       }
    }
@@ -687,36 +693,22 @@ void function_info::find_idominators( )
    printf("GPGPU-Sim PTX: Finding immediate dominators for \'%s\'...\n", m_name.c_str() );
    fflush(stdout);
    assert( m_basic_blocks.size() >= 2 ); // must have a distinquished entry block
-   for (unsigned i=0; i<m_basic_blocks.size(); i++) { //initialize Tmp(n) to all doms of n except for n
-      m_basic_blocks[i]->Tmp_ids = m_basic_blocks[i]->dominator_ids;
+   unsigned n_bb = m_basic_blocks.size();
+   std::vector<bb_set> dom(n_bb), tmp(n_bb);
+   for (unsigned i=0; i<n_bb; i++) {
       assert( m_basic_blocks[i]->bb_id == i );
-      m_basic_blocks[i]->Tmp_ids.erase(i);
-   }
-   for ( int n = 0; n < m_basic_blocks.size(); ++n) {
-      // point iterator to basic block before the exit
-      for( std::set<int>::iterator s=m_basic_blocks[n]->Tmp_ids.begin(); s != m_basic_blocks[n]->Tmp_ids.end(); s++ ) {
-         int bb_s = *s;
-         for( std::set<int>::iterator t=m_basic_blocks[n]->Tmp_ids.begin(); t != m_basic_blocks[n]->Tmp_ids.end(); ) {
-            std::set<int>::iterator t_next = t; t_next++; // might erase thing pointed to be t, invalidating iterator t
-            if( *s == *t ) {
-               t = t_next;
-               continue;
-            }
-            int bb_t = *t;
-            if( m_basic_blocks[bb_s]->dominator_ids.find(bb_t) != m_basic_blocks[bb_s]->dominator_ids.end() ) 
-                m_basic_blocks[n]->Tmp_ids.erase(bb_t);
-            t = t_next;
-         }
-      }
+      dom[i] = m_basic_blocks[i]->dominator_ids;
    }
+   find_immediate(dom, tmp);
    unsigned num_idoms=0;
    unsigned num_nopred = 0;
-   for ( int n = 0; n < m_basic_blocks.size(); ++n) {
-      //assert( m_basic_blocks[n]->Tmp_ids.size() <= 1 );
+   for ( unsigned n = 0; n < n_bb; ++n) {
+      m_basic_blocks[n]->Tmp_ids = tmp[n];
+      //assert( tmp[n].count() <= 1 );
          // if the above assert fails we have an error in either dominator
          // computation, the flow graph does not have a unique entry, or some other error
-      if( !m_basic_blocks[n]->Tmp_ids.empty() ) {
-         m_basic_blocks[n]->immediatedominator_id = *m_basic_blocks[n]->Tmp_ids.begin();
+      if( !tmp[n].empty() ) {
+         m_basic_blocks[n]->immediatedominator_id = tmp[n].next(0);
          num_idoms++;
       } else if (m_basic_blocks[n]->predecessor_ids.empty()) {
     	  num_nopred += 1;
@@ -732,8 +724,8 @@ void function_info::print_dominators()
    std::vector<int>::iterator bb_itr;
    for (unsigned i = 0; i < m_basic_blocks.size(); i++) {
       printf("ID: %d\t:", i);
-      for( std::set<int>::iterator j=m_basic_blocks[i]->dominator_ids.begin(); j!=m_basic_blocks[i]->dominator_ids.end(); j++) 
-         printf(" %d", *j );
+      for( int j=m_basic_blocks[i]->dominator_ids.next(0); j != -1; j=m_basic_blocks[i]->dominator_ids.next(j+1) ) 
+         printf(" %d", j );
       printf("\n");
    }
 }
@@ -744,8 +736,8 @@ void function_info::print_postdominators()
    std::vector<int>::iterator bb_itr;
    for (unsigned i = 0; i < m_basic_blocks.size(); i++) {
       printf("ID: %d\t:", i);
-      for( std::set<int>::iterator j=m_basic_blocks[i]->postdominator_ids.begin(); j!=m_basic_blocks[i]->postdominator_ids.end(); j++) 
-         printf(" %d", *j );
+      for( int j=m_basic_blocks[i]->postdominator_ids.next(0); j != -1; j=m_basic_blocks[i]->postdominator_ids.next(j+1) ) 
+         printf(" %d", j );
       printf("\n");
    }
 }
@@ -1014,6 +1006,8 @@ ptx_instruction::ptx_instruction( int opcode,
    m_PC = 0;
    m_opcode = opcode;
    m_pred = pred;
+   m_uop.impl = NULL;
+   m_uop.classification = 0;
    m_neg_pred = neg_pred;
    m_pred_mod = pred_mod;
    m_label = label;
@@ -1262,17 +1256,31 @@ function_info::function_info(int entry_point )
    m_local_mem_framesize = 0;
 }
 
-unsigned function_info::print_insn( unsigned pc, FILE * fp ) const
+// demangled function names, so c++filt runs once per function rather than
+// once per printed instruction
+static const std::string &demangled_name( const std::string &name )
 {
-   unsigned inst_size=1; // return offset to next instruction or 1 if unknown
-   unsigned index = pc - m_start_PC;
+   static std::map<std::string,std::string> names;
+   std::map<std::string,std::string>::iterator n = names.find(name);
+   if ( n != names.end() )
+      return n->second;
    char command[1024];
    char buffer[1024];
-   snprintf(command,1024,"c++filt -p %s",m_name.c_str());
+   snprintf(command,1024,"c++filt -p %s",name.c_str());
    FILE *p = popen(command,"r");
    buffer[0]=0;
-   fscanf(p,"%1023s",buffer);
-   fprintf(fp,"%s",buffer);
+   if ( p ) {
+      fscanf(p,"%1023s",buffer);
+      pclose(p);
+   }
+   return names[name] = buffer;
+}
+
+unsigned function_info::print_insn( unsigned pc, FILE * fp ) const
+{
+   unsigned inst_size=1; // return offset to next instruction or 1 if unknown
+   unsigned index = pc - m_start_PC;
+   fprintf(fp,"%s",demangled_name(m_name).c_str());
    if ( index >= m_instr_mem_size ) {
       fprintf(fp, "<past last instruction (max pc=%u)>", m_start_PC + m_instr_mem_size - 1 );
    } else {
@@ -1282,7 +1290,6 @@ unsigned function_info::print_insn( unsigned pc, FILE * fp ) const
       } else
          fprintf(fp, "<no instruction at pc = %u>", pc );
    }
-   pclose(p);
    return inst_size;
 }
 
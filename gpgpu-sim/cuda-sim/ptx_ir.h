@@ -153,6 +153,7 @@ public:
    {
       m_uid = get_uid();
       m_name = name;
+      m_is_null_reg = (m_name == "_");
       m_decl_location = location;
       m_type = type;
       m_size = size;
@@ -167,6 +168,8 @@ public:
       m_is_func_addr = false;
       m_reg_num_valid = false;
       m_function = NULL;
+      m_reg_slot_owner = NULL;
+      m_reg_slot = 0;
       m_reg_num=(unsigned)-1;
       m_arch_reg_num=(unsigned)-1;
       m_address=(unsigned)-1;
@@ -228,6 +231,8 @@ public:
    bool is_param_local() const { return m_is_param_local; }
    bool is_tex() const { return m_is_tex;}
    bool is_func_addr() const { return m_is_func_addr; }
+   // the "_" register, writes to it are discarded
+   bool is_null_reg() const { return m_is_null_reg; }
    bool is_reg() const
    {
        if ( m_type == NULL ) {
@@ -264,6 +269,14 @@ public:
    }
    void print_info(FILE *fp) const;
    unsigned uid() const { return m_uid; }
+   // dense index of a register within the symbol table that declares it
+   void set_reg_slot( const symbol_table *owner, unsigned slot )
+   {
+      m_reg_slot_owner = owner;
+      m_reg_slot = slot;
+   }
+   const symbol_table *reg_slot_owner() const { return m_reg_slot_owner; }
+   unsigned reg_slot() const { return m_reg_slot; }
 
 private:
    unsigned get_uid();
@@ -285,9 +298,12 @@ private:
    bool m_is_param_local;
    bool m_is_tex;
    bool m_is_func_addr;
+   bool m_is_null_reg;
    unsigned m_reg_num; 
    unsigned m_arch_reg_num; 
    bool m_reg_num_valid; 
+   const symbol_table *m_reg_slot_owner;
+   unsigned m_reg_slot;
 
    std::list<operand_info> m_initializer;
    static unsigned sm_next_uid;
@@ -332,6 +348,10 @@ public:
    
    symbol_table * getParent(){return m_parent;}
 
+   // registers declared in this table, indexed by their slot
+   unsigned num_reg_slots() const { return m_reg_slots.size(); }
+   const symbol *reg_slot_symbol( unsigned slot ) const { return m_reg_slots[slot]; }
+
    void dump();
 private:
    unsigned m_reg_allocator;
@@ -348,6 +368,7 @@ private:
    std::map<type_info_key,type_info*,type_info_key_compare>  m_types;
    std::list<symbol*> m_globals;
    std::list<symbol*> m_consts;
+   std::vector<const symbol*> m_reg_slots;
    std::map<std::string,function_info*> m_function_info_lookup;
    std::map<std::string,symbol_table*> m_function_symtab_lookup;
 };
@@ -800,6 +821,71 @@ private:
 
 extern const char *g_opcode_string[];
 extern unsigned g_num_ptx_inst_uid;
+
+// dense set of basic block ids, one bit per block of the function
+class bb_set {
+public:
+   bb_set() : m_size(0) {}
+
+   // resize to n blocks, all present (fill) or absent
+   void assign( unsigned n, bool fill )
+   {
+      m_size = n;
+      m_words.assign((n+63)/64, fill? ~0ULL : 0ULL);
+      if( fill && (n % 64) )
+         m_words.back() = (1ULL << (n % 64)) - 1;
+   }
+   void clear() { m_words.assign(m_words.size(), 0ULL); }
+   void set( unsigned i ) { m_words[i/64] |= 1ULL << (i%64); }
+   void reset( unsigned i ) { m_words[i/64] &= ~(1ULL << (i%64)); }
+   bool test( unsigned i ) const { return (m_words[i/64] >> (i%64)) & 1; }
+   bool empty() const
+   {
+      for( unsigned w=0; w < m_words.size(); w++ )
+         if( m_words[w] ) return false;
+      return true;
+   }
+   unsigned count() const
+   {
+      unsigned n = 0;
+      for( unsigned w=0; w < m_words.size(); w++ )
+         n += __builtin_popcountll(m_words[w]);
+      return n;
+   }
+   // lowest id >= i in the set, or -1
+   int next( unsigned i ) const
+   {
+      if( i >= m_size ) return -1;
+      unsigned w = i/64;
+      unsigned long long bits = m_words[w] & (~0ULL << (i%64));
+      while( !bits ) {
+         if( ++w == m_words.size() ) return -1;
+         bits = m_words[w];
+      }
+      return w*64 + __builtin_ctzll(bits);
+   }
+   void intersect( const bb_set &B )
+   {
+      for( unsigned w=0; w < m_words.size(); w++ ) m_words[w] &= B.m_words[w];
+   }
+   void subtract( const bb_set &B )
+   {
+      for( unsigned w=0; w < m_words.size(); w++ ) m_words[w] &= ~B.m_words[w];
+   }
+   bool subset_of( const bb_set &B ) const
+   {
+      for( unsigned w=0; w < m_words.size(); w++ )
+         if( m_words[w] & ~B.m_words[w] ) return false;
+      return true;
+   }
+   bool operator==( const bb_set &B ) const { return m_words == B.m_words; }
+   bool operator!=( const bb_set &B ) const { return m_words != B.m_words; }
+
+private:
+   unsigned m_size;
+   std::vector<unsigned long long> m_words;
+};
+
 struct basic_block_t {
    basic_block_t( unsigned ID, ptx_instruction *begin, ptx_instruction *end, bool entry, bool ex)
    {
@@ -816,9 +902,9 @@ struct basic_block_t {
    ptx_instruction* ptx_end;
    std::set<int> predecessor_ids; //indices of other basic blocks in m_basic_blocks array
    std::set<int> successor_ids;
-   std::set<int> postdominator_ids;
-   std::set<int> dominator_ids;
-   std::set<int> Tmp_ids;
+   bb_set postdominator_ids;
+   bb_set dominator_ids;
+   bb_set Tmp_ids;
    int immediatepostdominator_id;
    int immediatedominator_id;
    bool is_entry;
@@ -827,12 +913,12 @@ struct basic_block_t {
 
    // if this basic block dom B
    bool dom(const basic_block_t *B) {
-      return (B->dominator_ids.find(this->bb_id) != B->dominator_ids.end());
+      return B->dominator_ids.test(this->bb_id);
    }
 
    // if this basic block pdom B
    bool pdom(const basic_block_t *B) {
-      return (B->postdominator_ids.find(this->bb_id) != B->postdominator_ids.end());
+      return B->postdominator_ids.test(this->bb_id);
    }
 };
 
@@ -843,6 +929,9 @@ struct gpgpu_recon_t {
    class ptx_instruction* target_inst;
 };
 
+class ptx_thread_info;
+typedef void (*ptx_inst_impl_t)( const class ptx_instruction *, ptx_thread_info * );
+
 class ptx_instruction : public warp_inst_t {
 public:
     ptx_instruction( int opcode, 
@@ -878,7 +967,7 @@ public:
    unsigned source_line() const { return m_source_line;}
    unsigned get_num_operands() const { return m_operands.size();}
    bool has_pred() const { return m_pred != NULL;}
-   operand_info get_pred() const { return operand_info( m_pred );}
+   const operand_info &get_pred() const { return m_uop.pred;}
    bool get_pred_neg() const { return m_neg_pred;}
    int get_pred_mod() const { return m_pred_mod;}
    const char *get_source() const { return m_source.c_str();}
@@ -947,6 +1036,10 @@ public:
    }
 
    memory_space_t get_space() const { return m_space_spec;}
+   // .param space resolved to kernel or local parameters by pre_decode()
+   memory_space_t get_resolved_space() const { return m_uop.space;}
+   ptx_inst_impl_t get_impl() const { return m_uop.impl;}
+   int get_classification() const { return m_uop.classification;}
    void set_z(){m_space_spec.set_z(); }
    bool is_z() const{return m_space_spec.is_z(); }
    void set_blend(){m_space_spec.set_blend(); }
@@ -1079,7 +1172,17 @@ private:
    int m_instr_mem_index; //index into m_instr_mem array
    unsigned m_inst_size; // bytes
 
+   // lowered form of the instruction filled in by pre_decode(), execution 
+   // dispatches through it instead of the opcode switch and symbol lookups
+   struct {
+      ptx_inst_impl_t impl;
+      int classification;
+      operand_info pred;
+      memory_space_t space;
+   } m_uop;
+
    virtual void pre_decode();
+   void lower();
    friend class function_info;
    static unsigned g_num_ptx_inst_uid;
 };
@@ -1160,6 +1263,7 @@ public:
    //iterate across m_basic_blocks of function, 
    //finding dominator blocks, using algorithm of
    //Muchnick's Adv. Compiler Design & Implemmntation Fig 7.14 
+   //on bit vectors
    void find_dominators( );
    void print_dominators();
    void find_idominators();
@@ -1168,6 +1272,7 @@ public:
    //iterate across m_basic_blocks of function, 
    //finding postdominator blocks, using algorithm of
    //Muchnick's Adv. Compiler Design & Implemmntation Fig 7.14 
+   //on bit vectors
    void find_postdominators( );
    void print_postdominators();
 
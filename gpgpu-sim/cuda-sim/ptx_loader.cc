@@ -54,6 +54,7 @@ extern "C" int ptxinfo_debug;
 extern "C" FILE *ptxinfo_in;
 
 static bool g_save_embedded_ptx;
+static char *g_ptxinfo_cache_dir;
 bool g_keep_intermediate_files;
 bool m_ptx_save_converted_ptxplus;
 
@@ -71,6 +72,10 @@ void ptx_reg_options(option_parser_t opp)
                 &m_ptx_save_converted_ptxplus,
                 "Saved converted ptxplus to a file",
                 "0");
+   option_parser_register(opp, "-gpgpu_ptxinfo_cache_dir", OPT_CSTR, &g_ptxinfo_cache_dir,
+                "directory caching ptxas -v output keyed by a hash of the PTX, the ptxas flags "
+                "and the ptxas --version output (empty = off)",
+                "");
 }
 
 void print_ptx_file( const char *p, unsigned source_num, const char *filename )
@@ -184,9 +189,108 @@ symbol_table *gpgpu_ptx_sim_load_ptx_from_string( const char *ptx_code, unsigned
     return symtab;
 }
 
+// 64-bit FNV-1a
+static unsigned long long ptxinfo_hash( const char *s, unsigned long long h=14695981039346656037ULL )
+{
+   for( ; *s; s++ ) {
+      h ^= (unsigned char)*s;
+      h *= 1099511628211ULL;
+   }
+   return h;
+}
+
+static bool ptxinfo_cache_enabled()
+{
+   return g_ptxinfo_cache_dir && g_ptxinfo_cache_dir[0];
+}
+
+// Output of ptxas --version, read once per run so that cache entries of
+// another CUDA toolkit are not reused.  NULL if it could not be read, the
+// cache is then bypassed.
+static const char *ptxas_version()
+{
+   static bool checked = false;
+   static std::string version;
+   if (!checked) {
+      checked = true;
+      FILE *p = popen("ptxas --version 2>&1", "r");
+      if (p) {
+         char buf[256];
+         while (fgets(buf, sizeof(buf), p))
+            version += buf;
+         if (pclose(p) != 0)
+            version.clear();
+      }
+      if (version.empty())
+         printf("GPGPU-Sim PTX: WARNING ** could not run \"ptxas --version\", ptxinfo cache not used\n");
+   }
+   return version.empty()? NULL : version.c_str();
+}
+
+static void ptxinfo_parse_file( const char *filename )
+{
+   ptxinfo_in = fopen(filename, "r");
+   if (ptxinfo_in == NULL) {
+      printf("GPGPU-Sim PTX: ERROR ** could not open ptxinfo file \"%s\"\n", filename);
+      exit(1);
+   }
+   g_ptxinfo_filename = filename;
+   ptxinfo_parse();
+   fclose(ptxinfo_in);
+}
+
+// Copies the ptxas output into the cache.  The entry is written under a
+// temporary name and renamed so that concurrent runs sharing the directory
+// never see a partial file.
+static void ptxinfo_cache_store( const char *ptxinfo_file, const char *cache_file )
+{
+   char tmp[1024];
+   snprintf(tmp, 1024, "%s.XXXXXX", cache_file);
+   int fd = mkstemp(tmp);
+   if (fd < 0) {
+      printf("GPGPU-Sim PTX: WARNING ** could not create ptxinfo cache entry in \"%s\"\n", g_ptxinfo_cache_dir);
+      return;
+   }
+   FILE *out = fdopen(fd, "w");
+   FILE *in = fopen(ptxinfo_file, "r");
+   bool ok = in != NULL;
+   if (in) {
+      char buf[4096];
+      size_t n;
+      while ((n = fread(buf, 1, sizeof(buf), in)) > 0)
+         ok = ok && fwrite(buf, 1, n, out) == n;
+      fclose(in);
+   }
+   ok = (fclose(out) == 0) && ok;
+   if (!ok || rename(tmp, cache_file) != 0) {
+      printf("GPGPU-Sim PTX: WARNING ** could not store ptxinfo cache entry \"%s\"\n", cache_file);
+      unlink(tmp);
+   }
+}
+
 void gpgpu_ptxinfo_load_from_string(const char *p_for_info, unsigned source_num, const char* ptx_info_file)
 {
     if (ptx_info_file == NULL) {
+        char extra_flags[1024];
+        extra_flags[0] = 0;
+
+#if CUDART_VERSION >= 3000
+        snprintf(extra_flags, 1024, "--gpu-name=sm_20");
+#endif
+        // the ptxas version and flags are part of the key, the PTX rewrites
+        // below are fixed for a given simulator build
+        char cache_file[1024];
+        cache_file[0] = 0;
+        if (ptxinfo_cache_enabled() && ptxas_version()) {
+            unsigned long long key = ptxinfo_hash(p_for_info, ptxinfo_hash(extra_flags, ptxinfo_hash(ptxas_version())));
+            snprintf(cache_file, 1024, "%s/%016llx.ptxinfo", g_ptxinfo_cache_dir, key);
+            if (access(cache_file, R_OK) == 0) {
+                printf("GPGPU-Sim PTX: using cached ptxinfo \"%s\"\n", cache_file);
+                ptxinfo_parse_file(cache_file);
+                return;
+            }
+        }
+
         char fname[1024];
         snprintf(fname, 1024, "_ptx_XXXXXX");
         int fd = mkstemp(fname);
@@ -215,12 +319,6 @@ void gpgpu_ptxinfo_load_from_string(const char *p_for_info, unsigned source_num,
         char tempfile_ptxinfo[1024];
         snprintf(tempfile_ptxinfo, 1024, "%sinfo", fname);
         char commandline[1024];
-        char extra_flags[1024];
-        extra_flags[0] = 0;
-
-#if CUDART_VERSION >= 3000
-        snprintf(extra_flags, 1024, "--gpu-name=sm_20");
-#endif
         snprintf(commandline, 1024, "ptxas %s -v %s --output-file  /dev/null 2> %s",
                                       extra_flags, fname2, tempfile_ptxinfo);
         printf("GPGPU-Sim PTX: generating ptxinfo using \"%s\"\n", commandline);
@@ -230,12 +328,11 @@ void gpgpu_ptxinfo_load_from_string(const char *p_for_info, unsigned source_num,
             printf("               Ensure ptxas is in your path.\n");
             exit(1);
         }
-        ptxinfo_in = fopen(tempfile_ptxinfo, "r");
-        g_ptxinfo_filename = tempfile_ptxinfo;
-        ptxinfo_parse();
+        ptxinfo_parse_file(tempfile_ptxinfo);
+        if (cache_file[0])
+            ptxinfo_cache_store(tempfile_ptxinfo, cache_file);
         snprintf(commandline, 1024, "rm -f %s %s %s", fname, fname2, tempfile_ptxinfo);
         printf("GPGPU-Sim PTX: removing ptxinfo using \"%s\"\n", commandline);
-        fclose(ptxinfo_in);
         result = system(commandline);
         if (result != 0) {
             printf("GPGPU-Sim PTX: ERROR ** while loading PTX (c) %d\n", result);
@@ -245,10 +342,6 @@ void gpgpu_ptxinfo_load_from_string(const char *p_for_info, unsigned source_num,
         printf("GPGPU-Sim PTX: using the provided PTX info file \"%s\"\n", ptx_info_file);
         char tempfile_ptxinfo[1024];
         snprintf(tempfile_ptxinfo, 1024, "%s", ptx_info_file);
-        ptxinfo_in = fopen(tempfile_ptxinfo, "r");
-        g_ptxinfo_filename = tempfile_ptxinfo;
-        ptxinfo_parse();
-        fclose(ptxinfo_in);
+        ptxinfo_parse_file(tempfile_ptxinfo);
     }
 }
-
@@ -26,6 +26,7 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "ptx_sim.h"
+#include <atomic>
 #include <string>
 #include "ptx_ir.h"
 #include "ptx.tab.h"
@@ -129,7 +130,9 @@ unsigned ptx_cta_info::get_sm_idx() const
 }
 
 unsigned g_ptx_thread_info_uid_next=1;
-unsigned g_ptx_thread_info_delete_count=0;
+// threads of functional CTAs are deleted concurrently by the
+// -gpgpu_ptx_sim_threads workers
+std::atomic<unsigned> g_ptx_thread_info_delete_count(0);
 
 ptx_thread_info::~ptx_thread_info()
 {
@@ -161,7 +164,7 @@ ptx_thread_info::ptx_thread_info( kernel_info_t &kernel )
    m_hw_sid = -1;
    m_last_dram_callback.function = NULL;
    m_last_dram_callback.instruction = NULL;
-   m_regs.push_back( reg_map_t() );
+   m_regs.push_back( reg_frame_t() );
    m_debug_trace_regs_modified.push_back( reg_map_t() );
    m_debug_trace_regs_read.push_back( reg_map_t() );
    m_callstack.push_back( stack_entry() );
@@ -368,7 +371,7 @@ void ptx_thread_info::callstack_push( unsigned pc, unsigned rpc, const symbol *r
    m_last_was_call = true;
    assert( m_func_info != NULL );
    m_callstack.push_back( stack_entry(m_symbol_table,m_func_info,pc,rpc,return_var_src,return_var_dst,call_uid) );
-   m_regs.push_back( reg_map_t() );
+   m_regs.push_back( reg_frame_t() );
    m_debug_trace_regs_modified.push_back( reg_map_t() );
    m_debug_trace_regs_read.push_back( reg_map_t() );
    m_local_mem_stack_pointer += m_func_info->local_mem_framesize(); 
@@ -382,7 +385,7 @@ void ptx_thread_info::callstack_push_plus( unsigned pc, unsigned rpc, const symb
    m_last_was_call = true;
    assert( m_func_info != NULL );
    m_callstack.push_back( stack_entry(m_symbol_table,m_func_info,pc,rpc,return_var_src,return_var_dst,call_uid) );
-   //m_regs.push_back( reg_map_t() );
+   //m_regs.push_back( reg_frame_t() );
    //m_debug_trace_regs_modified.push_back( reg_map_t() );
    //m_debug_trace_regs_read.push_back( reg_map_t() );
    m_local_mem_stack_pointer += m_func_info->local_mem_framesize();
@@ -459,13 +462,13 @@ bool ptx_thread_info::callstack_pop_plus()
 void ptx_thread_info::dump_callstack() const
 {
    std::list<stack_entry>::const_iterator c=m_callstack.begin();
-   std::list<reg_map_t>::const_iterator r=m_regs.begin();
+   std::list<reg_frame_t>::const_iterator r=m_regs.begin();
 
    printf("\n\n");
    printf("Call stack for thread uid = %u (sc=%u, hwtid=%u)\n", m_uid, m_hw_sid, m_hw_tid );
    while( c != m_callstack.end() && r != m_regs.end() ) {
       const stack_entry &c_e = *c;
-      const reg_map_t &regs = *r;
+      const reg_frame_t &regs = *r;
       if( !c_e.m_valid ) {
          printf("  <entry>                              #regs = %zu\n", regs.size() );
       } else {
@@ -508,8 +511,15 @@ void ptx_thread_info::dump_regs( FILE *fp )
    if(m_regs.back().empty()) return;
    fprintf(fp,"Register File Contents:\n");
    fflush(fp);
+   const reg_frame_t &frame = m_regs.back();
+   for ( unsigned slot=0; slot < frame.num_slots(); slot++ ) {
+      if( !frame.slot_valid(slot) ) 
+         continue;
+      const symbol *sym = frame.owner()->reg_slot_symbol(slot);
+      print_reg(fp,sym->name(),frame.slot_value(slot),m_symbol_table);
+   }
    reg_map_t::const_iterator r;
-   for ( r=m_regs.back().begin(); r != m_regs.back().end(); ++r ) {
+   for ( r=frame.overflow().begin(); r != frame.overflow().end(); ++r ) {
       const symbol *sym = r->first;
       ptx_reg_t value = r->second;
       std::string name = sym->name();
@@ -169,6 +169,61 @@ private:
 
 class symbol;
 
+// Register values of one call frame. Registers declared in the symbol table
+// the frame is bound to (the one of the first register written, i.e., the
+// function that owns the frame) live in a flat array indexed by their slot.
+// Any other register, e.g., with ptxplus calls that share the caller frame,
+// falls back to a hash map.
+class reg_frame_t {
+public:
+   typedef tr1_hash_map<const symbol*,ptx_reg_t> reg_map_t;
+
+   reg_frame_t() : m_owner(NULL), m_count(0) {}
+
+   // NULL if the register was never written in this frame
+   ptx_reg_t *find( const symbol *reg, const symbol_table *owner, unsigned slot )
+   {
+      if( owner != NULL && owner == m_owner ) 
+         return (slot < m_valid.size() && m_valid[slot])? &m_values[slot] : NULL;
+      reg_map_t::iterator i = m_overflow.find(reg);
+      return (i == m_overflow.end())? NULL : &i->second;
+   }
+   // zero initialized on first use
+   ptx_reg_t &at( const symbol *reg, const symbol_table *owner, unsigned slot )
+   {
+      if( m_owner == NULL ) 
+         m_owner = owner;
+      if( owner != NULL && owner == m_owner ) {
+         if( slot >= m_values.size() ) {
+            m_values.resize(slot+1);
+            m_valid.resize(slot+1,0);
+         }
+         if( !m_valid[slot] ) {
+            m_valid[slot] = 1;
+            m_values[slot] = ptx_reg_t();
+            m_count++;
+         }
+         return m_values[slot];
+      }
+      return m_overflow[reg];
+   }
+   size_t size() const { return m_count + m_overflow.size(); }
+   bool empty() const { return size() == 0; }
+
+   const symbol_table *owner() const { return m_owner; }
+   bool slot_valid( unsigned slot ) const { return slot < m_valid.size() && m_valid[slot]; }
+   const ptx_reg_t &slot_value( unsigned slot ) const { return m_values[slot]; }
+   unsigned num_slots() const { return m_values.size(); }
+   const reg_map_t &overflow() const { return m_overflow; }
+
+private:
+   const symbol_table *m_owner;
+   std::vector<ptx_reg_t> m_values;
+   std::vector<unsigned char> m_valid;
+   unsigned m_count;
+   reg_map_t m_overflow;
+};
+
 struct stack_entry {
    stack_entry() {
       m_symbol_table=NULL;
@@ -271,6 +326,7 @@ public:
       m_hw_wid=wid;
       m_hw_tid=tid;
       m_functionalSimulationMode = fsim;
+      m_functionalMemoryAccess = fsim && !m_kernel.isGraphicsKernel();
    }
 
    void ptx_fetch_inst( inst_t &inst ) const;
@@ -279,11 +335,17 @@ public:
    void writeRegister(const warp_inst_t &inst, unsigned lane_id, char *data);
 
    void ptx_exec_inst( warp_inst_t &inst, unsigned lane_id );
+   // warp-wide path for plain ALU instructions: decoded once per warp by
+   // the first active lane, then executed per lane without the generic
+   // dispatch and bookkeeping of ptx_exec_inst
+   const ptx_instruction *decode_warp_alu( warp_inst_t &inst );
+   bool ptx_exec_alu_lane( const ptx_instruction *pI, warp_inst_t &inst, unsigned lane_id );
+   void record_warp_alu( const ptx_instruction *pI, unsigned lanes, unsigned executed );
 
    const ptx_version &get_ptx_version() const;
    void set_reg( const symbol *reg, const ptx_reg_t &value );
    ptx_reg_t get_reg( const symbol *reg );
-   ptx_reg_t get_operand_value( const operand_info &op, operand_info dstInfo, unsigned opType, ptx_thread_info *thread, int derefFlag );
+   ptx_reg_t get_operand_value( const operand_info &op, const operand_info &dstInfo, unsigned opType, ptx_thread_info *thread, int derefFlag );
    void set_operand_value( const operand_info &dst, const ptx_reg_t &data, unsigned type, ptx_thread_info *thread, const ptx_instruction *pI );
    void set_operand_value( const operand_info &dst, const ptx_reg_t &data, unsigned type, ptx_thread_info *thread, const ptx_instruction *pI, int overflow, int carry );
    void get_vector_operand_values( const operand_info &op, ptx_reg_t* ptx_regs, unsigned num_elements );
@@ -442,6 +504,9 @@ public:
    memory_space *get_param_memory() { return m_kernel.get_param_memory(); }
    const gpgpu_functional_sim_config &get_config() const { return m_gpu->get_config(); }
    bool isInFunctionalSimulationMode(){ return m_functionalSimulationMode;}
+   // global, const and local accesses are executed by the functional
+   // simulator rather than left to the timing model
+   bool accessesMemoryFunctionally() const { return m_functionalMemoryAccess;}
    void exitCore();
    void registerExit(){m_cta_info->register_thread_exit(this);}
    kernel_info_t* get_kernel_info() const{
@@ -482,6 +547,7 @@ public:
 private:
 
    bool m_functionalSimulationMode; 
+   bool m_functionalMemoryAccess;
    unsigned m_uid;
    kernel_info_t &m_kernel;
    core_t *m_core;
@@ -515,8 +581,8 @@ private:
    std::list<stack_entry> m_callstack;
    unsigned m_local_mem_stack_pointer;
 
-   typedef tr1_hash_map<const symbol*,ptx_reg_t> reg_map_t;
-   std::list<reg_map_t> m_regs;
+   typedef reg_frame_t::reg_map_t reg_map_t;
+   std::list<reg_frame_t> m_regs;
    std::list<reg_map_t> m_debug_trace_regs_modified;
    std::list<reg_map_t> m_debug_trace_regs_read;
    bool m_enable_debug_trace;
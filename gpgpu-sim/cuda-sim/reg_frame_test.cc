@@ -0,0 +1,194 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Checks reg_frame_t against the per-frame hash map it replaced, for registers
+// held in slots and for registers of other functions held in the overflow map,
+// and measures register reads and writes per second for both.
+// Usage: reg_frame_test [instructions per thread to time]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+#include "ptx_sim.h"
+
+typedef reg_frame_t::reg_map_t reg_map_t;
+
+static unsigned g_errors = 0;
+static unsigned g_seed = 2463534242u;
+
+static unsigned next_rand()
+{
+   g_seed ^= g_seed << 13;
+   g_seed ^= g_seed >> 17;
+   g_seed ^= g_seed << 5;
+   return g_seed;
+}
+
+//only the addresses of symbols and symbol tables are used as keys
+static char g_symbol_storage[4096*8];
+static char g_table_storage[4*8];
+
+static const symbol *fake_reg( unsigned i )
+{
+   return reinterpret_cast<const symbol*>(&g_symbol_storage[i*8]);
+}
+
+static const symbol_table *fake_table( unsigned i )
+{
+   return reinterpret_cast<const symbol_table*>(&g_table_storage[i*8]);
+}
+
+struct reg_ref_t {
+   const symbol *reg;
+   const symbol_table *owner;
+   unsigned slot;
+};
+
+//registers 0..n_own-1 belong to the frame's function, the rest to another
+//function or to no function at all, as param and return registers do
+static std::vector<reg_ref_t> make_regs( unsigned n_own, unsigned n_foreign )
+{
+   std::vector<reg_ref_t> regs;
+   for( unsigned i=0; i < n_own + n_foreign; i++ ) {
+      reg_ref_t r;
+      r.reg = fake_reg(i);
+      if( i < n_own ) {
+         r.owner = fake_table(0);
+         r.slot = i;
+      } else {
+         r.owner = (i & 1)? fake_table(1) : NULL;
+         r.slot = i - n_own;
+      }
+      regs.push_back(r);
+   }
+   return regs;
+}
+
+static void check_equivalence( unsigned n_own, unsigned n_foreign, unsigned ops )
+{
+   std::vector<reg_ref_t> regs = make_regs(n_own,n_foreign);
+   reg_frame_t frame;
+   reg_map_t ref;
+   for( unsigned op=0; op < ops; op++ ) {
+      const reg_ref_t &r = regs[next_rand() % regs.size()];
+      if( next_rand() & 1 ) {
+         unsigned long long value = ((unsigned long long)next_rand() << 32) | next_rand();
+         frame.at(r.reg,r.owner,r.slot).u64 = value;
+         ref[r.reg].u64 = value;
+      } else {
+         ptx_reg_t *v = frame.find(r.reg,r.owner,r.slot);
+         reg_map_t::iterator i = ref.find(r.reg);
+         if( (v == NULL) != (i == ref.end()) || (v != NULL && v->u64 != i->second.u64) ) {
+            printf("ERROR ** register read differs from the hash map after %u ops\n", op);
+            g_errors++;
+            return;
+         }
+      }
+      if( frame.size() != ref.size() ) {
+         printf("ERROR ** frame holds %zu registers, hash map %zu\n", frame.size(), ref.size());
+         g_errors++;
+         return;
+      }
+   }
+}
+
+//each instruction reads two registers and writes one, threads run in turn
+template<class read_f, class write_f>
+static unsigned long long run_threads( unsigned threads, const std::vector<reg_ref_t> &regs,
+                                       unsigned insts, read_f read, write_f write )
+{
+   unsigned long long sum = 0;
+   for( unsigned i=0; i < insts; i++ ) {
+      const reg_ref_t &a = regs[(i*7) % regs.size()];
+      const reg_ref_t &b = regs[(i*13+1) % regs.size()];
+      const reg_ref_t &d = regs[(i*5+2) % regs.size()];
+      for( unsigned t=0; t < threads; t++ ) {
+         unsigned long long v = read(t,a) + read(t,b);
+         write(t,d,v);
+         sum += v;
+      }
+   }
+   return sum;
+}
+
+static void time_access( unsigned threads, unsigned n_own, unsigned insts )
+{
+   std::vector<reg_ref_t> regs = make_regs(n_own,0);
+   std::vector<reg_frame_t> frames(threads);
+   std::vector<reg_map_t> maps(threads);
+   for( unsigned t=0; t < threads; t++ ) {
+      for( unsigned r=0; r < regs.size(); r++ ) {
+         frames[t].at(regs[r].reg,regs[r].owner,regs[r].slot).u64 = r;
+         maps[t][regs[r].reg].u64 = r;
+      }
+   }
+
+   std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+   unsigned long long map_sum = run_threads(threads,regs,insts,
+      [&]( unsigned t, const reg_ref_t &r ) { return maps[t].find(r.reg)->second.u64; },
+      [&]( unsigned t, const reg_ref_t &r, unsigned long long v ) { maps[t][r.reg].u64 = v; });
+   std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+   unsigned long long frame_sum = run_threads(threads,regs,insts,
+      [&]( unsigned t, const reg_ref_t &r ) { return frames[t].find(r.reg,r.owner,r.slot)->u64; },
+      [&]( unsigned t, const reg_ref_t &r, unsigned long long v ) { frames[t].at(r.reg,r.owner,r.slot).u64 = v; });
+   std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
+   if( map_sum != frame_sum ) {
+      printf("ERROR ** timed runs computed different values\n");
+      g_errors++;
+   }
+   double accesses = 3.0 * threads * insts;
+   printf("%4u threads x %3u registers: hash map %.1f, frame %.1f Maccess/s\n", threads, n_own,
+          accesses / std::chrono::duration<double>(t1-t0).count() / 1e6,
+          accesses / std::chrono::duration<double>(t2-t1).count() / 1e6);
+}
+
+int main( int argc, char *argv[] )
+{
+   unsigned insts = (argc > 1)? atoi(argv[1]) : 20000;
+
+   check_equivalence(16,0,100000);
+   check_equivalence(16,16,100000);
+   check_equivalence(256,64,200000);
+   check_equivalence(0,32,50000);
+
+   static const unsigned threads[] = {1, 32, 1024};
+   static const unsigned n_regs[] = {16, 64};
+   for( unsigned t=0; t < 3; t++ ) {
+      for( unsigned r=0; r < 2; r++ ) 
+         time_access(threads[t],n_regs[r],insts / threads[t] + 100);
+   }
+
+   if( g_errors ) {
+      printf("SUMMARY:  ERRORS FOUND\n");
+   } else {
+      printf("SUMMARY: UNIT TEST PASSED\n");
+   }
+   return g_errors != 0;
+}
@@ -0,0 +1,168 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "cta_sampler.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <random>
+
+// two-sided 95% confidence, normal approximation of the sample means
+static const double CTA_SAMPLE_Z95 = 1.96;
+
+void cta_sample_stats::clear()
+{
+   n_kernels = 0;
+   n_ctas = 0;
+   n_detailed = 0;
+   cycle_delta = 0;
+   cycle_var = 0;
+   insn_delta = 0;
+   insn_var = 0;
+}
+
+void cta_sample_stats::print( FILE *fout, unsigned long long sim_cycle, unsigned long long sim_insn ) const
+{
+   if( n_kernels == 0 )
+      return;
+   double cycles = sim_cycle + cycle_delta;
+   double insn = sim_insn + insn_delta;
+   fprintf(fout, "gpu_cta_sampled_kernels = %u\n", n_kernels);
+   fprintf(fout, "gpu_cta_sampled_ctas = %llu (of %llu)\n", n_detailed, n_ctas);
+   // per-unit counters of the sampled kernels cover only their detailed CTAs
+   fprintf(fout, "gpu_cta_sample_scale = %.4f\n", n_detailed? (double)n_ctas / n_detailed : 0.0);
+   fprintf(fout, "gpu_sim_cycle_extrapolated = %.0f (+/- %.0f, 95%% CI)\n", cycles, CTA_SAMPLE_Z95 * sqrt(cycle_var));
+   fprintf(fout, "gpu_sim_insn_extrapolated = %.0f (+/- %.0f, 95%% CI)\n", insn, CTA_SAMPLE_Z95 * sqrt(insn_var));
+   fprintf(fout, "gpu_ipc_extrapolated = %12.4f\n", cycles > 0? insn / cycles : 0.0);
+}
+
+cta_sampler::cta_sampler( const kernel_info_t &kernel, double fraction, unsigned min_ctas, unsigned seed,
+                          unsigned long long start_cycle )
+{
+   m_grid_dim = kernel.get_grid_dim();
+   unsigned n_ctas = (unsigned)kernel.num_blocks();
+   unsigned n = (unsigned)ceil(fraction * n_ctas);
+   if( n < min_ctas ) n = min_ctas;
+   if( n == 0 ) n = 1;
+   if( n > n_ctas ) n = n_ctas;
+
+   m_detailed.assign(n_ctas, n == n_ctas);
+   if( n < n_ctas ) {
+      std::mt19937 rng(seed + kernel.get_uid());
+      double u = std::uniform_real_distribution<double>(0.0,1.0)(rng);
+      for( unsigned j=0; j < n; j++ )
+         m_detailed[(unsigned)((j + u) * n_ctas / n)] = true;
+   }
+   m_n_detailed = n;
+   m_start_cycle = start_cycle;
+   m_n_done = 0;
+   m_cycles_sum = 0;
+   m_cycles_sum_sq = 0;
+   m_insn_sum = 0;
+   m_insn_sum_sq = 0;
+}
+
+void cta_sampler::kernel_knobs( const char *spec, const std::string &kernel_name,
+                                double &fraction, unsigned &min_ctas )
+{
+   if( spec == NULL )
+      return;
+   char *buf = strdup(spec);
+   char *save = NULL;
+   for( char *tok = strtok_r(buf, ",", &save); tok; tok = strtok_r(NULL, ",", &save) ) {
+      char *colon = strchr(tok, ':');
+      if( colon == NULL ) {
+         printf("GPGPU-Sim uArch: ERROR ** malformed CTA sampling knob \'%s\', expected <kernel>:<fraction>[:<min ctas>]\n", tok);
+         abort();
+      }
+      *colon = 0;
+      if( kernel_name != tok )
+         continue;
+      char *min = strchr(colon+1, ':');
+      if( min ) {
+         *min = 0;
+         min_ctas = strtoul(min+1, NULL, 0);
+      }
+      fraction = strtod(colon+1, NULL);
+   }
+   free(buf);
+}
+
+bool cta_sampler::next_detailed( const kernel_info_t &kernel ) const
+{
+   dim3 ctaid = kernel.get_next_cta_id();
+   unsigned cta = ctaid.x + m_grid_dim.x * (ctaid.y + m_grid_dim.y * ctaid.z);
+   assert( cta < m_detailed.size() );
+   return m_detailed[cta];
+}
+
+void cta_sampler::detailed_cta_done( unsigned long long cycles, unsigned long long insn )
+{
+   m_n_done++;
+   m_cycles_sum += cycles;
+   m_cycles_sum_sq += (double)cycles * cycles;
+   m_insn_sum += insn;
+   m_insn_sum_sq += (double)insn * insn;
+}
+
+// sample variance of the mean, with the finite population correction for
+// drawing n of N CTAs without replacement
+static double mean_variance( double sum, double sum_sq, unsigned n, unsigned N )
+{
+   if( n < 2 )
+      return 0;
+   double mean = sum / n;
+   double s2 = (sum_sq - n * mean * mean) / (n - 1);
+   if( s2 < 0 ) s2 = 0;
+   return s2 / n * (1.0 - (double)n / N);
+}
+
+void cta_sampler::extrapolate( unsigned long long end_cycle, cta_sample_stats &stats ) const
+{
+   unsigned N = m_detailed.size();
+   unsigned n = m_n_done;
+   stats.n_kernels++;
+   stats.n_ctas += N;
+   stats.n_detailed += n;
+   if( n == 0 || n == N )
+      return;
+
+   // cycles scale with the number of CTAs at the throughput the detailed
+   // CTAs achieved; their latency spread bounds the error of that rate
+   double measured = end_cycle - m_start_cycle;
+   double est_cycles = measured * N / n;
+   double mean_cycles = m_cycles_sum / n;
+   double rel_var = mean_cycles > 0? mean_variance(m_cycles_sum, m_cycles_sum_sq, n, N) / (mean_cycles * mean_cycles) : 0;
+   stats.cycle_delta += est_cycles - measured;
+   stats.cycle_var += est_cycles * est_cycles * rel_var;
+
+   double est_insn = (double)N * m_insn_sum / n;
+   stats.insn_delta += est_insn - m_insn_sum;
+   stats.insn_var += (double)N * N * mean_variance(m_insn_sum, m_insn_sum_sq, n, N);
+}
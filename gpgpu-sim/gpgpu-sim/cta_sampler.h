@@ -0,0 +1,98 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CTA_SAMPLER_H
+#define CTA_SAMPLER_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "../abstract_hardware_model.h"
+
+// CTA sampling: the timing model simulates a subset of a kernel's CTAs in
+// detail and executes the others functionally when it reaches them.  Their
+// global and const accesses read and write gem5 memory directly at execution
+// and their local data lives in per thread memory spaces, so they produce the
+// same results as long as they don't race with the memory system: a global
+// atomic of a functional CTA is not ordered against atomics that detailed
+// CTAs still have in flight.  The detailed CTAs are chosen by systematic
+// sampling with a random start (one CTA out of each of n equal strata of the
+// grid), which keeps them spread over the whole kernel.  When the kernel
+// finishes its cycles and instructions are extrapolated to the full grid.
+
+// Extrapolated totals of all sampled kernels so far
+struct cta_sample_stats {
+   cta_sample_stats() { clear(); }
+   void clear();
+   // sim_cycle and sim_insn are the measured totals the estimates extend
+   void print( FILE *fout, unsigned long long sim_cycle, unsigned long long sim_insn ) const;
+
+   unsigned n_kernels;
+   unsigned long long n_ctas;
+   unsigned long long n_detailed;
+   double cycle_delta; // extrapolated minus measured
+   double cycle_var;
+   double insn_delta;
+   double insn_var;
+};
+
+class cta_sampler {
+public:
+   cta_sampler( const kernel_info_t &kernel, double fraction, unsigned min_ctas, unsigned seed,
+                unsigned long long start_cycle );
+
+   // parses "<kernel>:<fraction>[:<min ctas>],..." and overrides fraction and
+   // min_ctas if the list names the kernel
+   static void kernel_knobs( const char *spec, const std::string &kernel_name,
+                             double &fraction, unsigned &min_ctas );
+
+   bool sampled() const { return m_n_detailed < m_detailed.size(); }
+   // is the kernel's next CTA simulated in detail?
+   bool next_detailed( const kernel_info_t &kernel ) const;
+
+   // a detailed CTA retired after running for cycles and committing insn thread instructions
+   void detailed_cta_done( unsigned long long cycles, unsigned long long insn );
+
+   // the kernel finished at end_cycle, add its estimates to stats
+   void extrapolate( unsigned long long end_cycle, cta_sample_stats &stats ) const;
+
+private:
+   dim3 m_grid_dim;
+   std::vector<bool> m_detailed;
+   unsigned m_n_detailed;
+   unsigned long long m_start_cycle;
+
+   // moments of the per-CTA samples
+   unsigned m_n_done;
+   double m_cycles_sum;
+   double m_cycles_sum_sq;
+   double m_insn_sum;
+   double m_insn_sum_sq;
+};
+
+#endif
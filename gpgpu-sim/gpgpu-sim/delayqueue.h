@@ -54,6 +54,8 @@ public:
       m_n_element = 0;
       m_head = NULL;
       m_tail = NULL;
+      m_free = NULL;
+      m_n_nodes = 0;
       for (unsigned i=0;i<m_min_len;i++) 
          push(NULL);
    }
@@ -65,6 +67,11 @@ public:
          m_head = m_head->m_next;
          delete m_tail;
       }
+      while (m_free) {
+         m_tail = m_free;
+         m_free = m_free->m_next;
+         delete m_tail;
+      }
    }
 
    void push(T* data ) 
@@ -72,12 +79,12 @@ public:
       assert(m_length < m_max_len);
       if (m_head) {
          if (m_tail->m_data || m_length < m_min_len) {
-            m_tail->m_next = new fifo_data<T>();
+            m_tail->m_next = alloc_node();
             m_tail = m_tail->m_next;
             m_length++;
          }
       } else {
-         m_head = m_tail = new fifo_data<T>();
+         m_head = m_tail = alloc_node();
          m_length++;
       }
       m_tail->m_next = NULL;
@@ -96,7 +103,7 @@ public:
            assert( next == NULL );
            m_tail = NULL;     
         }
-        delete m_head;
+        free_node(m_head);
         m_head = next;
         m_length--;
         if (m_length == 0) {
@@ -149,7 +156,7 @@ public:
             } else {
                // there are more than one node, and tail node is empty
                assert(iter->m_next == m_tail);
-               delete m_tail;
+               free_node(m_tail);
                m_tail = iter;
                m_tail->m_next = 0;
                m_length--;
@@ -163,6 +170,8 @@ public:
    unsigned get_n_element() const { return m_n_element; }
    unsigned get_length() const { return m_length; }
    unsigned get_max_len() const { return m_max_len; }
+   // nodes ever allocated, i.e. the peak length of the queue
+   unsigned get_n_nodes() const { return m_n_nodes; }
 
    T* get_elm(unsigned elm){
       assert(elm < m_n_element);
@@ -179,6 +188,13 @@ public:
       return cur->m_data;
    }
 
+   // nodes in the queue and the most ever allocated, the difference sits
+   // on the free list
+   void print_nodes( FILE *fp ) const
+   {
+      fprintf(fp, "fifo_pipeline %s: live = %u, peak = %u\n", m_name, m_length, m_n_nodes);
+   }
+
    void print() const
    {
       fifo_data<T>* ddp = m_head;
@@ -191,6 +207,25 @@ public:
    }
 
 private:
+   // nodes are recycled through a free list instead of being allocated on
+   // every push, the list only grows to the queue's peak length
+   fifo_data<T> *alloc_node()
+   {
+      if (m_free) {
+         fifo_data<T> *n = m_free;
+         m_free = m_free->m_next;
+         return n;
+      }
+      m_n_nodes++;
+      return new fifo_data<T>();
+   }
+
+   void free_node( fifo_data<T> *n )
+   {
+      n->m_next = m_free;
+      m_free = n;
+   }
+
    const char* m_name;
 
    unsigned int m_min_len;
@@ -200,6 +235,8 @@ private:
 
    fifo_data<T> *m_head;
    fifo_data<T> *m_tail;
+   fifo_data<T> *m_free;
+   unsigned int m_n_nodes;
 };
 
 #endif
@@ -495,6 +495,62 @@ void dram_t::cycle()
 #endif
 }
 
+bool dram_t::idle() const
+{
+   if( que_length() || !mrqq->empty() || rwq.get_size() || !returnq->empty() )
+      return false;
+   for (unsigned j=0;j<m_config->nbk;j++) {
+      if (bk[j]->mrq)
+         return false;
+   }
+   return true;
+}
+
+// all timing constraints have expired
+bool dram_t::timing_settled() const
+{
+   if (RRDc || CCDc || RTWc || WTRc)
+      return false;
+   for (unsigned j=0;j<m_config->nbk;j++) {
+      if (bk[j]->RCDc || bk[j]->RASc || bk[j]->RCc || bk[j]->RPc ||
+          bk[j]->RCDWRc || bk[j]->WTPc || bk[j]->RTPc)
+         return false;
+   }
+   for (unsigned j=0; j<m_config->nbkgrp; j++) {
+      if (bkgrp[j]->CCDLc || bkgrp[j]->RTPLc)
+         return false;
+   }
+   return true;
+}
+
+void dram_t::idle_cycles( unsigned n )
+{
+   assert( idle() );
+#ifndef DRAM_VISUALIZE
+   // the timing counters of an idle DRAM reach zero within tRC or so cycles;
+   // after that a cycle only counts a NOP and an idle cycle for every bank
+   while (n && !timing_settled()) {
+      cycle();
+      dram_log(SAMPLELOG);
+      n--;
+   }
+   if (n == 0)
+      return;
+   n_nop += n;
+   n_nop_partial += n;
+   n_cmd += n;
+   n_cmd_partial += n;
+   for (unsigned j=0;j<m_config->nbk;j++)
+      bk[j]->n_idle += n;
+   StatAddSamples(mrqq_Dist, 0, n);
+#else
+   while (n--) {
+      cycle();
+      dram_log(SAMPLELOG);
+   }
+#endif
+}
+
 //if mrq is being serviced by dram, gets popped after CL latency fulfilled
 class mem_fetch* dram_t::return_queue_pop() 
 {
@@ -572,6 +628,12 @@ void dram_t::print_stat( FILE* simFile )
    max_mrqs_temp = 0;
 }
 
+void dram_t::print_queue_stat( FILE* simFile ) const
+{
+   mrqq->print_nodes(simFile);
+   returnq->print_nodes(simFile);
+}
+
 void dram_t::visualizer_print( gzFile visualizer_file )
 {
    // dram specific statistics
@@ -130,6 +130,7 @@ public:
    void print( FILE* simFile ) const;
    void visualize() const;
    void print_stat( FILE* simFile );
+   void print_queue_stat( FILE* simFile ) const;
    unsigned que_length() const; 
    bool returnq_full() const;
    unsigned int queue_limit() const;
@@ -141,6 +142,11 @@ public:
    void cycle();
    void dram_log (int task);
 
+   // no request anywhere in the DRAM model
+   bool idle() const;
+   // n cycle()s and SAMPLELOG dram_log()s of an idle DRAM
+   void idle_cycles( unsigned n );
+
    class memory_partition_unit *m_memory_partition_unit;
    unsigned int id;
 
@@ -157,6 +163,7 @@ public:
 private:
    void scheduler_fifo();
    void scheduler_frfcfs();
+   bool timing_settled() const;
 
    const struct memory_config *m_config;
 
@@ -111,9 +111,15 @@ unsigned l2_cache_config::set_index(new_addr_type addr) const{
 	}
 }
 
+// low bits of a packed tag holding the cache_block_state
+static const new_addr_type PACKED_STATE_MASK = 3;
+
 tag_array::~tag_array() 
 {
     delete[] m_lines;
+    delete[] m_packed_tags;
+    delete[] m_packed_access_times;
+    delete[] m_packed_alloc_times;
 }
 
 tag_array::tag_array( cache_config &config,
@@ -148,6 +154,34 @@ void tag_array::init( int core_id, int type_id )
     m_prev_snapshot_pending_hit = 0;
     m_core_id = core_id; 
     m_type_id = type_id;
+
+    if ( m_config.get_line_sz() <= PACKED_STATE_MASK ) {
+        printf("GPGPU-Sim uArch: ERROR ** cache line size %u is too small to pack the line state into the tag\n",
+               m_config.get_line_sz());
+        abort();
+    }
+    // sized like m_lines, the number of sets can change with the kernel's cache preference
+    unsigned n_lines = MAX_DEFAULT_CACHE_SIZE_MULTIBLIER*m_config.get_num_lines();
+    m_packed_tags = new new_addr_type[n_lines];
+    m_packed_access_times = new unsigned[n_lines];
+    m_packed_alloc_times = new unsigned[n_lines];
+    for (unsigned i=0; i < n_lines; i++)
+        update_packed(i);
+}
+
+void tag_array::update_packed( unsigned idx )
+{
+    const cache_block_t &line = m_lines[idx];
+    assert( (line.m_tag & PACKED_STATE_MASK) == 0 );
+    m_packed_tags[idx] = line.m_tag | line.m_status;
+    m_packed_access_times[idx] = line.m_last_access_time;
+    m_packed_alloc_times[idx] = line.m_alloc_time;
+}
+
+void tag_array::set_status( unsigned idx, enum cache_block_state status )
+{
+    m_lines[idx].m_status = status;
+    update_packed(idx);
 }
 
 enum cache_request_status tag_array::probe( new_addr_type addr, unsigned &idx ) const {
@@ -155,47 +189,35 @@ enum cache_request_status tag_array::probe( new_addr_type addr, unsigned &idx )
     unsigned set_index = m_config.set_index(addr);
     new_addr_type tag = m_config.tag(addr);
 
+    unsigned first = set_index*m_config.m_assoc;
+    const new_addr_type *tags = &m_packed_tags[first];
+    // replacement evicts the valid way that is oldest by these times
+    const unsigned *ages = (m_config.m_replacement_policy == FIFO)? &m_packed_alloc_times[first]
+                                                                  : &m_packed_access_times[first];
+
+    unsigned assoc = m_config.m_assoc;
     unsigned invalid_line = (unsigned)-1;
     unsigned valid_line = (unsigned)-1;
     unsigned valid_timestamp = (unsigned)-1;
 
     bool all_reserved = true;
 
-    // check for hit or pending hit
-    for (unsigned way=0; way<m_config.m_assoc; way++) {
-        unsigned index = set_index*m_config.m_assoc+way;
-        cache_block_t *line = &m_lines[index];
-        if (line->m_tag == tag) {
-            if ( line->m_status == RESERVED ) {
-                idx = index;
-                return HIT_RESERVED;
-            } else if ( line->m_status == VALID ) {
-                idx = index;
-                return HIT;
-            } else if ( line->m_status == MODIFIED ) {
-                idx = index;
-                return HIT;
-            } else {
-                assert( line->m_status == INVALID );
-            }
+    // check for hit or pending hit, tracking the replacement candidate on the
+    // way; a way with a matching tag differs from it in the state bits only
+    for (unsigned way=0; way<assoc; way++) {
+        new_addr_type state = tags[way] & PACKED_STATE_MASK;
+        if ( (tags[way] ^ tag) <= PACKED_STATE_MASK && state != INVALID ) {
+            idx = first+way;
+            return (state == RESERVED)? HIT_RESERVED : HIT;
         }
-        if (line->m_status != RESERVED) {
+        if (state != RESERVED) {
             all_reserved = false;
-            if (line->m_status == INVALID) {
-                invalid_line = index;
-            } else {
+            if (state == INVALID) {
+                invalid_line = first+way;
+            } else if ( ages[way] < valid_timestamp ) {
                 // valid line : keep track of most appropriate replacement candidate
-                if ( m_config.m_replacement_policy == LRU ) {
-                    if ( line->m_last_access_time < valid_timestamp ) {
-                        valid_timestamp = line->m_last_access_time;
-                        valid_line = index;
-                    }
-                } else if ( m_config.m_replacement_policy == FIFO ) {
-                    if ( line->m_alloc_time < valid_timestamp ) {
-                        valid_timestamp = line->m_alloc_time;
-                        valid_line = index;
-                    }
-                }
+                valid_timestamp = ages[way];
+                valid_line = first+way;
             }
         }
     }
@@ -232,6 +254,7 @@ enum cache_request_status tag_array::access( new_addr_type addr, unsigned time,
         m_pending_hit++;
     case HIT: 
         m_lines[idx].m_last_access_time=time; 
+        update_packed(idx);
         break;
     case MISS:
         m_miss++;
@@ -242,6 +265,7 @@ enum cache_request_status tag_array::access( new_addr_type addr, unsigned time,
                 evicted = m_lines[idx];
             }
             m_lines[idx].allocate( m_config.tag(addr), m_config.block_addr(addr), time );
+            update_packed(idx);
         }
         break;
     case RESERVATION_FAIL:
@@ -264,18 +288,20 @@ void tag_array::fill( new_addr_type addr, unsigned time )
     if(status!=MISS) assert(status==MISS); // MSHR should have prevented redundant memory request
     m_lines[idx].allocate( m_config.tag(addr), m_config.block_addr(addr), time );
     m_lines[idx].fill(time);
+    update_packed(idx);
 }
 
 void tag_array::fill( unsigned index, unsigned time ) 
 {
     assert( m_config.m_alloc_policy == ON_MISS );
     m_lines[index].fill(time);
+    update_packed(index);
 }
 
 void tag_array::flush() 
 {
     for (unsigned i=0; i < m_config.get_num_lines(); i++)
-        m_lines[i].m_status = INVALID;
+        set_status(i, INVALID);
 }
 
 float tag_array::windowed_miss_rate( ) const
@@ -706,8 +732,7 @@ void baseline_cache::fill(mem_fetch *mf, unsigned time){
     m_mshrs.mark_ready(e->second.m_block_addr, has_atomic);
     if (has_atomic  && !(mf->get_access_type() == Z_ACCESS_TYPE && mf->get_is_write() == false)) {
         assert(m_config.m_alloc_policy == ON_MISS);
-        cache_block_t &block = m_tag_array->get_block(e->second.m_cache_index);
-        block.m_status = MODIFIED; // mark line as dirty for atomic operation
+        m_tag_array->set_status(e->second.m_cache_index, MODIFIED); // mark line as dirty for atomic operation
     }
     m_extra_mf_fields.erase(mf);
     m_bandwidth_management.use_fill_port(mf); 
@@ -806,8 +831,7 @@ void data_cache::send_write_request(mem_fetch *mf, cache_event request, unsigned
 cache_request_status data_cache::wr_hit_wb(new_addr_type addr, unsigned cache_index, mem_fetch *mf, unsigned time, std::list<cache_event> &events, enum cache_request_status status ){
 	new_addr_type block_addr = m_config.block_addr(addr);
 	m_tag_array->access(block_addr,time,cache_index); // update LRU state
-	cache_block_t &block = m_tag_array->get_block(cache_index);
-	block.m_status = MODIFIED;
+	m_tag_array->set_status(cache_index, MODIFIED);
 
 	return HIT;
 }
@@ -819,8 +843,7 @@ cache_request_status data_cache::wr_hit_wt(new_addr_type addr, unsigned cache_in
 
 	new_addr_type block_addr = m_config.block_addr(addr);
 	m_tag_array->access(block_addr,time,cache_index); // update LRU state
-	cache_block_t &block = m_tag_array->get_block(cache_index);
-	block.m_status = MODIFIED;
+	m_tag_array->set_status(cache_index, MODIFIED);
 
 	// generate a write-through
 	send_write_request(mf, WRITE_REQUEST_SENT, time, events);
@@ -834,11 +857,10 @@ cache_request_status data_cache::wr_hit_we(new_addr_type addr, unsigned cache_in
 		return RESERVATION_FAIL; // cannot handle request this cycle
 
 	// generate a write-through/evict
-	cache_block_t &block = m_tag_array->get_block(cache_index);
 	send_write_request(mf, WRITE_REQUEST_SENT, time, events);
 
 	// Invalidate block
-	block.m_status = INVALID;
+	m_tag_array->set_status(cache_index, INVALID);
 
 	return HIT;
 }
@@ -953,8 +975,7 @@ data_cache::rd_hit_base( new_addr_type addr,
     // MODIFIED
     if(mf->isatomic()){ 
         assert(mf->get_access_type() == GLOBAL_ACC_R);
-        cache_block_t &block = m_tag_array->get_block(cache_index);
-        block.m_status = MODIFIED;  // mark line as dirty
+        m_tag_array->set_status(cache_index, MODIFIED);  // mark line as dirty
     }
     return HIT;
 }
@@ -353,7 +353,8 @@ public:
     void fill( unsigned idx, unsigned time );
 
     unsigned size() const { return m_config.get_num_lines();}
-    cache_block_t &get_block(unsigned idx) { return m_lines[idx];}
+    const cache_block_t &get_block(unsigned idx) const { return m_lines[idx];}
+    void set_status( unsigned idx, enum cache_block_state status );
 
     void flush(); // flash invalidate all entries
     void new_window();
@@ -371,6 +372,8 @@ protected:
                int type_id,
                cache_block_t* new_lines );
     void init( int core_id, int type_id );
+    // copy what probe() reads of a line into the packed arrays
+    void update_packed( unsigned idx );
 
 protected:
 
@@ -378,6 +381,15 @@ protected:
 
     cache_block_t *m_lines; /* nbanks x nset x assoc lines in total */
 
+    // probe() only needs the tag, state and replacement time of each way, so
+    // these are kept packed and indexed like m_lines: the ways of a set are
+    // adjacent and a set is scanned in a few host cache lines instead of
+    // one per way.  Tags are line aligned, the state lives in their low bits.
+    // m_lines stays the full record of a line; tag_array writes both.
+    new_addr_type *m_packed_tags;
+    unsigned *m_packed_access_times;
+    unsigned *m_packed_alloc_times;
+
     unsigned m_access;
     unsigned m_miss;
     unsigned m_pending_hit; // number of cache miss that hit a line that is allocated but not filled
@@ -619,6 +631,11 @@ public:
     bool data_port_free() const { return m_bandwidth_management.data_port_free(); } 
     bool fill_port_free() const { return m_bandwidth_management.fill_port_free(); } 
 
+    /// No miss waiting for the memory port and both ports free: cycle() would only sample the ports
+    bool idle() const { return m_miss_queue.empty() && data_port_free() && fill_port_free(); }
+    /// Accounts a cycle() of an idle cache without running it
+    void idle_cycle() { assert(idle()); m_stats.sample_cache_port_utility(false, false); }
+
 protected:
     // Constructor that can be used by derived classes with custom tag arrays
     baseline_cache( const char *name,
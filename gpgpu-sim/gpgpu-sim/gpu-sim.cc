@@ -51,6 +51,7 @@
 #include "addrdec.h"
 #include "stat-tool.h"
 #include "l2cache.h"
+#include "slab_pool.h"
 
 #include "../cuda-sim/ptx-stats.h"
 #include "../statwrapper.h"
@@ -377,6 +378,14 @@ void shader_core_config::reg_options(class OptionParser * opp)
     option_parser_register(opp, "-debug_texture_accesses", OPT_BOOL,
                           &gpgpu_debug_texture_accesses, "Texture memory accesses debug mode (1=On, 0=Off)",
                           "0");
+    option_parser_register(opp, "-gpgpu_warp_trace_mode", OPT_UINT32, &gpgpu_warp_trace_mode,
+                           "Warp instruction trace: 0 = off, 1 = capture while simulating, "
+                           "2 = replay in place of functional simulation. Replay is timing only: "
+                           "instructions are not executed, so kernel output in memory is invalid (default=0)",
+                           "0");
+    option_parser_register(opp, "-gpgpu_warp_trace_file", OPT_CSTR, &gpgpu_warp_trace_file,
+                           "Warp instruction trace file prefix, one <prefix>.<kernel uid>.wtr.gz file per kernel",
+                           "warp_trace");
 }
 
 void gpu_graphics_config::reg_options(OptionParser* opp)
@@ -420,6 +429,27 @@ void gpu_graphics_config::reg_options(OptionParser* opp)
     option_parser_register(opp, "-graphics_skip_checkpoint_frames", OPT_BOOL, &skip_cpt_frames, 
                "graphics: skip rendering gem5 checkpoint loading frames (1=skip, 0=render, default=0 )",
                "0");
+    option_parser_register(opp, "-graphics_shader_cache", OPT_BOOL, &shader_cache, 
+               "graphics: reuse generated shader PTX and parsed binaries across draw calls, checkpoint restore of reused binaries is untested (default=0)",
+               "0");
+    option_parser_register(opp, "-graphics_shader_cache_dir", OPT_CSTR, &shader_cache_dir, 
+               "graphics: directory where the shader cache persists across runs (none=memory only)",
+               "none");
+    option_parser_register(opp, "-graphics_frame_dump_format", OPT_CSTR, &frame_dump_format, 
+               "graphics: format of the per draw call buffer dumps (png, ppm, raw, delta or none, default=png)",
+               "png");
+    option_parser_register(opp, "-graphics_frame_dump_queue", OPT_UINT32, &frame_dump_queue, 
+               "graphics: number of buffer dumps queued for the writer thread before simulation waits (default=8)",
+               "8");
+    option_parser_register(opp, "-graphics_hiz_levels", OPT_UINT32, &hiz_levels, 
+               "graphics: levels of the HiZ pyramid used to cull primitives and TC blocks before tiling (0=disabled, default=0)",
+               "0");
+    option_parser_register(opp, "-graphics_fast_forward", OPT_BOOL, &fast_forward, 
+               "graphics: replay standalone trace frames before the start frame through Mesa only, without advancing simulated time (default=0)",
+               "0");
+    option_parser_register(opp, "-graphics_raster_threads", OPT_UINT32, &raster_threads, 
+               "graphics: host threads that bin the fragments of a primitive batch into raster tiles (default=1)",
+               "1");
 
     option_parser_register(opp, "-graphics_raster_tile_H", OPT_UINT32, &raster_tile_H, 
                "graphics: the height of the rasterization tile (default 4)",
@@ -490,6 +520,19 @@ void gpgpu_sim_config::reg_options(option_parser_t opp)
    option_parser_register(opp, "-gpgpu_ptx_sim_mode", OPT_INT32, &g_ptx_sim_mode, 
                "Select between Performance (default) or Functional simulation (1)", 
                "0");
+   option_parser_register(opp, "-gpgpu_cta_sample_fraction", OPT_DOUBLE, &gpgpu_cta_sample_fraction,
+               "Fraction of each kernel's CTAs simulated in detail, the others run functionally "
+               "and the kernel's cycles are extrapolated (1.0 = simulate every CTA)",
+               "1.0");
+   option_parser_register(opp, "-gpgpu_cta_sample_min", OPT_UINT32, &gpgpu_cta_sample_min,
+               "Minimum number of CTAs per kernel simulated in detail when sampling",
+               "16");
+   option_parser_register(opp, "-gpgpu_cta_sample_seed", OPT_UINT32, &gpgpu_cta_sample_seed,
+               "Seed for choosing the CTAs simulated in detail",
+               "1");
+   option_parser_register(opp, "-gpgpu_cta_sample_kernels", OPT_CSTR, &gpgpu_cta_sample_kernels,
+               "Per-kernel sampling overrides {<kernel>:<fraction>[:<min ctas>],...}",
+               "");
    option_parser_register(opp, "-gpgpu_clock_domains", OPT_CSTR, &gpgpu_clock_domains, 
                   "Clock Domain Frequencies in MhZ {<Core Clock>:<ICNT Clock>:<L2 Clock>:<DRAM Clock>}",
                   "500.0:2000.0:2000.0:2000.0");
@@ -552,6 +595,24 @@ void gpgpu_sim::launch( kernel_info_t *kinfo )
       printf("                 modify the CUDA source to decrease the kernel block size.\n");
       abort();
    }
+   if( m_shader_config->gpgpu_warp_trace_mode != WARP_TRACE_OFF && !kinfo->isGraphicsKernel() ) {
+      // graphics kernels update renderer state from their threads and always run functionally
+      kinfo->set_warp_trace( new warp_trace( (enum warp_trace_mode)m_shader_config->gpgpu_warp_trace_mode,
+                                             m_shader_config->gpgpu_warp_trace_file, *kinfo,
+                                             m_shader_config->warp_size ) );
+   }
+   if( !kinfo->isGraphicsKernel() ) {
+      double fraction = m_config.gpgpu_cta_sample_fraction;
+      unsigned min_ctas = m_config.gpgpu_cta_sample_min;
+      cta_sampler::kernel_knobs( m_config.gpgpu_cta_sample_kernels, kinfo->name(), fraction, min_ctas );
+      if( fraction < 1.0 ) {
+         cta_sampler *sampler = new cta_sampler( *kinfo, fraction, min_ctas, m_config.gpgpu_cta_sample_seed, gpu_sim_cycle );
+         if( sampler->sampled() )
+            kinfo->set_cta_sampler(sampler);
+         else
+            delete sampler;
+      }
+   }
    unsigned n=0;
    for(n=0; n < m_running_kernels.size(); n++ ) {
        if( (NULL==m_running_kernels[n]) || m_running_kernels[n]->done() ) {
@@ -619,6 +680,13 @@ unsigned gpgpu_sim::finished_kernel()
 void gpgpu_sim::set_kernel_done( kernel_info_t *kernel ) 
 { 
     unsigned uid = kernel->get_uid();
+    delete kernel->get_warp_trace();
+    kernel->set_warp_trace(NULL);
+    if( cta_sampler *sampler = kernel->get_cta_sampler() ) {
+        sampler->extrapolate( gpu_sim_cycle, m_cta_sample_stats );
+        delete sampler;
+        kernel->set_cta_sampler(NULL);
+    }
     //m_finished_kernel.push_back(uid);
     gem5CudaGPU->finishKernel(uid);
     std::vector<kernel_info_t*>::iterator k;
@@ -985,6 +1053,7 @@ void gpgpu_sim::gpu_print_stat()
    printf("gpu_tot_sim_insn = %lld\n", gpu_tot_sim_insn+gpu_sim_insn);
    printf("gpu_tot_ipc = %12.4f\n", (float)(gpu_tot_sim_insn+gpu_sim_insn) / (gpu_tot_sim_cycle+gpu_sim_cycle));
    printf("gpu_tot_issued_cta = %lld\n", gpu_tot_issued_cta);
+   m_cta_sample_stats.print(statfout, gpu_sim_cycle, gpu_sim_insn);
 
 
 
@@ -996,6 +1065,11 @@ void gpgpu_sim::gpu_print_stat()
    time(&curr_time);
    unsigned long long elapsed_time = MAX( curr_time - g_simulation_starttime, 1 );
    printf( "gpu_total_sim_rate=%u\n", (unsigned)( ( gpu_tot_sim_insn + gpu_sim_insn ) / elapsed_time ) );
+   // memory requests still allocated at this point, and the live and peak
+   // node counts of the memory partition queues
+   slab_pool::print_all(statfout);
+   for (unsigned i=0;i<m_memory_config->m_n_mem;i++)
+      m_memory_partition_unit[i]->print_queue_stat(statfout);
 
    //shader_print_l1_miss_stat( stdout );
    shader_print_cache_stats(stdout);
@@ -1158,6 +1232,9 @@ void shader_core_ctx::issue_block2core( kernel_info_t &kernel )
     }
     assert( free_cta_hw_id!=(unsigned)-1 );
 
+    // flattened id of the CTA, read before thread initialization advances it
+    dim3 ctaid = kernel.get_next_cta_id();
+
     // determine hardware threads and warps that will be used for this CTA
     int cta_size = kernel.threads_per_cta();
 
@@ -1186,6 +1263,8 @@ void shader_core_ctx::issue_block2core( kernel_info_t &kernel )
     }
     assert( nthreads_in_block > 0 && nthreads_in_block <= m_config->n_thread_per_shader); // should be at least one, but less than max
     m_cta_status[free_cta_hw_id]=nthreads_in_block;
+    m_cta_start_cycle[free_cta_hw_id]=gpu_sim_cycle;
+    m_cta_insn[free_cta_hw_id]=0;
 
     // now that we know which warps are used in this CTA, we can allocate
     // resources for use in CTA-wide barrier operations
@@ -1195,6 +1274,14 @@ void shader_core_ctx::issue_block2core( kernel_info_t &kernel )
     init_warps( free_cta_hw_id, start_thread, end_thread);
     m_n_active_cta++;
 
+    // bind each warp to its instruction trace, keyed by CTA and warp within the CTA
+    if( warp_trace *trace = kernel.get_warp_trace() ) {
+        unsigned start_warp = start_thread / m_config->warp_size;
+        unsigned end_warp = (end_thread + m_config->warp_size - 1) / m_config->warp_size;
+        for( unsigned i = start_warp; i < end_warp; i++ )
+            m_warp[i].set_trace( trace->stream(trace->cta_id(ctaid), i - start_warp) );
+    }
+
     shader_CTA_count_log(m_sid, 1);
 //    printf("GPGPU-Sim uArch: core:%3d, cta:%2u initialized @(%lld,%lld)\n", m_sid, free_cta_hw_id, gpu_sim_cycle, gpu_tot_sim_cycle );
     m_gpu->gem5CudaGPU->getCudaCore(m_sid)->record_block_issue(free_cta_hw_id);
@@ -1211,6 +1298,18 @@ void dram_t::dram_log( int task )
    }
 }
 
+void gpgpu_sim::run_unsampled_ctas( kernel_info_t &kernel, unsigned sid )
+{
+    cta_sampler *sampler = kernel.get_cta_sampler();
+    if( sampler == NULL )
+        return;
+    // hardware thread ids past the core's own keep these CTAs' shared and
+    // local memory apart from the CTAs running on the core
+    unsigned tid_base = m_shader_config->n_thread_per_shader + kernel.threads_per_cta();
+    while( !kernel.no_more_ctas_to_run() && !sampler->next_detailed(kernel) )
+        gpgpu_cuda_ptx_sim_cta( kernel, sid, tid_base );
+}
+
 void gpgpu_sim::issue_block2core()
 {
     unsigned last_issued = m_last_cluster_issue; 
@@ -1229,24 +1328,46 @@ unsigned long long g_single_step=0; // set this in gdb to single step the pipeli
 void
 gpgpu_sim::core_cycle_start()
 {
+    // GPUWattch reads the icnt/cache/DRAM counters only on the cycles
+    // mcpat_cycle samples, so they are gathered on those cycles alone
+    bool power_sample = m_config.g_power_simulation_enabled &&
+        ((unsigned)gpu_tot_sim_cycle + (unsigned)(gpu_sim_cycle+1)) % m_config.gpu_stat_sample_freq == 0;
+
     // L1 cache + shader core pipeline stages
-    m_power_stats->pwr_mem_stat->core_cache_stats[CURRENT_STAT_IDX].clear();
     for (unsigned i=0;i<m_shader_config->n_simt_clusters;i++) {
        if (m_cluster[i]->get_not_completed() || get_more_cta_left() ) {
              m_cluster[i]->core_cycle();
-             *active_sms+=m_cluster[i]->get_n_active_sms();
+             if (m_config.g_power_simulation_enabled)
+                *active_sms+=m_cluster[i]->get_n_active_sms();
        }
+    }
+    if (power_sample) {
        // Update core icnt/cache stats for GPUWattch
-       m_cluster[i]->get_icnt_stats(m_power_stats->pwr_mem_stat->n_simt_to_mem[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_mem_to_simt[CURRENT_STAT_IDX][i]);
-       m_cluster[i]->get_cache_stats(m_power_stats->pwr_mem_stat->core_cache_stats[CURRENT_STAT_IDX]);
+       m_power_stats->pwr_mem_stat->core_cache_stats[CURRENT_STAT_IDX].clear();
+       for (unsigned i=0;i<m_shader_config->n_simt_clusters;i++) {
+          m_cluster[i]->get_icnt_stats(m_power_stats->pwr_mem_stat->n_simt_to_mem[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_mem_to_simt[CURRENT_STAT_IDX][i]);
+          m_cluster[i]->get_cache_stats(m_power_stats->pwr_mem_stat->core_cache_stats[CURRENT_STAT_IDX]);
+       }
+       // L2 and DRAM counters only change in their own cycles, so their
+       // current values are the ones the last l2_cycle/dram_cycle saw
+       m_power_stats->pwr_mem_stat->l2_cache_stats[CURRENT_STAT_IDX].clear();
+       for (unsigned i=0;i<m_memory_config->m_n_mem_sub_partition;i++)
+          m_memory_sub_partition[i]->accumulate_L2cache_stats(m_power_stats->pwr_mem_stat->l2_cache_stats[CURRENT_STAT_IDX]);
+       for (unsigned i=0;i<m_memory_config->m_n_mem;i++){
+          m_memory_partition_unit[i]->set_dram_power_stats(m_power_stats->pwr_mem_stat->n_cmd[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_activity[CURRENT_STAT_IDX][i],
+                         m_power_stats->pwr_mem_stat->n_nop[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_act[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_pre[CURRENT_STAT_IDX][i],
+                         m_power_stats->pwr_mem_stat->n_rd[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_wr[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_req[CURRENT_STAT_IDX][i]);
+       }
     }
-    float temp=0;
-    for (unsigned i=0;i<m_shader_config->num_shader();i++){
-      temp+=m_shader_stats->m_pipeline_duty_cycle[i];
+    if (m_config.g_power_simulation_enabled) {
+       float temp=0;
+       for (unsigned i=0;i<m_shader_config->num_shader();i++){
+         temp+=m_shader_stats->m_pipeline_duty_cycle[i];
+       }
+       temp=temp/m_shader_config->num_shader();
+       *average_pipeline_duty_cycle=((*average_pipeline_duty_cycle)+temp);
+         //cout<<"Average pipeline duty cycle: "<<*average_pipeline_duty_cycle<<endl;
     }
-    temp=temp/m_shader_config->num_shader();
-    *average_pipeline_duty_cycle=((*average_pipeline_duty_cycle)+temp);
-      //cout<<"Average pipeline duty cycle: "<<*average_pipeline_duty_cycle<<endl;
 
 
     if( g_single_step && ((gpu_sim_cycle+gpu_tot_sim_cycle) >= g_single_step) ) {
@@ -1353,9 +1474,14 @@ gpgpu_sim::core_cycle_start()
 void
 gpgpu_sim::core_cycle_end()
 {
-    // shader core loading (pop from ICNT into core) follows CORE clock
-    for (unsigned i=0;i<m_shader_config->n_simt_clusters;i++)
+    // shader core loading (pop from ICNT into core) follows CORE clock;
+    // a cluster has nothing to load if neither it nor the network holds a reply
+    bool icnt_idle = ::icnt_drained();
+    for (unsigned i=0;i<m_shader_config->n_simt_clusters;i++) {
+        if (icnt_idle && m_cluster[i]->response_fifo_empty())
+            continue;
         m_cluster[i]->icnt_cycle();
+    }
 }
 
 void
@@ -1390,20 +1516,20 @@ gpgpu_sim::icnt_cycle_end()
 void
 gpgpu_sim::dram_cycle()
 {
-    for (unsigned i=0;i<m_memory_config->m_n_mem;i++){
+    // an idle partition only counts the cycle, see memory_partition_unit::dram_cycle
+    for (unsigned i=0;i<m_memory_config->m_n_mem;i++)
        m_memory_partition_unit[i]->dram_cycle(); // Issue the dram command (scheduler + delay model)
-       // Update performance counters for DRAM
-       m_memory_partition_unit[i]->set_dram_power_stats(m_power_stats->pwr_mem_stat->n_cmd[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_activity[CURRENT_STAT_IDX][i],
-                      m_power_stats->pwr_mem_stat->n_nop[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_act[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_pre[CURRENT_STAT_IDX][i],
-                      m_power_stats->pwr_mem_stat->n_rd[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_wr[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_req[CURRENT_STAT_IDX][i]);
-    }
 }
 
 void
 gpgpu_sim::l2_cycle()
 {
-    m_power_stats->pwr_mem_stat->l2_cache_stats[CURRENT_STAT_IDX].clear();
+    bool icnt_idle = ::icnt_drained();
     for (unsigned i=0;i<m_memory_config->m_n_mem_sub_partition;i++) {
+        if (icnt_idle && m_memory_sub_partition[i]->idle()) {
+            m_memory_sub_partition[i]->idle_cycle();
+            continue;
+        }
         //move memory request from interconnect into memory partition (if not backed up)
         //Note:This needs to be called in DRAM clock domain if there is no L2 cache in the system
         m_memory_sub_partition[i]->z_unit_cycle(gpu_sim_cycle+gpu_tot_sim_cycle);
@@ -1415,7 +1541,6 @@ gpgpu_sim::l2_cycle()
             m_memory_sub_partition[i]->push( mf, gpu_sim_cycle + gpu_tot_sim_cycle );
         }
         m_memory_sub_partition[i]->cache_cycle(gpu_sim_cycle+gpu_tot_sim_cycle);
-        m_memory_sub_partition[i]->accumulate_L2cache_stats(m_power_stats->pwr_mem_stat->l2_cache_stats[CURRENT_STAT_IDX]);
     }
 }
 
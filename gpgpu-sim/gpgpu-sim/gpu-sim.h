@@ -35,6 +35,7 @@
 #include "addrdec.h"
 #include "shader.h"
 #include "z-unit.h"
+#include "cta_sampler.h"
 
 
 #include <iostream>
@@ -292,6 +293,11 @@ public:
         g_renderData.initParams(graphics_standalone_mode, start_frame, end_frame, start_call, end_call, raster_tile_H, raster_tile_W, raster_block_H, raster_block_W, tc_h, tc_w,
               tc_block_dim, vert_wg_size, frag_wg_size, pvb_size, use_shader_blending, use_shader_depth_test,
               cpt_start_frame, cpt_end_frame, cpt_period, skip_cpt_frames, output_dir);
+        g_renderData.initShaderCache(shader_cache, shader_cache_dir);
+        g_renderData.initFrameDumps(frame_dump_format, frame_dump_queue);
+        g_renderData.initHizPyramid(hiz_levels);
+        g_renderData.initFastForward(fast_forward);
+        g_renderData.initRasterWorkers(raster_threads);
     }
     
     //the start and the end frames for simulation
@@ -328,6 +334,13 @@ public:
     unsigned int core_prim_warps;
 
     bool skip_cpt_frames;
+    bool shader_cache;
+    char* shader_cache_dir;
+    char* frame_dump_format;
+    unsigned int frame_dump_queue;
+    unsigned int hiz_levels;
+    bool fast_forward;
+    unsigned int raster_threads;
     char* output_dir;
 };
 
@@ -403,6 +416,12 @@ private:
     char * gpgpu_clock_domains;
     unsigned max_concurrent_kernel;
 
+    // CTA sampling (see cta_sampler.h)
+    double gpgpu_cta_sample_fraction;
+    unsigned gpgpu_cta_sample_min;
+    unsigned gpgpu_cta_sample_seed;
+    char *gpgpu_cta_sample_kernels;
+
     // visualizer
     bool  g_visualizer_enabled;
     char *g_visualizer_filename;
@@ -454,6 +473,9 @@ public:
    unsigned threads_per_core() const;
    bool get_more_cta_left() const;
    kernel_info_t *select_kernel();
+   // functionally executes the kernel's next CTAs on behalf of core sid
+   // until it reaches one that is sampled for detailed simulation
+   void run_unsampled_ctas( kernel_info_t &kernel, unsigned sid );
 
    const gpgpu_sim_config &get_config() const { return m_config; }
    void gpu_print_stat();
@@ -536,6 +558,7 @@ private:
    class gpgpu_sim_wrapper *m_gpgpusim_wrapper;
    unsigned long long  gpu_tot_issued_cta;
    unsigned long long  last_gpu_sim_insn;
+   cta_sample_stats    m_cta_sample_stats;
 
    unsigned long long  last_liveness_message_time; 
 
@@ -40,6 +40,8 @@ bool graphics_simt_pipeline::add_prim_batch(std::vector<unsigned> coverage_batch
    std::vector<std::vector<std::pair<unsigned, bool> > >
       coverage_masks(clust_count);
 
+   //bin the whole batch up front so the raster workers can share it
+   g_renderData.sortPrimBatch(coverage_batch);
    for(unsigned primId=0; primId<coverage_batch.size(); primId++){
       std::set<unsigned> coverage = 
          g_renderData.getClustersCoveredByPrim(coverage_batch[primId]);
@@ -51,6 +53,7 @@ bool graphics_simt_pipeline::add_prim_batch(std::vector<unsigned> coverage_batch
 
    for(unsigned cid=0; cid<coverage_masks.size(); cid++)
       m_curr_coverage_masks.push_back(c_mask_t(cid, coverage_masks[cid]));
+   return true;
 }
 
 void graphics_simt_pipeline::run_out_prim_batch(){
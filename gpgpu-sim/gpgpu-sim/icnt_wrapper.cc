@@ -37,6 +37,7 @@ icnt_push_p                  icnt_push;
 icnt_pop_p                   icnt_pop;
 icnt_transfer_p              icnt_transfer;
 icnt_busy_p                  icnt_busy;
+icnt_drained_p               icnt_drained;
 icnt_display_stats_p         icnt_display_stats;
 icnt_display_overall_stats_p icnt_display_overall_stats;
 icnt_display_state_p         icnt_display_state;
@@ -85,6 +86,11 @@ static bool intersim2_busy()
    return g_icnt_interface->Busy();
 }
 
+static bool intersim2_drained()
+{
+   return g_icnt_interface->Drained();
+}
+
 static void intersim2_display_stats()
 {
    g_icnt_interface->DisplayStats();
@@ -124,6 +130,7 @@ void icnt_wrapper_init()
          icnt_pop        = intersim2_pop;
          icnt_transfer   = intersim2_transfer;
          icnt_busy       = intersim2_busy;
+         icnt_drained    = intersim2_drained;
          icnt_display_stats = intersim2_display_stats;
          icnt_display_overall_stats = intersim2_display_overall_stats;
          icnt_display_state = intersim2_display_state;
@@ -39,6 +39,7 @@ typedef void (*icnt_push_p)(unsigned input, unsigned output, void* data, unsigne
 typedef void* (*icnt_pop_p)(unsigned output);
 typedef void (*icnt_transfer_p)( );
 typedef bool (*icnt_busy_p)( );
+typedef bool (*icnt_drained_p)( );
 typedef void (*icnt_drain_p)( );
 typedef void (*icnt_display_stats_p)( );
 typedef void (*icnt_display_overall_stats_p)( );
@@ -52,6 +53,7 @@ extern icnt_push_p       icnt_push;
 extern icnt_pop_p        icnt_pop;
 extern icnt_transfer_p   icnt_transfer;
 extern icnt_busy_p       icnt_busy;
+extern icnt_drained_p    icnt_drained;
 extern icnt_drain_p      icnt_drain;
 extern icnt_display_stats_p icnt_display_stats;
 extern icnt_display_overall_stats_p icnt_display_overall_stats;
@@ -65,6 +65,7 @@ memory_partition_unit::memory_partition_unit( unsigned partition_id,
                                               class memory_stats_t *stats )
 : m_id(partition_id), m_config(config), m_stats(stats), m_arbitration_metadata(config) 
 {
+    m_n_dram_idle_cycles = 0;
     m_dram = new dram_t(m_id,m_config,m_stats,this);
 
     m_sub_partition = new memory_sub_partition*[m_config->m_n_sub_partition_per_memory_channel]; 
@@ -168,6 +169,7 @@ void memory_partition_unit::cache_cycle(unsigned cycle)
 
 void memory_partition_unit::visualizer_print( gzFile visualizer_file ) const 
 {
+    settle_dram_idle_cycles();
     m_dram->visualizer_print(visualizer_file);
     for (unsigned p = 0; p < m_config->m_n_sub_partition_per_memory_channel; p++) {
         m_sub_partition[p]->visualizer_print(visualizer_file); 
@@ -192,9 +194,34 @@ int memory_partition_unit::global_sub_partition_id_to_local_id(int global_sub_pa
     return (global_sub_partition_id - m_id * m_config->m_n_sub_partition_per_memory_channel); 
 }
 
+bool memory_partition_unit::dram_idle() const
+{
+    if( !m_dram->idle() || !m_dram_latency_queue.empty() )
+        return false;
+    for (unsigned p = 0; p < m_config->m_n_sub_partition_per_memory_channel; p++) {
+        if (!m_sub_partition[p]->L2_dram_queue_empty())
+            return false;
+    }
+    return true;
+}
+
+void memory_partition_unit::settle_dram_idle_cycles() const
+{
+    if (m_n_dram_idle_cycles) {
+        m_dram->idle_cycles(m_n_dram_idle_cycles);
+        m_n_dram_idle_cycles = 0;
+    }
+}
+
 void memory_partition_unit::dram_cycle() 
 { 
     assert(m_dram->que_length() == 0);
+    if (dram_idle()) {
+        m_n_dram_idle_cycles++;
+        return;
+    }
+    settle_dram_idle_cycles();
+
     // pop completed memory request from dram and push it to dram-to-L2 queue 
     // of the original sub partition 
     mem_fetch* mf_return = m_dram->return_queue_top();
@@ -271,9 +298,19 @@ void memory_partition_unit::set_dram_power_stats(unsigned &n_cmd,
                                                  unsigned &n_wr,
                                                  unsigned &n_req) const
 {
+    settle_dram_idle_cycles();
     m_dram->set_dram_power_stats(n_cmd, n_activity, n_nop, n_act, n_pre, n_rd, n_wr, n_req);
 }
 
+void memory_partition_unit::print_queue_stat( FILE *fp ) const
+{
+    fprintf(fp, "Memory Partition %u queues:\n", m_id);
+    m_dram->print_queue_stat(fp);
+    for (unsigned p = 0; p < m_config->m_n_sub_partition_per_memory_channel; p++) {
+        m_sub_partition[p]->print_queue_stat(fp);
+    }
+}
+
 void memory_partition_unit::print( FILE *fp ) const
 {
     fprintf(fp, "Memory Partition %u: \n", m_id); 
@@ -290,6 +327,7 @@ void memory_partition_unit::print( FILE *fp ) const
         else 
             fprintf(fp, " <NULL mem_fetch?>\n"); 
     }
+    settle_dram_idle_cycles();
     m_dram->print(fp); 
 }
 
@@ -459,6 +497,19 @@ void memory_sub_partition::cache_cycle( unsigned cycle )
     }
 }
 
+bool memory_sub_partition::idle() const
+{
+    if (!m_icnt_L2_queue->empty() || !m_dram_L2_queue->empty() || !m_rop.empty())
+        return false;
+    return m_config->m_L2_config.disabled() || (!m_L2cache->access_ready() && m_L2cache->idle());
+}
+
+void memory_sub_partition::idle_cycle()
+{
+    if (!m_config->m_L2_config.disabled())
+        m_L2cache->idle_cycle();
+}
+
 bool memory_sub_partition::full() const
 {
     return (m_icnt_L2_queue->full());// || m_z_unit->incoming_buffer_full());
@@ -527,6 +578,14 @@ void memory_sub_partition::print( FILE *fp ) const
        m_L2cache->display_state(fp);
 }
 
+void memory_sub_partition::print_queue_stat( FILE *fp ) const
+{
+    m_icnt_L2_queue->print_nodes(fp);
+    m_L2_dram_queue->print_nodes(fp);
+    m_dram_L2_queue->print_nodes(fp);
+    m_L2_icnt_queue->print_nodes(fp);
+}
+
 void memory_stats_t::visualizer_print( gzFile visualizer_file )
 {
    // gzprintf(visualizer_file, "Ltwowritemiss: %d\n", L2_write_miss);
@@ -72,8 +72,9 @@ public:
    void set_done( mem_fetch *mf );
 
    void visualizer_print( gzFile visualizer_file ) const;
-   void print_stat( FILE *fp ) { m_dram->print_stat(fp); }
-   void visualize() const { m_dram->visualize(); }
+   void print_stat( FILE *fp ) { settle_dram_idle_cycles(); m_dram->print_stat(fp); }
+   void print_queue_stat( FILE *fp ) const;
+   void visualize() const { settle_dram_idle_cycles(); m_dram->visualize(); }
    void print( FILE *fp ) const;
 
    class memory_sub_partition * get_sub_partition(int sub_partition_id) 
@@ -142,6 +143,13 @@ private:
       class mem_fetch* req;
    };
    std::list<dram_delay_t> m_dram_latency_queue;
+
+   // nothing for dram_cycle() to move and the DRAM itself idle
+   bool dram_idle() const;
+   // idle DRAM cycles are counted here and handed to the DRAM model in one
+   // go before it has work again or its statistics are read
+   void settle_dram_idle_cycles() const;
+   mutable unsigned m_n_dram_idle_cycles;
 };
 
 class memory_sub_partition
@@ -153,8 +161,12 @@ public:
    unsigned get_id() const { return m_id; } 
 
    bool busy() const;
+   // nothing queued for cache_cycle() and the L2 idle
+   bool idle() const;
 
    void cache_cycle( unsigned cycle );
+   // accounts a cache_cycle() of an idle sub partition without running it
+   void idle_cycle();
    bool full() const;
    bool full_for_request(mem_fetch* mf) const;
    void push(class mem_fetch* mf, unsigned long long clock_cycle);
@@ -181,6 +193,7 @@ public:
 			, unsigned &Z_read_accesses, unsigned &Z_read_misses) const;
 	void print_z_unit_stat(unsigned &accesses, unsigned &misses, unsigned &depthColorWrites, unsigned &blendingColorWrites) const;
 	void print(FILE *fp) const;
+   void print_queue_stat( FILE *fp ) const;
 	void z_unit_cycle(unsigned cycle) {
 //		m_z_unit->cycle(cycle);
 	}
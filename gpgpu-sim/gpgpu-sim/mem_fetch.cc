@@ -33,6 +33,23 @@
 
 unsigned mem_fetch::sm_next_mf_request_uid=1;
 
+static slab_pool &mem_fetch_pool()
+{
+   static slab_pool *pool = new slab_pool("mem_fetch", sizeof(mem_fetch));
+   return *pool;
+}
+
+void *mem_fetch::operator new( size_t size )
+{
+   assert( size == sizeof(mem_fetch) );
+   return mem_fetch_pool().alloc();
+}
+
+void mem_fetch::operator delete( void *p, size_t size )
+{
+   mem_fetch_pool().free(p);
+}
+
 mem_fetch::mem_fetch( const mem_access_t &access, 
 		const warp_inst_t *inst,
 		unsigned ctrl_size,
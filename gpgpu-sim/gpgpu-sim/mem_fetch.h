@@ -29,6 +29,7 @@
 #define MEM_FETCH_H
 
 #include "addrdec.h"
+#include "slab_pool.h"
 #include "../abstract_hardware_model.h"
 #include <bitset>
 
@@ -58,6 +59,11 @@ public:
                const class memory_config *config );
    ~mem_fetch();
 
+   // mem_fetches are created and destroyed for every memory request, they
+   // come from a slab pool instead of the heap
+   static void *operator new( size_t size );
+   static void operator delete( void *p, size_t size );
+
    void set_status( enum mem_fetch_status status, unsigned long long cycle );
    void set_reply() 
    { 
@@ -0,0 +1,106 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SCHEDULER_ORDER_H
+#define SCHEDULER_ORDER_H
+
+#include <assert.h>
+#include <vector>
+
+// Warp orderings of the greedy-then-oldest schedulers (gto and
+// warp_limiting in shader.cc).  They only use the warp accessors below, so
+// they are kept apart from the shader core and can be tested on their own.
+// T is a pointer to a warp with done_exit(), waiting() and
+// get_dynamic_warp_id().
+
+// Warps that can issue come first, oldest dynamic warp id first
+template < class T >
+bool warp_older_dynamic_id( T lhs, T rhs )
+{
+    if (rhs && lhs) {
+        if ( lhs->done_exit() || lhs->waiting() ) {
+            return false;
+        } else if ( rhs->done_exit() || rhs->waiting() ) {
+            return true;
+        } else {
+            return lhs->get_dynamic_warp_id() < rhs->get_dynamic_warp_id();
+        }
+    } else {
+        return lhs < rhs;
+    }
+}
+
+/**
+ * Puts the last issued warp first, then up to num_warps_to_add warps from
+ * age_ordered_list, which holds the supervised warps from the oldest to the
+ * youngest dynamic warp id.  stalled_list is scratch space.
+ *
+ * Sorting the supervised warps with warp_older_dynamic_id places the warps
+ * that are neither done nor waiting first, oldest first, and the others
+ * after them in an unspecified order.  The ids of live warps are unique, so
+ * walking the age ordered list gives the same live warps in the same order.
+ * Done and waiting warps cannot issue and scheduler_unit::cycle() passes
+ * over them without side effects, so neither their order nor, under a warp
+ * limit, which of them make the list matters.
+ */
+template < class T >
+void order_greedy_then_oldest( std::vector< T >& result_list,
+                               const std::vector< T >& age_ordered_list,
+                               const typename std::vector< T >::const_iterator& last_issued_from_input,
+                               unsigned num_warps_to_add,
+                               std::vector< T >& stalled_list )
+{
+    assert( num_warps_to_add <= age_ordered_list.size() );
+    result_list.clear();
+    stalled_list.clear();
+
+    T greedy_value = *last_issued_from_input;
+    result_list.push_back( greedy_value );
+
+    unsigned count = 0;
+    for ( typename std::vector< T >::const_iterator iter = age_ordered_list.begin();
+          iter != age_ordered_list.end();
+          ++iter ) {
+        if ( (*iter)->done_exit() || (*iter)->waiting() ) {
+            stalled_list.push_back( *iter );
+        } else if ( count < num_warps_to_add ) {
+            if ( *iter != greedy_value ) {
+                result_list.push_back( *iter );
+            }
+            ++count;
+        }
+    }
+    for ( typename std::vector< T >::const_iterator iter = stalled_list.begin();
+          iter != stalled_list.end() && count < num_warps_to_add;
+          ++iter, ++count ) {
+        if ( *iter != greedy_value ) {
+            result_list.push_back( *iter );
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,213 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Checks order_greedy_then_oldest() against sorting the supervised warps,
+// which is what the gto and warp_limiting schedulers did before, and times
+// both.  Usage: scheduler_order_test [orderings to time]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "scheduler_order.h"
+
+// stands in for shd_warp_t, the orderings only look at these
+struct test_warp {
+    unsigned m_dynamic_warp_id;
+    bool m_done_exit;
+    bool m_waiting;
+
+    bool done_exit() const { return m_done_exit; }
+    bool waiting() const { return m_waiting; }
+    unsigned get_dynamic_warp_id() const { return m_dynamic_warp_id; }
+};
+
+// the warps of one scheduler, kept in age order the way
+// scheduler_unit::warp_launched() does
+struct test_warps {
+    test_warps( unsigned n_warps ) : m_warps(n_warps), m_next_dynamic_id(0)
+    {
+        for (unsigned i=0; i < n_warps; i++) {
+            m_supervised.push_back(&m_warps[i]);
+            m_age_ordered.push_back(&m_warps[i]);
+            launch(i);
+        }
+    }
+    void launch( unsigned i )
+    {
+        test_warp *w = &m_warps[i];
+        w->m_dynamic_warp_id = m_next_dynamic_id++;
+        w->m_done_exit = false;
+        w->m_waiting = false;
+        m_age_ordered.erase( std::find(m_age_ordered.begin(), m_age_ordered.end(), w) );
+        m_age_ordered.push_back(w);
+    }
+    // a random warp finishes, is relaunched, or starts or stops waiting
+    void step()
+    {
+        unsigned i = rand() % m_warps.size();
+        if ( rand()%4 == 0 ) {
+            if ( m_warps[i].m_done_exit )
+                launch(i);
+            else
+                m_warps[i].m_done_exit = true;
+        } else {
+            m_warps[i].m_waiting = !m_warps[i].m_waiting;
+        }
+    }
+
+    std::vector<test_warp> m_warps;
+    std::vector<test_warp*> m_supervised;
+    std::vector<test_warp*> m_age_ordered;
+    unsigned m_next_dynamic_id;
+};
+
+// scheduler_unit::order_by_priority with ORDERING_GREEDY_THEN_PRIORITY_FUNC
+// and sort_warps_by_oldest_dynamic_id
+static void sorted_greedy_then_oldest( std::vector<test_warp*> &result_list,
+                                       const std::vector<test_warp*> &input_list,
+                                       std::vector<test_warp*>::const_iterator last_issued,
+                                       unsigned num_warps_to_add )
+{
+    result_list.clear();
+    std::vector<test_warp*> temp = input_list;
+    test_warp *greedy_value = *last_issued;
+    result_list.push_back( greedy_value );
+    std::sort( temp.begin(), temp.end(), warp_older_dynamic_id<test_warp*> );
+    std::vector<test_warp*>::iterator iter = temp.begin();
+    for ( unsigned count = 0; count < num_warps_to_add; ++count, ++iter ) {
+        if ( *iter != greedy_value )
+            result_list.push_back( *iter );
+    }
+}
+
+static void ready_warps( const std::vector<test_warp*> &list, std::vector<test_warp*> &ready )
+{
+    ready.clear();
+    for (unsigned i=0; i < list.size(); i++) {
+        if ( !list[i]->done_exit() && !list[i]->waiting() )
+            ready.push_back(list[i]);
+    }
+}
+
+// cycle() can only issue ready warps and passes over the others without side
+// effects, so the greedy warp and the order of the ready warps have to match
+static int check_orderings( unsigned n_warps, unsigned limit, unsigned n_cycles )
+{
+    test_warps warps(n_warps);
+    std::vector<test_warp*> sorted, walked, stalled, sorted_ready, walked_ready;
+    for (unsigned c=0; c < n_cycles; c++) {
+        for (unsigned n = 1 + rand()%3; n > 0; n--)
+            warps.step();
+        std::vector<test_warp*>::const_iterator last_issued = warps.m_supervised.begin() + rand()%n_warps;
+        sorted_greedy_then_oldest( sorted, warps.m_supervised, last_issued, limit );
+        order_greedy_then_oldest( walked, warps.m_age_ordered, last_issued, limit, stalled );
+        ready_warps(sorted, sorted_ready);
+        ready_warps(walked, walked_ready);
+        if ( sorted[0] != walked[0] || sorted_ready != walked_ready ) {
+            printf("ERROR ** %u warps, limit %u, cycle %u: greedy then oldest order differs from the sorted order\n",
+                   n_warps, limit, c );
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// time per order_warps() call of gto or warp_limiting with both orderings,
+// over the same random warp states
+static void time_orderings( const char *name, unsigned n_warps, unsigned limit, unsigned n_calls )
+{
+    typedef std::chrono::steady_clock bench_clock;
+    const unsigned n_states = 256;
+    std::vector<test_warps*> states;
+    std::vector<unsigned> last_issued;
+    for (unsigned s=0; s < n_states; s++) {
+        test_warps *warps = new test_warps(n_warps);
+        for (unsigned n = rand()%(8*n_warps); n > 0; n--)
+            warps->step();
+        states.push_back(warps);
+        last_issued.push_back(rand()%n_warps);
+    }
+
+    std::vector<test_warp*> result, stalled;
+    unsigned long long sum = 0;
+    bench_clock::time_point t0 = bench_clock::now();
+    for (unsigned i=0; i < n_calls; i++) {
+        test_warps *warps = states[i%n_states];
+        sorted_greedy_then_oldest( result, warps->m_supervised,
+                                   warps->m_supervised.begin() + last_issued[i%n_states], limit );
+        sum += result.size();
+    }
+    bench_clock::time_point t1 = bench_clock::now();
+    for (unsigned i=0; i < n_calls; i++) {
+        test_warps *warps = states[i%n_states];
+        order_greedy_then_oldest( result, warps->m_age_ordered,
+                                  warps->m_supervised.begin() + last_issued[i%n_states], limit,
+                                  stalled );
+        sum += result.size();
+    }
+    bench_clock::time_point t2 = bench_clock::now();
+
+    printf("%s, %u warps: sorted = %.1f ns, order_greedy_then_oldest = %.1f ns (checksum %llu)\n",
+           name, n_warps,
+           std::chrono::duration<double,std::nano>(t1 - t0).count() / n_calls,
+           std::chrono::duration<double,std::nano>(t2 - t1).count() / n_calls, sum );
+    for (unsigned s=0; s < n_states; s++)
+        delete states[s];
+}
+
+int main(int argc, char *argv[] )
+{
+    int errors_found=0;
+    unsigned n_calls = (argc > 1)? atoi(argv[1]) : 1000000;
+    srand(1);
+    // warps per scheduler of 1 to 4 schedulers on a 48 warp core
+    const unsigned n_warps[] = { 12, 24, 48 };
+    for (unsigned i=0; i < sizeof(n_warps)/sizeof(n_warps[0]); i++) {
+        unsigned n = n_warps[i];
+        // gto orders every warp, warp_limiting only the first few
+        const unsigned limits[] = { n, 1, 2, n/4, n/2 };
+        for (unsigned l=0; l < sizeof(limits)/sizeof(limits[0]); l++) {
+            for (unsigned trial=0; trial < 200; trial++)
+                errors_found |= check_orderings(n, limits[l], 200);
+        }
+
+        char name[64];
+        time_orderings("gto", n, n, n_calls);
+        snprintf(name, sizeof(name), "warp_limiting, limit %u", n/4);
+        time_orderings(name, n, n/4, n_calls);
+    }
+
+    if( errors_found ) {
+        printf("SUMMARY:  ERRORS FOUND\n");
+    } else {
+        printf("SUMMARY: UNIT TEST PASSED\n");
+    }
+    return errors_found;
+}
@@ -37,6 +37,7 @@
 #include "gpu-misc.h"
 #include "gpu-cache_gem5.h"
 #include "../cuda-sim/ptx_sim.h"
+#include "../cuda-sim/ptx_ir.h"
 #include "../cuda-sim/ptx-stats.h"
 #include "../cuda-sim/cuda-sim.h"
 #include "gpu-sim.h"
@@ -47,8 +48,10 @@
 #include "icnt_wrapper.h"
 #include <string.h>
 #include <limits.h>
+#include <algorithm>
 #include "traffic_breakdown.h"
 #include "shader_trace.h"
+#include "scheduler_order.h"
 
 #define PRIORITIZE_MSHR_OVER_WB 1
 #define MAX(a,b) (((a)>(b))?(a):(b))
@@ -349,6 +352,8 @@ void shader_core_ctx::init_warps( unsigned cta_id, unsigned start_thread, unsign
             m_simt_stack[i]->launch(start_pc,active_threads);
             m_warp[i].init(start_pc,cta_id,i,active_threads, m_dynamic_warp_id);
             ++m_dynamic_warp_id;
+            // warps are distributed over the schedulers as in the constructor
+            schedulers[i%m_config->gpgpu_num_sched_per_core]->warp_launched(&m_warp[i]);
             m_not_completed += n_active;
       }
    }
@@ -633,6 +638,9 @@ void shader_core_ctx::fetch()
                 }
                 if( did_exit ) 
                     m_warp[warp_id].set_done_exit();
+                if( m_warp[warp_id].get_trace() && m_config->gpgpu_warp_trace_mode == WARP_TRACE_CAPTURE )
+                    m_kernel->get_warp_trace()->warp_done( m_warp[warp_id].get_trace() );
+                m_warp[warp_id].set_trace(NULL);
             }
 
             // this code fetches instructions from the i-cache or generates memory requests
@@ -693,7 +701,24 @@ void shader_core_ctx::fetch()
 
 void shader_core_ctx::func_exec_inst( warp_inst_t &inst )
 {
+    warp_trace_stream *trace = m_warp[inst.warp_id()].get_trace();
+    if( trace && m_config->gpgpu_warp_trace_mode == WARP_TRACE_REPLAY ) {
+        replay_warp_inst(inst);
+        return;
+    }
+    if( trace )
+        m_trace_record.clear( inst.pc, inst.get_active_mask() );
     execute_warp_inst_t(inst);
+    if( trace ) {
+        // lane addresses, exits and atomics were recorded by checkExecutionStatusAndUpdate
+        m_trace_record.exec_mask = inst.get_active_mask();
+        if( inst.is_load() || inst.is_store() ) {
+            m_trace_record.is_mem = true;
+            m_trace_record.space = inst.space;
+            m_trace_record.data_size = inst.data_size;
+        }
+        trace->append(m_trace_record);
+    }
     if( (inst.is_load() || inst.is_store())){
         if(inst.space.get_type()==tex_space and m_config->gpgpu_debug_texture_accesses)
             printf("In cluster %d, core %d cta %llu\n",m_cluster->get_cluster_id(),m_sid,m_thread[inst.warp_id()*inst.warp_size()]->get_cta_uid());
@@ -701,6 +726,74 @@ void shader_core_ctx::func_exec_inst( warp_inst_t &inst )
     }
 }
 
+// intentionally empty: atomics are not performed when replaying a trace. It is
+// registered only so that has_callback() marks the lane as atomic, which keeps
+// the warp's m_n_atomic count and the do_atomic() round trip of the timing
+// model the same as in the captured run
+static void warp_trace_atomic_callback( const inst_t *inst, ptx_thread_info *thread )
+{
+}
+
+void shader_core_ctx::replay_warp_inst( warp_inst_t &inst )
+{
+    unsigned warp_id = inst.warp_id();
+    warp_trace_record &r = m_trace_record;
+    if( !m_warp[warp_id].get_trace()->next(r) || r.pc != inst.pc || r.issue_mask != inst.get_active_mask() ) {
+        printf("GPGPU-Sim uArch: ERROR ** warp trace does not match instruction issued by core %u warp %u (pc=0x%04x)\n",
+               m_sid, warp_id, inst.pc );
+        abort();
+    }
+    const ptx_instruction *pI = static_cast<const ptx_instruction*>(ptx_fetch_inst(inst.pc));
+    // store data is not traced; the memory system is only given the accesses
+    static const uint8_t no_data[MAX_DATA_BYTES_PER_INSN_PER_THREAD] = {0};
+    bool needs_data = false;
+    if( r.is_mem ) {
+        inst.space = r.space;
+        inst.data_size = r.data_size;
+        needs_data = inst.memory_op == memory_store &&
+            (r.space == global_space || r.space == const_space || r.space == local_space);
+    }
+    if( r.atomic_mask.any() )
+        inst.data_type = pI->get_type();
+    for( unsigned t=0; t < m_config->warp_size; t++ ) {
+        if( !r.issue_mask.test(t) )
+            continue;
+        unsigned tid = warp_id * m_config->warp_size + t;
+        if( !r.exec_mask.test(t) ) {
+            inst.set_not_active(t);
+        } else {
+            if( r.is_mem )
+                inst.set_addr(t, r.addrs[t], r.n_addrs[t]);
+            if( needs_data )
+                inst.set_data(t, no_data);
+            if( r.atomic_mask.test(t) )
+                inst.add_callback(t, warp_trace_atomic_callback, pI, m_thread[tid]);
+            if( r.done_mask.test(t) ) {
+                m_thread[tid]->set_done();
+                m_thread[tid]->exitCore();
+                m_thread[tid]->registerExit();
+            }
+        }
+        checkExecutionStatusAndUpdate(inst,t,tid);
+    }
+    if( r.exec_mask.any() )
+        m_gpu->gem5CudaGPU->getCudaCore(m_sid)->record_inst(pI->get_classification(), r.exec_mask.count());
+    if( inst.is_load() || inst.is_store() )
+        inst.generate_mem_accesses();
+}
+
+// With a replayed trace the threads' pcs are never advanced, so the SIMT
+// stack is pointed at the next recorded instruction instead of being updated
+// from the threads.  Reconvergence is implicit in the recorded issue masks.
+void shader_core_ctx::replay_simt_stack( unsigned warp_id, warp_inst_t &inst )
+{
+    const warp_trace_record *next = m_warp[warp_id].get_trace()->peek();
+    if( next )
+        m_simt_stack[warp_id]->launch(next->pc, next->issue_mask);
+    else
+        updateSIMTStack(warp_id,&inst); // every thread has exited
+}
+
 void shader_core_ctx::warp_reaches_barrier(warp_inst_t &inst) {
     m_barriers.warp_reaches_barrier(m_warp[inst.warp_id()].get_cta_id(), inst.warp_id());
 }
@@ -717,7 +810,10 @@ void shader_core_ctx::issue_warp( register_set& pipe_reg_set, const warp_inst_t*
     m_stats->shader_cycle_distro[2+(*pipe_reg)->active_count()]++;
     func_exec_inst( **pipe_reg );
 
-    updateSIMTStack(warp_id,*pipe_reg);
+    if( m_warp[warp_id].get_trace() && m_config->gpgpu_warp_trace_mode == WARP_TRACE_REPLAY )
+        replay_simt_stack(warp_id,**pipe_reg);
+    else
+        updateSIMTStack(warp_id,*pipe_reg);
     m_scoreboard->reserveRegisters(*pipe_reg);
     m_warp[warp_id].set_next_pc(next_inst->pc + next_inst->isize);
 }
@@ -825,6 +921,16 @@ void scheduler_unit::order_by_priority( std::vector< T >& result_list,
     }
 }
 
+void scheduler_unit::warp_launched( shd_warp_t *w )
+{
+    std::vector< shd_warp_t* >::iterator iter
+        = std::find( m_age_ordered_warps.begin(), m_age_ordered_warps.end(), w );
+    if ( iter != m_age_ordered_warps.end() ) {
+        m_age_ordered_warps.erase( iter );
+        m_age_ordered_warps.push_back( w );
+    }
+}
+
 void scheduler_unit::cycle()
 {
     SCHED_DPRINTF( "scheduler_unit::cycle()\n" );
@@ -965,35 +1071,29 @@ void scheduler_unit::do_on_warp_issued( unsigned warp_id,
 
 bool scheduler_unit::sort_warps_by_oldest_dynamic_id(shd_warp_t* lhs, shd_warp_t* rhs)
 {
-    if (rhs && lhs) {
-        if ( lhs->done_exit() || lhs->waiting() ) {
-            return false;
-        } else if ( rhs->done_exit() || rhs->waiting() ) {
-            return true;
-        } else {
-            return lhs->get_dynamic_warp_id() < rhs->get_dynamic_warp_id();
-        }
-    } else {
-        return lhs < rhs;
-    }
+    return warp_older_dynamic_id( lhs, rhs );
 }
 
 void lrr_scheduler::order_warps()
 {
+    // the rotation only depends on the last warp to issue
+    if ( !m_next_cycle_prioritized_warps.empty() && m_ordered_after == m_last_supervised_issued ) {
+        return;
+    }
     order_lrr( m_next_cycle_prioritized_warps,
                m_supervised_warps,
                m_last_supervised_issued,
                m_supervised_warps.size() );
+    m_ordered_after = m_last_supervised_issued;
 }
 
 void gto_scheduler::order_warps()
 {
-    order_by_priority( m_next_cycle_prioritized_warps,
-                       m_supervised_warps,
-                       m_last_supervised_issued,
-                       m_supervised_warps.size(),
-                       ORDERING_GREEDY_THEN_PRIORITY_FUNC,
-                       scheduler_unit::sort_warps_by_oldest_dynamic_id );
+    order_greedy_then_oldest( m_next_cycle_prioritized_warps,
+                              m_age_ordered_warps,
+                              m_last_supervised_issued,
+                              m_supervised_warps.size(),
+                              m_stalled_warps );
 }
 
 void
@@ -1003,12 +1103,11 @@ two_level_active_scheduler::do_on_warp_issued( unsigned warp_id,
 {
     scheduler_unit::do_on_warp_issued( warp_id, num_issued, prioritized_iter );
     if ( SCHEDULER_PRIORITIZATION_LRR == m_inner_level_prioritization ) {
-        std::vector< shd_warp_t* > new_active; 
-        order_lrr( new_active,
-                   m_next_cycle_prioritized_warps,
-                   prioritized_iter,
-                   m_next_cycle_prioritized_warps.size() );
-        m_next_cycle_prioritized_warps = new_active;
+        // same as order_lrr() after prioritized_iter, done in place so the
+        // iterator cycle() holds stays in the vector
+        std::vector< shd_warp_t* >::iterator first = m_next_cycle_prioritized_warps.begin();
+        std::rotate( first, first + ( prioritized_iter - m_next_cycle_prioritized_warps.begin() ) + 1,
+                     m_next_cycle_prioritized_warps.end() );
     } else {
         fprintf( stderr,
                  "Unimplemented m_inner_level_prioritization: %d\n",
@@ -1090,12 +1189,11 @@ swl_scheduler::swl_scheduler ( shader_core_stats* stats, shader_core_ctx* shader
 void swl_scheduler::order_warps()
 {
     if ( SCHEDULER_PRIORITIZATION_GTO == m_prioritization ) {
-        order_by_priority( m_next_cycle_prioritized_warps,
-                           m_supervised_warps,
-                           m_last_supervised_issued,
-                           MIN( m_num_warps_to_limit, m_supervised_warps.size() ),
-                           ORDERING_GREEDY_THEN_PRIORITY_FUNC,
-                           scheduler_unit::sort_warps_by_oldest_dynamic_id );
+        order_greedy_then_oldest( m_next_cycle_prioritized_warps,
+                                  m_age_ordered_warps,
+                                  m_last_supervised_issued,
+                                  MIN( m_num_warps_to_limit, m_supervised_warps.size() ),
+                                  m_stalled_warps );
     } else {
         fprintf(stderr, "swl_scheduler m_prioritization = %d\n", m_prioritization);
         abort();
@@ -1264,6 +1362,7 @@ void shader_core_ctx::warp_inst_complete(const warp_inst_t &inst)
 
   m_stats->m_num_sim_winsn[m_sid]++;
   m_gpu->gpu_sim_insn += inst.active_count();
+  m_cta_insn[m_warp[inst.warp_id()].get_cta_id()] += inst.active_count();
   inst.completed(gpu_tot_sim_cycle + gpu_sim_cycle);
 }
 
@@ -2112,6 +2211,8 @@ void shader_core_ctx::register_cta_thread_exit( unsigned cta_num )
       m_n_active_cta--;
       m_barriers.deallocate_barrier(cta_num);
       shader_CTA_count_unlog(m_sid, 1);
+      if( cta_sampler *sampler = m_kernel->get_cta_sampler() )
+          sampler->detailed_cta_done( gpu_sim_cycle - m_cta_start_cycle[cta_num], m_cta_insn[cta_num] );
 //      printf("GPGPU-Sim uArch: Shader %d finished CTA #%d (%lld,%lld), %u CTAs running\n", m_sid, cta_num, gpu_sim_cycle, gpu_tot_sim_cycle,
 //             m_n_active_cta );
       m_gpu->gem5CudaGPU->getCudaCore(m_sid)->record_block_commit(cta_num);
@@ -3407,6 +3508,8 @@ unsigned simt_core_cluster::issue_block2core()
             }
         }
         kernel_info_t *kernel = m_core[core]->get_kernel();
+        if( kernel )
+            m_gpu->run_unsampled_ctas( *kernel, m_core[core]->get_sid() );
         if( kernel && !kernel->no_more_ctas_to_run() 
               && kernel->canGetNextGraphicsBlock(m_core[core]->get_sid())
               && (m_core[core]->get_n_active_cta() < m_config->max_cta(*kernel)) ) {
@@ -3615,6 +3718,19 @@ void simt_core_cluster::get_L1T_sub_stats(struct cache_sub_stats &css) const{
 
 void shader_core_ctx::checkExecutionStatusAndUpdate(warp_inst_t &inst, unsigned t, unsigned tid)
 {
+    if( m_config->gpgpu_warp_trace_mode == WARP_TRACE_CAPTURE && m_warp[inst.warp_id()].get_trace() ) {
+        // capture the lane before local addresses are translated for this core
+        if( inst.active(t) && (inst.is_load() || inst.is_store()) ) {
+            unsigned n = inst.get_mem_reqs_count(t);
+            m_trace_record.n_addrs[t] = n;
+            for( unsigned a=0; a < n; a++ )
+                m_trace_record.addrs[t][a] = inst.get_addr(t,a);
+        }
+        if( inst.has_callback(t) )
+            m_trace_record.atomic_mask.set(t);
+        if( ptx_thread_done(tid) )
+            m_trace_record.done_mask.set(t);
+    }
     if(inst.has_callback(t))
            m_warp[inst.warp_id()].inc_n_atomic();
         if (inst.space.is_local() && (inst.is_load() || inst.is_store())) {
@@ -54,6 +54,7 @@
 #include "gpu-cache.h"
 #include "traffic_breakdown.h"
 #include "graphics_models.h"
+#include "warp_trace.h"
 
 
 
@@ -109,6 +110,7 @@ public:
         m_done_exit=true;
         m_last_fetch=0;
         m_next=0;
+        m_trace=NULL;
     }
     void init( address_type start_pc,
                unsigned cta_id,
@@ -214,6 +216,9 @@ public:
     unsigned get_dynamic_warp_id() const { return m_dynamic_warp_id; }
     unsigned get_warp_id() const { return m_warp_id; }
 
+    warp_trace_stream *get_trace() const { return m_trace; }
+    void set_trace( warp_trace_stream *trace ) { m_trace = trace; }
+
 private:
     // Max number of instructions that can be fetched concurrently per-warp
     static const unsigned IBUFFER_SIZE= 64;
@@ -247,6 +252,8 @@ private:
 
     unsigned m_stores_outstanding; // number of store requests sent but not yet acknowledged
     unsigned m_inst_in_pipeline;
+
+    warp_trace_stream *m_trace; // records captured or replayed for this warp (NULL if not tracing)
 };
 
 
@@ -300,10 +307,13 @@ public:
     virtual ~scheduler_unit(){}
     virtual void add_supervised_warp_id(int i) {
         m_supervised_warps.push_back(&warp(i));
+        m_age_ordered_warps.push_back(&warp(i));
     }
     virtual void done_adding_supervised_warps() {
         m_last_supervised_issued = m_supervised_warps.end();
     }
+    // A supervised warp was launched, its dynamic warp id is the youngest
+    void warp_launched( shd_warp_t *w );
 
 
     // The core scheduler cycle method is meant to be common between
@@ -360,6 +370,12 @@ protected:
     std::vector< shd_warp_t* > m_supervised_warps;
     // This is the iterator pointer to the last supervised warp you issued
     std::vector< shd_warp_t* >::const_iterator m_last_supervised_issued;
+    // m_supervised_warps from the oldest to the youngest dynamic warp id.
+    // Dynamic ids only grow, so warp_launched() keeps this ordered by moving
+    // the warp to the back.
+    std::vector< shd_warp_t* > m_age_ordered_warps;
+    // scratch list of order_greedy_then_oldest() (scheduler_order.h)
+    std::vector< shd_warp_t* > m_stalled_warps;
     shader_core_stats *m_stats;
     shader_core_ctx* m_shader;
     // these things should become accessors: but would need a bigger rearchitect of how shader_core_ctx interacts with its parts.
@@ -388,7 +404,13 @@ public:
 	virtual void order_warps ();
     virtual void done_adding_supervised_warps() {
         m_last_supervised_issued = m_supervised_warps.end();
+        m_ordered_after = m_supervised_warps.end();
     }
+
+private:
+    // m_last_supervised_issued the current m_next_cycle_prioritized_warps
+    // rotation was built for, it only changes when a warp issues
+    std::vector< shd_warp_t* >::const_iterator m_ordered_after;
 };
 
 class gto_scheduler : public scheduler_unit {
@@ -1268,6 +1290,10 @@ struct shader_core_config : public core_config
         gpgpu_cache_texl1_linesize = m_L1T_config.get_line_sz();
         gpgpu_cache_constl1_linesize = m_L1C_config.get_line_sz();
         gpgpu_cache_datal1_linesize = m_L1D_config.get_line_sz();
+        if (gpgpu_warp_trace_mode > WARP_TRACE_REPLAY) {
+           printf("GPGPU-Sim uArch: Error ** invalid -gpgpu_warp_trace_mode %u\n", gpgpu_warp_trace_mode);
+           abort();
+        }
         m_valid = true;
     }
     void reg_options(class OptionParser * opp );
@@ -1346,6 +1372,10 @@ struct shader_core_config : public core_config
 
     unsigned gpgpu_fetch_decode_width;
 
+    // warp instruction traces (see warp_trace.h)
+    unsigned gpgpu_warp_trace_mode;
+    char *gpgpu_warp_trace_file;
+
     unsigned mem2device(unsigned memid) const { return memid + n_simt_clusters; }
 };
 
@@ -1796,6 +1826,8 @@ public:
     friend class LooseRoundRobbinScheduler;
     void issue_warp( register_set& warp, const warp_inst_t *pI, const active_mask_t &active_mask, unsigned warp_id );
     void func_exec_inst( warp_inst_t &inst );
+    void replay_warp_inst( warp_inst_t &inst );
+    void replay_simt_stack( unsigned warp_id, warp_inst_t &inst );
 
      // Returns numbers of addresses in translated_addrs
     unsigned translate_local_memaddr( address_type localaddr, unsigned tid, unsigned num_shader, unsigned datasize, new_addr_type* translated_addrs );
@@ -1825,6 +1857,8 @@ public:
     // CTA scheduling / hardware thread allocation
     unsigned m_n_active_cta; // number of Cooperative Thread Arrays (blocks) currently running on this shader.
     unsigned m_cta_status[MAX_CTA_PER_SHADER]; // CTAs status 
+    unsigned long long m_cta_start_cycle[MAX_CTA_PER_SHADER]; // cycle each CTA was issued
+    unsigned long long m_cta_insn[MAX_CTA_PER_SHADER]; // thread instructions committed by each CTA
     unsigned m_not_completed; // number of threads to be completed (==0 when all thread on this core completed) 
     std::bitset<MAX_THREAD_PER_SM> m_active_threads;
     
@@ -1841,6 +1875,7 @@ public:
 
     // decode/dispatch
     std::vector<shd_warp_t>   m_warp;   // per warp information array
+    warp_trace_record         m_trace_record; // instruction being captured or replayed
     barrier_set_t             m_barriers;
     ifetch_buffer_t           m_inst_fetch_buffer;
     std::vector<register_set> m_pipeline_reg;
@@ -1921,6 +1956,8 @@ public:
 
     void core_cycle();
     void icnt_cycle();
+    // icnt_cycle() has nothing to hand to the cores
+    bool response_fifo_empty() const { return m_response_fifo.empty(); }
     
 
     void reinit();
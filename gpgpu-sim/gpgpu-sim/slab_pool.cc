@@ -0,0 +1,80 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "slab_pool.h"
+
+#include <stdlib.h>
+
+// slabs are about this large, unless a single block is larger
+static const size_t SLAB_POOL_SLAB_BYTES = 64 * 1024;
+
+static std::vector<slab_pool*> &all_pools()
+{
+   static std::vector<slab_pool*> *pools = new std::vector<slab_pool*>();
+   return *pools;
+}
+
+slab_pool::slab_pool( const char *name, size_t block_size )
+{
+   m_name = name;
+   m_block_size = block_size;
+   m_stride = block_size < sizeof(free_block)? sizeof(free_block) : block_size;
+   m_stride = (m_stride + sizeof(free_block) - 1) / sizeof(free_block) * sizeof(free_block);
+   unsigned n = SLAB_POOL_SLAB_BYTES / m_stride;
+   m_slab_size = (n? n : 1) * m_stride;
+   m_free = NULL;
+   m_live = 0;
+   m_peak = 0;
+   all_pools().push_back(this);
+}
+
+void slab_pool::grow()
+{
+   char *slab = (char*)malloc(m_slab_size);
+   if( slab == NULL ) {
+      printf("GPGPU-Sim uArch: ERROR ** out of memory growing the %s slab pool\n", m_name.c_str());
+      abort();
+   }
+   m_slabs.push_back(slab);
+   // thread the new blocks onto the free list in address order
+   for( size_t off = m_slab_size; off >= m_stride; off -= m_stride ) {
+      free_block *b = (free_block*)(slab + off - m_stride);
+      b->next = m_free;
+      m_free = b;
+   }
+}
+
+void slab_pool::print_all( FILE *fp )
+{
+   std::vector<slab_pool*> &pools = all_pools();
+   for( unsigned i=0; i < pools.size(); i++ ) {
+      const slab_pool *p = pools[i];
+      fprintf(fp, "slab_pool %s: live = %llu, peak = %llu, slab_bytes = %llu\n",
+              p->m_name.c_str(), p->m_live, p->m_peak, p->slab_bytes());
+   }
+}
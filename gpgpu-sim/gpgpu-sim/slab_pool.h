@@ -0,0 +1,95 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SLAB_POOL_H
+#define SLAB_POOL_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Free-list allocator for the objects the timing model creates and destroys
+// on every memory request (mem_fetch).  Fixed size blocks are carved out of
+// large slabs and recycled through a free list, so once the pool has warmed
+// up an allocation is a couple of pointer moves.  Slabs are never given back
+// to the heap.  The live count of a pool is the number of blocks handed out
+// and not yet freed; at the end of a kernel a live count that keeps growing
+// from kernel to kernel points at a leak.  Not thread safe: only objects that
+// the timing model alone creates and frees may come from a pool, never ones
+// the functional simulation workers copy or resize (warp_inst_t storage).
+class slab_pool {
+public:
+   slab_pool( const char *name, size_t block_size );
+
+   void *alloc()
+   {
+      if( m_free == NULL )
+         grow();
+      free_block *b = m_free;
+      m_free = b->next;
+      if( ++m_live > m_peak )
+         m_peak = m_live;
+      return b;
+   }
+   void free( void *p )
+   {
+      if( p == NULL )
+         return;
+      free_block *b = (free_block*)p;
+      b->next = m_free;
+      m_free = b;
+      m_live--;
+   }
+
+   const std::string &name() const { return m_name; }
+   size_t block_size() const { return m_block_size; }
+   unsigned long long live() const { return m_live; }
+   unsigned long long peak() const { return m_peak; }
+   unsigned long long slab_bytes() const { return (unsigned long long)m_slabs.size() * m_slab_size; }
+
+   // live and peak block counts of every pool created so far
+   static void print_all( FILE *fp );
+
+private:
+   struct free_block {
+      free_block *next;
+   };
+
+   void grow();
+
+   std::string m_name;
+   size_t m_block_size;
+   size_t m_stride;     // block size rounded up to hold a free_block
+   size_t m_slab_size;
+   free_block *m_free;
+   std::vector<char*> m_slabs;
+   unsigned long long m_live;
+   unsigned long long m_peak;
+};
+
+#endif
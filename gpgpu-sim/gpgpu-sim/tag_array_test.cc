@@ -0,0 +1,175 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Checks tag_array::probe(), which scans the packed tag and time arrays,
+// against the cache_block_t records get_block() returns, and measures probe
+// throughput.  Usage: tag_array_test [probes to time]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+#include "gpu-cache.h"
+
+// What probe() has to return, read off the line records: the first way
+// holding the tag that is not invalid hits, else the last invalid way, else
+// the valid way with the oldest access (LRU) or allocation (FIFO) time.  A set
+// with only reserved ways fails the reservation.
+static enum cache_request_status expected_probe( const tag_array &tags, const cache_config &config,
+                                                 unsigned assoc, bool fifo,
+                                                 new_addr_type addr, unsigned &idx )
+{
+    unsigned first = config.set_index(addr) * assoc;
+    new_addr_type tag = config.tag(addr);
+    for (unsigned i=first; i < first+assoc; i++) {
+        const cache_block_t &line = tags.get_block(i);
+        if ( line.m_tag == tag && line.m_status != INVALID ) {
+            idx = i;
+            return (line.m_status == RESERVED)? HIT_RESERVED : HIT;
+        }
+    }
+    unsigned invalid_line = (unsigned)-1;
+    unsigned valid_line = (unsigned)-1;
+    unsigned valid_time = 0;
+    for (unsigned i=first; i < first+assoc; i++) {
+        const cache_block_t &line = tags.get_block(i);
+        if ( line.m_status == INVALID ) {
+            invalid_line = i;
+        } else if ( line.m_status != RESERVED ) {
+            unsigned t = fifo? line.m_alloc_time : line.m_last_access_time;
+            if ( valid_line == (unsigned)-1 || t < valid_time ) {
+                valid_line = i;
+                valid_time = t;
+            }
+        }
+    }
+    if ( invalid_line == (unsigned)-1 && valid_line == (unsigned)-1 )
+        return RESERVATION_FAIL;
+    idx = (invalid_line != (unsigned)-1)? invalid_line : valid_line;
+    return MISS;
+}
+
+// drives a tag array through random accesses, fills, state changes and
+// flushes, checking probe() before every access
+static int check_probe( tag_array &tags, const cache_config &config, unsigned assoc, bool fifo,
+                        unsigned n_blocks, unsigned line_sz, unsigned n_iter )
+{
+    unsigned time=0;
+    for (unsigned i=0; i < n_iter; i++) {
+        time += rand()%3;
+        new_addr_type addr = (new_addr_type)(rand()%n_blocks) * line_sz + rand()%line_sz;
+        unsigned idx=0, expected_idx=0;
+        enum cache_request_status status = tags.probe(addr,idx);
+        enum cache_request_status expected = expected_probe(tags,config,assoc,fifo,addr,expected_idx);
+        if ( status != expected || (status != RESERVATION_FAIL && idx != expected_idx) ) {
+            printf("ERROR ** probe(0x%llx) = %d @ %u, expected %d @ %u\n", addr,
+                   status, idx, expected, expected_idx );
+            return 1;
+        }
+
+        bool wb=false;
+        cache_block_t evicted;
+        tags.access(addr,time,idx,wb,evicted);
+
+        unsigned line = rand()%tags.size();
+        if ( tags.get_block(line).m_status == RESERVED && rand()%2 )
+            tags.fill(line,time);
+        if ( rand()%16 == 0 ) {
+            line = rand()%tags.size();
+            if ( tags.get_block(line).m_status == VALID )
+                tags.set_status(line, MODIFIED);
+            else if ( tags.get_block(line).m_status != RESERVED )
+                tags.set_status(line, INVALID);
+        }
+        if ( rand()%100000 == 0 )
+            tags.flush();
+    }
+    return 0;
+}
+
+// probes per second over a warmed up tag array
+static void time_probe( const tag_array &tags, unsigned n_blocks, unsigned line_sz, unsigned n_probes )
+{
+    typedef std::chrono::steady_clock bench_clock;
+    const unsigned n_addr = 64*1024;
+    std::vector<new_addr_type> addrs(n_addr);
+    for (unsigned i=0; i < n_addr; i++)
+        addrs[i] = (new_addr_type)(rand()%n_blocks) * line_sz;
+
+    unsigned long long sum=0;
+    unsigned idx=0;
+    bench_clock::time_point t0 = bench_clock::now();
+    for (unsigned i=0; i < n_probes; i++) {
+        sum += tags.probe(addrs[i%n_addr],idx);
+        sum += idx;
+    }
+    bench_clock::time_point t1 = bench_clock::now();
+    printf("   probe = %.1f Mprobes/s (checksum %llu)\n",
+           n_probes / std::chrono::duration<double>(t1 - t0).count() / 1e6, sum );
+}
+
+int main(int argc, char *argv[] )
+{
+    int errors_found=0;
+    // L1-like, L2-like and direct mapped sets, LRU and FIFO each
+    const char *configs[] = {
+        "32:128:4,L:B:m:W:L,A:32:8,8",
+        "32:128:4,F:B:m:W:L,A:32:8,8",
+        "64:128:16,L:B:m:W:L,A:32:8,8",
+        "64:128:16,F:B:m:W:L,A:32:8,8",
+        "16:64:1,L:B:m:W:L,A:32:8,8",
+        // more tags than the host caches hold, as across all caches of a GPU
+        "4096:128:16,L:B:m:W:L,A:32:8,8",
+    };
+    unsigned n_probes = (argc > 1)? atoi(argv[1]) : 20000000;
+    srand(1);
+    for (unsigned c=0; c < sizeof(configs)/sizeof(configs[0]); c++) {
+        char config_string[64];
+        snprintf(config_string, sizeof(config_string), "%s", configs[c]);
+        unsigned nset, line_sz, assoc;
+        char rp;
+        sscanf(config_string, "%u:%u:%u,%c", &nset, &line_sz, &assoc, &rp);
+        cache_config config;
+        config.init(config_string, FuncCachePreferNone);
+
+        // three times as many blocks as lines, so sets keep missing and evicting
+        unsigned n_blocks = 3*nset*assoc;
+        tag_array tags(config, 0, 0);
+        errors_found |= check_probe(tags, config, assoc, rp == 'F', n_blocks, line_sz, 2000000);
+
+        printf("%s:\n", configs[c]);
+        time_probe(tags, n_blocks, line_sz, n_probes);
+    }
+
+    if( errors_found ) {
+        printf("SUMMARY:  ERRORS FOUND\n");
+    } else {
+        printf("SUMMARY: UNIT TEST PASSED\n");
+    }
+    return errors_found;
+}
@@ -0,0 +1,425 @@
+// Copyright (c) 2018, Ayub A. Gubran, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef TC_ENGINE_H
+#define TC_ENGINE_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include "graphics/mesa_gpgpusim.h"
+
+//hands a coalesced tile to the fragment shading stage
+typedef void (*tc_launch_t)(unsigned cluster_id, tcTilePtr_t tile,
+      unsigned done_prims);
+
+class tc_engine_t {
+   static unsigned tc_engine_id_count;
+   unsigned m_tc_engine_id;
+
+   //input bins are compacted in arrival order, each bin has a mask of the
+   //quads of its tile that still have alive fragments
+   struct tc_bin_t {
+      tc_bin_t(): tile(NULL), done(false)
+      {}
+      RasterTile* tile;
+      bool done;
+   };
+
+   public:
+   tc_engine_t(unsigned tc_bins,
+         unsigned tc_tile_h, unsigned tc_tile_w,
+         unsigned r_tile_h, unsigned r_tile_w, 
+         unsigned wait_threshold, unsigned cluster_id,
+         tc_launch_t launch): 
+      m_launch(launch),
+      m_cluster_id(cluster_id),
+      m_tc_tile_h(tc_tile_h), m_tc_tile_w(tc_tile_w),
+      m_r_tile_h(r_tile_h), m_r_tile_w(r_tile_w),
+      m_r_tile_size(r_tile_h*r_tile_w),
+      m_r_tile_quads(m_r_tile_size/QUAD_SIZE),
+      m_quad_words((m_r_tile_quads + 63)/64),
+      m_wait_threshold(wait_threshold),
+      m_tc_bins_max(tc_bins)
+   {
+      m_tc_engine_id=tc_engine_id_count++;
+      //raster tiles should be made out of quads
+      assert(m_r_tile_h%2 == 0 and m_r_tile_w%2 == 0);
+      assert(m_tc_bins_max > 0);
+      //tc engine coalesced tiles, laid out tile, quad, fragment
+      m_afragments.resize(tc_tile_h*tc_tile_w*m_r_tile_size, NULL);
+      m_covered_quads.resize(tc_tile_h*tc_tile_w*m_quad_words, 0);
+      m_bins.resize(m_tc_bins_max);
+      m_live_quads.resize(m_tc_bins_max*m_quad_words, 0);
+      m_bins_count = 0;
+      m_status.reset();
+
+      m_total_bin_size = 0;
+   }
+
+   ~tc_engine_t(){
+      for(unsigned t=0; t<m_pending_tiles.size(); t++)
+         delete m_pending_tiles[t];
+      for(unsigned t=0; t<m_free_tiles.size(); t++)
+         delete m_free_tiles[t];
+   }
+
+   void set_current_coords(unsigned x, unsigned y){
+      //only possible to (re)assign empty tiles
+      assert(m_bins_count == 0);
+      x = x - x%(m_tc_tile_w*m_r_tile_w);
+      y = y - y%(m_tc_tile_h*m_r_tile_h);
+      m_status.rtile_xstart = x;
+      m_status.rtile_xend = x + m_tc_tile_w*m_r_tile_w - 1;
+      m_status.rtile_ystart = y;
+      m_status.rtile_yend = y + m_tc_tile_h*m_r_tile_h - 1;
+      /*printf("setting tc%d tile coords (%d,%d) to (%d,%d)\n", 
+            m_tc_engine_id,
+            m_status.rtile_xstart,
+            m_status.rtile_ystart ,
+            m_status.rtile_xend,
+            m_status.rtile_yend);*/
+   }
+
+   //check if raster tile is mapped to this bin
+   bool has_tile(unsigned x, unsigned y){
+      if(empty()) return false;
+      if(       x >= m_status.rtile_xstart 
+            and x <= m_status.rtile_xend
+            and y >= m_status.rtile_ystart
+            and y <= m_status.rtile_yend)
+         return true;
+      return false;
+   }
+
+   bool empty(){
+      if(m_bins_count == 0 
+            and m_status.pending_frags==0)
+         return true;
+      return false;
+   }
+
+
+   bool append_tile(RasterTile* tile){
+      assert(has_tile(tile->xCoord, tile->yCoord));
+      if(m_bins_count < m_tc_bins_max){
+         push_bin(tile);
+         return true;
+      }
+      m_status.pending_flush = true;
+      return false;
+   }
+
+   bool insert_first_tile(RasterTile* tile){
+      if(empty()){
+         m_status.reset();
+         set_current_coords(tile->xCoord, tile->yCoord);
+         push_bin(tile);
+         return true;
+      }
+      return false;
+   }
+
+   void flush(){
+      if(m_status.pending_frags == 0)
+         return;
+      m_status.waiting_cycles++;
+      //recycle shaded tiles, a tile still in flight on the current
+      //coords blocks the flush
+      bool blocked = false;
+      for(unsigned t=0; t<m_pending_tiles.size();){
+         tcTilePtr_t pending = m_pending_tiles[t];
+         if(pending->done){
+            m_free_tiles.push_back(pending);
+            m_pending_tiles[t] = m_pending_tiles.back();
+            m_pending_tiles.pop_back();
+            continue;
+         }
+         if(pending->x == m_status.rtile_xstart 
+               and pending->y == m_status.rtile_ystart)
+            blocked = true;
+         t++;
+      }
+      if(blocked) return;
+      if(m_status.pending_flush or
+            (m_status.waiting_cycles > m_wait_threshold) or 
+            (!m_status.new_quad_added 
+             and (m_bins_count == m_tc_bins_max))){
+         tcTilePtr_t tc_tile = 
+            alloc_tile(m_status.rtile_xstart, m_status.rtile_ystart);
+         tc_tile->assign(m_afragments.data(), m_afragments.size());
+         //only covered quads hold fragments
+         for(unsigned tileId=0; tileId<m_tc_tile_h*m_tc_tile_w; tileId++){
+            uint64_t* covered = &m_covered_quads[tileId*m_quad_words];
+            for(unsigned w=0; w<m_quad_words; w++){
+               while(covered[w]){
+                  unsigned quadId = w*64 + __builtin_ctzll(covered[w]);
+                  covered[w] &= covered[w] - 1;
+                  std::fill_n(&m_afragments[
+                        (tileId*m_r_tile_quads + quadId)*QUAD_SIZE],
+                        QUAD_SIZE, (RasterTile::rasterFragment_t*) NULL);
+               }
+            }
+         }
+         tc_tile->skipDepthTest = m_status.skip_depth_test;
+         m_pending_tiles.push_back(tc_tile);
+         m_launch(m_cluster_id, tc_tile, m_status.done_prims);
+         //reset if no tiles left
+         if(m_bins_count == 0)
+            m_status.reset();
+      }
+   }
+   void assemble(){
+      //check 1 tile per cycle, may make it configurable later
+      m_status.new_quad_added = false;
+      bool tiles_done = false;
+      for(unsigned b=0; b<m_bins_count; b++){
+         RasterTile* rtile = m_bins[b].tile;
+         unsigned tc_x = rtile->xCoord%m_tc_tile_w;
+         unsigned tc_y = rtile->yCoord%m_tc_tile_h;
+         unsigned dstTileId = tc_x*m_tc_tile_w + tc_y;
+         uint64_t* covered = &m_covered_quads[dstTileId*m_quad_words];
+         uint64_t* live = &m_live_quads[b*m_quad_words];
+         for(unsigned w=0; w<m_quad_words; w++){
+            //quads with live fragments that are not covered yet
+            uint64_t take = live[w] & ~covered[w];
+            if(take == 0)
+               continue;
+            covered[w] |= take;
+            live[w] &= ~take;
+            m_status.new_quad_added = true;
+            m_status.skip_depth_test = 
+               m_status.skip_depth_test and rtile->skipFineDepth();
+            while(take){
+               unsigned quadId = w*64 + __builtin_ctzll(take);
+               take &= take - 1;
+               RasterTile::rasterFragment_t** dst = &m_afragments[
+                  (dstTileId*m_r_tile_quads + quadId)*QUAD_SIZE];
+               for(unsigned fragId=0; fragId<QUAD_SIZE; fragId++){
+                  RasterTile::rasterFragment_t* frag = 
+                     &(rtile->getRasterFragment(quadId, fragId));
+                  dst[fragId] = frag;
+                  if(frag->alive){
+                     frag->alive = false;
+                     if(rtile->decActiveCount() == 0){
+                        m_bins[b].done = true;
+                        tiles_done = true;
+                     }
+                  }
+               }
+               m_status.pending_frags+= QUAD_SIZE;
+            }
+         }
+      }
+
+      if(tiles_done){
+         //drop consumed tiles, keeping the arrival order of the rest
+         unsigned kept = 0;
+         for(unsigned b=0; b<m_bins_count; b++){
+            if(m_bins[b].done){
+               if(m_bins[b].tile->lastPrimTile){
+                  m_status.done_prims++;
+               }
+               continue;
+            }
+            if(kept != b){
+               m_bins[kept] = m_bins[b];
+               std::copy_n(&m_live_quads[b*m_quad_words], m_quad_words,
+                     &m_live_quads[kept*m_quad_words]);
+            }
+            kept++;
+         }
+         m_bins_count = kept;
+      }
+   }
+   void cycle(){
+      flush();
+      assemble();
+      m_total_bin_size+= m_bins_count;
+   }
+
+   //performance counters
+   unsigned m_total_bin_size;
+
+   private:
+   tc_engine_t& operator=(const tc_engine_t&) = delete;
+
+   void push_bin(RasterTile* tile){
+      assert(m_bins_count < m_tc_bins_max);
+      uint64_t* live = &m_live_quads[m_bins_count*m_quad_words];
+      m_bins[m_bins_count].tile = tile;
+      m_bins[m_bins_count].done = false;
+      m_bins_count++;
+      std::fill_n(live, m_quad_words, 0);
+      for(unsigned quadId=0; quadId<m_r_tile_quads; quadId++){
+         for(unsigned fragId=0; fragId<QUAD_SIZE; fragId++){
+            if(tile->getRasterFragment(quadId, fragId).alive){
+               live[quadId/64] |= (1ULL << (quadId%64));
+               break;
+            }
+         }
+      }
+   }
+
+   tcTilePtr_t alloc_tile(unsigned x, unsigned y){
+      if(m_free_tiles.empty())
+         return new tcTile_t(x, y);
+      tcTilePtr_t tile = m_free_tiles.back();
+      m_free_tiles.pop_back();
+      tile->reset(x, y);
+      return tile;
+   }
+
+   //flat tiles, quads, fragments
+   std::vector<RasterTile::rasterFragment_t*> m_afragments;
+   //one bit per quad of each raster tile in the tc tile
+   std::vector<uint64_t> m_covered_quads;
+   //fixed number of input bins, sized by m_tc_bins_max
+   std::vector<tc_bin_t> m_bins;
+   std::vector<uint64_t> m_live_quads;
+   unsigned m_bins_count;
+   tc_launch_t m_launch;
+   unsigned m_cluster_id;
+   //tc tile size in raster tiles
+   const unsigned m_tc_tile_h;
+   const unsigned m_tc_tile_w;
+   //raster tile size in fragments
+   const unsigned m_r_tile_h;
+   const unsigned m_r_tile_w;
+   const unsigned m_r_tile_size;
+   const unsigned m_r_tile_quads;
+   const unsigned m_quad_words;
+   //tiles in flight, this enforces atomic execution of tiles on the same 
+   //screen space coord, it performs a similar job to what Nvidia calls 
+   //"ticket dispenser"
+   std::vector<tcTilePtr_t> m_pending_tiles;
+   //shaded tiles kept for reuse
+   std::vector<tcTilePtr_t> m_free_tiles;
+
+   struct status_t {
+      bool pending_flush;
+      unsigned pending_frags;
+      unsigned waiting_cycles;
+      unsigned done_prims;
+      //the current tile coord will range 
+      //from (rx_coord, ry_coord) to (rx_coord + m_tc_tile_w, ry_coord + m_tc_tile_h)
+      unsigned rtile_xstart; 
+      unsigned rtile_xend;
+      unsigned rtile_ystart;
+      unsigned rtile_yend;
+      bool skip_depth_test;
+      bool new_quad_added;
+      void reset(){
+         pending_flush=false;
+         pending_frags=0;
+         waiting_cycles=0;
+         done_prims=0;
+         rtile_xstart=-1;
+         rtile_xend=-1;
+         rtile_ystart=-1;
+         rtile_yend=-1;
+         skip_depth_test=true;
+         new_quad_added=false;
+      }
+   };
+   const unsigned m_wait_threshold;
+   const unsigned m_tc_bins_max;
+   public:
+   status_t m_status;
+};
+
+class tile_assembly_stage_t {
+   public:
+   tile_assembly_stage_t(unsigned _tc_engines, unsigned _tc_bins, 
+         unsigned tc_tile_h, unsigned tc_tile_w,
+         unsigned r_tile_h, unsigned r_tile_w,
+         unsigned wait_threshold, unsigned cluster_id,
+         tc_launch_t launch): 
+      m_tc_engines(_tc_engines, tc_engine_t(_tc_bins, tc_tile_h, tc_tile_w, 
+               r_tile_h, r_tile_w, wait_threshold, cluster_id, launch))
+   {}
+
+   bool insert(RasterTile* tile){
+      for(unsigned i=0; i<m_tc_engines.size(); i++){
+         //printf("checking tc_engine %d\n", i);
+         if(m_tc_engines[i].has_tile(tile->xCoord, tile->yCoord)){
+            /*printf("tc_engine %d has tile (%d,%d)\n", 
+                  i, tile->xCoord, tile->yCoord);*/
+            if(m_tc_engines[i].append_tile(tile)){
+               /*printf("appending tile(%d,%d) to engine %d)\n", 
+                     tile->xCoord, tile->yCoord, i);*/
+               return true;
+            }
+            //tc engine has the tile but full
+            return false;
+         }
+      }
+      for(unsigned i=0; i<m_tc_engines.size(); i++){
+         if(m_tc_engines[i].insert_first_tile(tile)){
+            /*printf("inserting tile(%d,%d) to engine %d)\n", 
+                  tile->xCoord, tile->yCoord, i);*/
+            return true;
+         }
+      }
+
+      unsigned maxWaitCycles = 0;
+      unsigned maxWaitIndex = 0;
+      for(unsigned i=0; i<m_tc_engines.size(); i++){
+         if(m_tc_engines[i].m_status.waiting_cycles > maxWaitCycles)
+            maxWaitIndex = i;
+      }
+      m_tc_engines[maxWaitIndex].m_status.pending_flush = true;
+      return false;
+   }
+
+   bool empty(){
+      bool is_empty = true;
+      for(unsigned te=0; te<m_tc_engines.size(); te++){
+         is_empty = is_empty and m_tc_engines[te].empty();
+      }
+      return is_empty;
+   }
+
+   void cycle(){
+      for(unsigned te=0; te<m_tc_engines.size(); te++){
+         m_tc_engines[te].cycle();
+      }
+   }
+
+   double get_bin_occupancy(){
+      double total = 0;
+      for(unsigned te=0; te<m_tc_engines.size(); te++)
+         total+=m_tc_engines[te].m_total_bin_size;
+      return total/m_tc_engines.size();
+   }
+
+   private:
+   std::vector<tc_engine_t> m_tc_engines;
+};
+
+#endif /* TC_ENGINE_H */
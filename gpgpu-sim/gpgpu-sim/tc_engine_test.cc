@@ -0,0 +1,194 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Drives tile_assembly_stage_t, the per-cluster tile coalescing engines, with
+// randomized raster tile streams.  Checks that every live fragment is launched
+// exactly once, inside the coords of its tc tile, and measures engine cycles
+// per second for one cluster.
+// Usage: tc_engine_test [streams to time]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <map>
+#include <vector>
+
+#include "tc_engine.h"
+
+struct stream_config_t {
+   unsigned engines, bins, tc_h, tc_w, r_h, r_w;
+};
+
+static stream_config_t g_config;
+static std::vector<tcTilePtr_t> g_in_flight;
+static std::map<const RasterTile::rasterFragment_t*, unsigned> g_launched;
+static unsigned g_errors = 0;
+//launches are only checked outside the timed runs
+static bool g_check = true;
+
+static void record_launch(unsigned cluster_id, tcTilePtr_t tile,
+      unsigned done_prims)
+{
+   for(unsigned f=0; g_check and f<tile->size(); f++){
+      const RasterTile::rasterFragment_t* frag = tile->at(f);
+      if(frag == NULL)
+         continue;
+      //fragments come from raster tiles inside the tc tile
+      const RasterTile* rtile = frag->tile;
+      if(rtile->xCoord < tile->x or rtile->yCoord < tile->y
+            or rtile->xCoord >= tile->x + g_config.tc_w*g_config.r_w
+            or rtile->yCoord >= tile->y + g_config.tc_h*g_config.r_h){
+         printf("ERROR ** raster tile (%u,%u) launched in tc tile (%u,%u)\n",
+               rtile->xCoord, rtile->yCoord, tile->x, tile->y);
+         g_errors++;
+      }
+      g_launched[frag]++;
+   }
+   g_in_flight.push_back(tile);
+}
+
+//tiles on an 8x8 grid of raster tile coords, a third of the fragments alive
+static std::vector<RasterTile*> make_stream(drawCallArena_t* arena,
+      const stream_config_t& c, unsigned count)
+{
+   std::vector<RasterTile*> tiles;
+   while(tiles.size() < count){
+      RasterTile* tile = arena->create<RasterTile>(arena,
+            (primitiveFragmentsData_t*) NULL, 0, 0, c.r_h, c.r_w,
+            (rand()%8)*c.r_w, (rand()%8)*c.r_h);
+      for(unsigned i=0; i<tile->size(); i++){
+         RasterTile::rasterFragment_t& frag =
+            tile->getRasterFragment(i/QUAD_SIZE, i%QUAD_SIZE);
+         frag.alive = rand()%3 == 0;
+         frag.tile = tile;
+      }
+      if(rand()%4 == 0)
+         tile->setSkipFineDepth();
+      if(tile->resetActiveCount() > 0)
+         tiles.push_back(tile);
+   }
+   return tiles;
+}
+
+//runs the stream to completion, shading finishes a launched tile with
+//probability 1/3 per cycle, returns the cycles taken
+static unsigned long run_stream(const stream_config_t& c,
+      const std::vector<RasterTile*>& tiles)
+{
+   tile_assembly_stage_t stage(c.engines, c.bins, c.tc_h, c.tc_w, c.r_h, c.r_w,
+         20, 0, record_launch);
+   g_in_flight.clear();
+   //xorshift, cheap next to the engines being timed
+   uint32_t state = 2463534242u;
+   unsigned long cycles = 0;
+   size_t next = 0;
+   while(next < tiles.size() or !stage.empty()){
+      stage.cycle();
+      cycles++;
+      if(next < tiles.size() and stage.insert(tiles[next]))
+         next++;
+      for(unsigned t=0; t<g_in_flight.size();){
+         state ^= state << 13;
+         state ^= state >> 17;
+         state ^= state << 5;
+         if(state%3 == 0){
+            g_in_flight[t]->done = true;
+            g_in_flight[t] = g_in_flight.back();
+            g_in_flight.pop_back();
+         } else {
+            t++;
+         }
+      }
+      if(cycles > 50000000){
+         printf("ERROR ** stream did not drain\n");
+         g_errors++;
+         break;
+      }
+   }
+   return cycles;
+}
+
+int main(int argc, char *argv[])
+{
+   const stream_config_t configs[] = {
+      {4, 4, 1, 1, 4, 4},
+      {4, 4, 2, 2, 8, 8},
+      {2, 8, 4, 4, 16, 16},
+      {4, 2, 2, 2, 32, 32},
+      {4, 4, 2, 2, 2, 2},
+   };
+   unsigned streams = (argc > 1)? atoi(argv[1]) : 40;
+   srand(1);
+   for(unsigned c=0; c<sizeof(configs)/sizeof(configs[0]); c++){
+      const stream_config_t& cfg = configs[c];
+      g_config = cfg;
+      drawCallArena_t arena;
+      std::vector<RasterTile*> tiles = make_stream(&arena, cfg, 300);
+      std::vector<const RasterTile::rasterFragment_t*> alive;
+      for(unsigned t=0; t<tiles.size(); t++){
+         for(unsigned i=0; i<tiles[t]->size(); i++){
+            RasterTile::rasterFragment_t* frag =
+               &tiles[t]->getRasterFragment(i/QUAD_SIZE, i%QUAD_SIZE);
+            if(frag->alive)
+               alive.push_back(frag);
+         }
+      }
+      g_launched.clear();
+      run_stream(cfg, tiles);
+      for(unsigned f=0; f<alive.size(); f++){
+         if(g_launched[alive[f]] != 1){
+            printf("ERROR ** fragment launched %u times\n", g_launched[alive[f]]);
+            g_errors++;
+            break;
+         }
+      }
+
+      //the engines consume the alive flags, time fresh streams
+      g_check = false;
+      double seconds = 0;
+      unsigned long cycles = 0;
+      for(unsigned s=0; s<streams; s++){
+         arena.reset();
+         tiles = make_stream(&arena, cfg, 300);
+         std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+         cycles += run_stream(cfg, tiles);
+         seconds += std::chrono::duration<double>(
+               std::chrono::steady_clock::now() - t0).count();
+      }
+      g_check = true;
+      printf("%u engines x %u bins, tc %ux%u, raster %ux%u: %.2f Mcycles/s\n",
+            cfg.engines, cfg.bins, cfg.tc_h, cfg.tc_w, cfg.r_h, cfg.r_w,
+            cycles/seconds/1e6);
+   }
+
+   if(g_errors){
+      printf("SUMMARY:  ERRORS FOUND\n");
+   } else {
+      printf("SUMMARY: UNIT TEST PASSED\n");
+   }
+   return g_errors != 0;
+}
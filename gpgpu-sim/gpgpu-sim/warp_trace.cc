@@ -0,0 +1,362 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "warp_trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+static const char WARP_TRACE_MAGIC[4] = { 'W', 'T', 'R', '1' };
+
+// record flags
+enum {
+   WT_MEM        = 0x01,
+   WT_EXEC_MASK  = 0x02, // exec mask differs from issue mask
+   WT_DONE_MASK  = 0x04,
+   WT_ATOMIC     = 0x08,
+   WT_SAME_ISSUE = 0x10  // issue mask equals the previous record's
+};
+
+static void put_varint( std::vector<unsigned char> &buf, unsigned long long v )
+{
+   while( v >= 0x80 ) {
+      buf.push_back( (unsigned char)(v | 0x80) );
+      v >>= 7;
+   }
+   buf.push_back( (unsigned char)v );
+}
+
+static void put_delta( std::vector<unsigned char> &buf, unsigned long long from, unsigned long long to )
+{
+   long long d = (long long)(to - from);
+   put_varint( buf, ((unsigned long long)d << 1) ^ (unsigned long long)(d >> 63) );
+}
+
+static bool get_varint( const unsigned char *buf, size_t size, size_t &pos, unsigned long long &v )
+{
+   v = 0;
+   for( unsigned shift=0; pos < size && shift < 64; shift += 7 ) {
+      unsigned char b = buf[pos++];
+      v |= (unsigned long long)(b & 0x7f) << shift;
+      if( !(b & 0x80) )
+         return true;
+   }
+   return false;
+}
+
+static unsigned long long apply_delta( unsigned long long from, unsigned long long zz )
+{
+   long long d = (long long)(zz >> 1) ^ -(long long)(zz & 1);
+   return from + (unsigned long long)d;
+}
+
+void warp_trace_record::clear( address_type _pc, const active_mask_t &issue )
+{
+   pc = _pc;
+   issue_mask = issue;
+   exec_mask.reset();
+   done_mask.reset();
+   atomic_mask.reset();
+   is_mem = false;
+   space = memory_space_t();
+   data_size = 0;
+   memset( n_addrs, 0, sizeof(n_addrs) );
+}
+
+warp_trace_stream::warp_trace_stream( unsigned cta, unsigned warp )
+{
+   m_cta = cta;
+   m_warp = warp;
+   m_pos = 0;
+   m_ahead_valid = false;
+}
+
+void warp_trace_stream::append( const warp_trace_record &r )
+{
+   unsigned char flags = 0;
+   if( r.is_mem ) flags |= WT_MEM;
+   if( r.exec_mask != r.issue_mask ) flags |= WT_EXEC_MASK;
+   if( r.done_mask.any() ) flags |= WT_DONE_MASK;
+   if( r.atomic_mask.any() ) flags |= WT_ATOMIC;
+   if( r.issue_mask == m_enc.issue_mask ) flags |= WT_SAME_ISSUE;
+
+   m_buf.push_back(flags);
+   put_delta( m_buf, m_enc.pc, r.pc );
+   m_enc.pc = r.pc;
+   if( !(flags & WT_SAME_ISSUE) ) {
+      put_varint( m_buf, r.issue_mask.to_ullong() );
+      m_enc.issue_mask = r.issue_mask;
+   }
+   if( flags & WT_EXEC_MASK ) put_varint( m_buf, r.exec_mask.to_ullong() );
+   if( flags & WT_DONE_MASK ) put_varint( m_buf, r.done_mask.to_ullong() );
+   if( flags & WT_ATOMIC ) put_varint( m_buf, r.atomic_mask.to_ullong() );
+
+   if( r.is_mem ) {
+      put_varint( m_buf, r.space.get_type() );
+      put_varint( m_buf, r.space.get_bank() );
+      put_varint( m_buf, r.data_size );
+      for( unsigned t=0; t < MAX_WARP_SIZE; t++ ) {
+         if( !r.exec_mask.test(t) )
+            continue;
+         put_varint( m_buf, r.n_addrs[t] );
+         for( unsigned a=0; a < r.n_addrs[t]; a++ ) {
+            put_delta( m_buf, m_enc.addr, r.addrs[t][a] );
+            m_enc.addr = r.addrs[t][a];
+         }
+      }
+   }
+}
+
+void warp_trace_stream::assign( const unsigned char *data, size_t n )
+{
+   m_buf.assign( data, data+n );
+   m_pos = 0;
+   m_dec = delta_state();
+   m_ahead_valid = false;
+}
+
+bool warp_trace_stream::decode( warp_trace_record &r )
+{
+   if( m_pos >= m_buf.size() )
+      return false;
+
+   const unsigned char *buf = &m_buf[0];
+   size_t size = m_buf.size();
+   unsigned long long v;
+   bool ok = true;
+
+   unsigned char flags = buf[m_pos++];
+   ok = ok && get_varint( buf, size, m_pos, v );
+   m_dec.pc = apply_delta( m_dec.pc, v );
+   if( ok && !(flags & WT_SAME_ISSUE) ) {
+      ok = get_varint( buf, size, m_pos, v );
+      m_dec.issue_mask = active_mask_t(v);
+   }
+   r.clear( m_dec.pc, m_dec.issue_mask );
+   r.exec_mask = r.issue_mask;
+   if( ok && (flags & WT_EXEC_MASK) ) {
+      ok = get_varint( buf, size, m_pos, v );
+      r.exec_mask = active_mask_t(v);
+   }
+   if( ok && (flags & WT_DONE_MASK) ) {
+      ok = get_varint( buf, size, m_pos, v );
+      r.done_mask = active_mask_t(v);
+   }
+   if( ok && (flags & WT_ATOMIC) ) {
+      ok = get_varint( buf, size, m_pos, v );
+      r.atomic_mask = active_mask_t(v);
+   }
+
+   if( ok && (flags & WT_MEM) ) {
+      unsigned long long type, bank, data_size;
+      ok = get_varint( buf, size, m_pos, type ) &&
+           get_varint( buf, size, m_pos, bank ) &&
+           get_varint( buf, size, m_pos, data_size );
+      r.is_mem = true;
+      r.space = memory_space_t( (enum _memory_space_t)type );
+      r.space.set_bank( (unsigned)bank );
+      r.data_size = (unsigned)data_size;
+      for( unsigned t=0; ok && t < MAX_WARP_SIZE; t++ ) {
+         if( !r.exec_mask.test(t) )
+            continue;
+         ok = get_varint( buf, size, m_pos, v ) && v <= MAX_ACCESSES_PER_INSN_PER_THREAD;
+         r.n_addrs[t] = (unsigned char)v;
+         for( unsigned a=0; ok && a < r.n_addrs[t]; a++ ) {
+            ok = get_varint( buf, size, m_pos, v );
+            m_dec.addr = apply_delta( m_dec.addr, v );
+            r.addrs[t][a] = m_dec.addr;
+         }
+      }
+   }
+
+   if( !ok ) {
+      printf("GPGPU-Sim uArch: ERROR ** warp trace for cta %u warp %u is corrupt\n", m_cta, m_warp );
+      abort();
+   }
+   return true;
+}
+
+bool warp_trace_stream::next( warp_trace_record &r )
+{
+   if( m_ahead_valid ) {
+      r = m_ahead;
+      m_ahead_valid = false;
+      return true;
+   }
+   return decode(r);
+}
+
+const warp_trace_record *warp_trace_stream::peek()
+{
+   if( !m_ahead_valid )
+      m_ahead_valid = decode(m_ahead);
+   return m_ahead_valid ? &m_ahead : NULL;
+}
+
+warp_trace::warp_trace( enum warp_trace_mode mode, const char *prefix, const kernel_info_t &kernel, unsigned warp_size )
+{
+   assert( mode != WARP_TRACE_OFF );
+   char buf[1024];
+   snprintf( buf, sizeof(buf), "%s.%u.wtr.gz", prefix, kernel.get_uid() );
+   m_mode = mode;
+   m_filename = buf;
+   m_file = NULL;
+   m_grid_dim = kernel.get_grid_dim();
+   m_cta_dim = kernel.get_cta_dim();
+   m_warp_size = warp_size;
+   m_n_bytes = 0;
+
+   if( m_mode == WARP_TRACE_CAPTURE ) {
+      m_file = gzopen( m_filename.c_str(), "wb" );
+      if( m_file == NULL ) {
+         printf("GPGPU-Sim uArch: ERROR ** could not open warp trace \'%s\' for writing\n", m_filename.c_str() );
+         abort();
+      }
+      write_header();
+   } else {
+      read_file();
+   }
+   printf("GPGPU-Sim uArch: %s warp trace \'%s\' for kernel %u \'%s\'\n",
+          (m_mode == WARP_TRACE_CAPTURE)? "capturing" : "replaying",
+          m_filename.c_str(), kernel.get_uid(), kernel.name().c_str() );
+}
+
+warp_trace::~warp_trace()
+{
+   std::map<std::pair<unsigned,unsigned>,warp_trace_stream*>::iterator s;
+   if( m_mode == WARP_TRACE_CAPTURE ) {
+      // warps that never retired (e.g. the kernel was cut short) are still written
+      while( !m_streams.empty() )
+         warp_done( m_streams.begin()->second );
+      gzclose(m_file);
+      printf("GPGPU-Sim uArch: wrote %llu bytes of warp trace to \'%s\'\n", m_n_bytes, m_filename.c_str() );
+   } else {
+      for( s=m_streams.begin(); s != m_streams.end(); s++ )
+         delete s->second;
+   }
+}
+
+unsigned warp_trace::cta_id( const dim3 &ctaid ) const
+{
+   return ctaid.x + m_grid_dim.x * (ctaid.y + m_grid_dim.y * ctaid.z);
+}
+
+warp_trace_stream *warp_trace::stream( unsigned cta, unsigned warp )
+{
+   std::pair<unsigned,unsigned> key(cta,warp);
+   std::map<std::pair<unsigned,unsigned>,warp_trace_stream*>::iterator s = m_streams.find(key);
+   if( s != m_streams.end() )
+      return s->second;
+   if( m_mode == WARP_TRACE_REPLAY ) {
+      printf("GPGPU-Sim uArch: ERROR ** warp trace \'%s\' has no records for cta %u warp %u\n",
+             m_filename.c_str(), cta, warp );
+      abort();
+   }
+   warp_trace_stream *result = new warp_trace_stream(cta,warp);
+   m_streams[key] = result;
+   return result;
+}
+
+void warp_trace::warp_done( warp_trace_stream *s )
+{
+   assert( m_mode == WARP_TRACE_CAPTURE );
+   std::vector<unsigned char> chunk;
+   put_varint( chunk, s->get_cta() );
+   put_varint( chunk, s->get_warp() );
+   put_varint( chunk, s->bytes().size() );
+   chunk.insert( chunk.end(), s->bytes().begin(), s->bytes().end() );
+   if( gzwrite( m_file, &chunk[0], chunk.size() ) != (int)chunk.size() ) {
+      printf("GPGPU-Sim uArch: ERROR ** could not write warp trace \'%s\'\n", m_filename.c_str() );
+      abort();
+   }
+   m_n_bytes += chunk.size();
+   m_streams.erase( std::make_pair(s->get_cta(),s->get_warp()) );
+   delete s;
+}
+
+void warp_trace::write_header()
+{
+   std::vector<unsigned char> header( WARP_TRACE_MAGIC, WARP_TRACE_MAGIC+sizeof(WARP_TRACE_MAGIC) );
+   put_varint( header, m_grid_dim.x );
+   put_varint( header, m_grid_dim.y );
+   put_varint( header, m_grid_dim.z );
+   put_varint( header, m_cta_dim.x );
+   put_varint( header, m_cta_dim.y );
+   put_varint( header, m_cta_dim.z );
+   put_varint( header, m_warp_size );
+   gzwrite( m_file, &header[0], header.size() );
+   m_n_bytes += header.size();
+}
+
+void warp_trace::read_file()
+{
+   gzFile f = gzopen( m_filename.c_str(), "rb" );
+   if( f == NULL ) {
+      printf("GPGPU-Sim uArch: ERROR ** could not open warp trace \'%s\'\n", m_filename.c_str() );
+      abort();
+   }
+   std::vector<unsigned char> data;
+   unsigned char buf[65536];
+   int n;
+   while( (n = gzread(f,buf,sizeof(buf))) > 0 )
+      data.insert( data.end(), buf, buf+n );
+   gzclose(f);
+
+   size_t pos = sizeof(WARP_TRACE_MAGIC);
+   unsigned long long hdr[7];
+   bool ok = data.size() >= pos && !memcmp( &data[0], WARP_TRACE_MAGIC, pos );
+   for( unsigned i=0; ok && i < 7; i++ )
+      ok = get_varint( &data[0], data.size(), pos, hdr[i] );
+   if( !ok ) {
+      printf("GPGPU-Sim uArch: ERROR ** \'%s\' is not a warp trace\n", m_filename.c_str() );
+      abort();
+   }
+   if( hdr[0] != m_grid_dim.x || hdr[1] != m_grid_dim.y || hdr[2] != m_grid_dim.z ||
+       hdr[3] != m_cta_dim.x || hdr[4] != m_cta_dim.y || hdr[5] != m_cta_dim.z || hdr[6] != m_warp_size ) {
+      printf("GPGPU-Sim uArch: ERROR ** warp trace \'%s\' was captured with grid (%llu,%llu,%llu) cta (%llu,%llu,%llu) warp size %llu\n",
+             m_filename.c_str(), hdr[0], hdr[1], hdr[2], hdr[3], hdr[4], hdr[5], hdr[6] );
+      abort();
+   }
+
+   while( pos < data.size() ) {
+      unsigned long long cta, warp, len;
+      ok = get_varint( &data[0], data.size(), pos, cta ) &&
+           get_varint( &data[0], data.size(), pos, warp ) &&
+           get_varint( &data[0], data.size(), pos, len ) &&
+           len <= data.size() - pos;
+      if( !ok ) {
+         printf("GPGPU-Sim uArch: ERROR ** warp trace \'%s\' is truncated\n", m_filename.c_str() );
+         abort();
+      }
+      warp_trace_stream *s = new warp_trace_stream( (unsigned)cta, (unsigned)warp );
+      s->assign( &data[0] + pos, (size_t)len );
+      m_streams[std::make_pair((unsigned)cta,(unsigned)warp)] = s;
+      pos += len;
+   }
+}
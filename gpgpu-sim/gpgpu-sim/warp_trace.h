@@ -0,0 +1,145 @@
+// Copyright (c) 2026, the contributors named in the revision history of
+// this file
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of the copyright holders nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef WARP_TRACE_H
+#define WARP_TRACE_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#include "../abstract_hardware_model.h"
+
+// Warp instruction traces let the timing model run a kernel without the
+// functional simulator.  A capture run records, for every dynamic warp
+// instruction, the pc, the active masks and the per-lane memory addresses
+// (before local memory translation, so coalescing and address mapping are
+// redone under the replaying configuration).  A replay run feeds these
+// records to shader_core_ctx in place of execute_warp_inst_t.  Replay is
+// timing only: no instruction is executed, so the kernel's output in memory
+// is not valid afterwards.
+//
+// One gzip file is written per kernel launch.  It holds a short header
+// followed by one chunk per warp: varint cta, varint warp, varint length and
+// the warp's encoded records.  Warps are identified by their flattened CTA
+// id and their index within the CTA, so a trace can be replayed on a machine
+// configuration that places CTAs differently.
+
+enum warp_trace_mode {
+   WARP_TRACE_OFF = 0,
+   WARP_TRACE_CAPTURE,
+   WARP_TRACE_REPLAY
+};
+
+// One dynamic warp instruction
+struct warp_trace_record {
+   void clear( address_type _pc, const active_mask_t &issue );
+
+   address_type pc;
+   active_mask_t issue_mask;  // lanes the SIMT stack issued the instruction to
+   active_mask_t exec_mask;   // lanes that passed their guard predicate
+   active_mask_t done_mask;   // lanes whose thread exited on this instruction
+   active_mask_t atomic_mask; // lanes that registered an atomic callback
+   bool is_mem;
+   memory_space_t space;
+   unsigned data_size;
+   unsigned char n_addrs[MAX_WARP_SIZE];
+   new_addr_type addrs[MAX_WARP_SIZE][MAX_ACCESSES_PER_INSN_PER_THREAD];
+};
+
+// Encoded records of a single warp
+class warp_trace_stream {
+public:
+   warp_trace_stream( unsigned cta, unsigned warp );
+
+   unsigned get_cta() const { return m_cta; }
+   unsigned get_warp() const { return m_warp; }
+
+   // capture
+   void append( const warp_trace_record &r );
+   const std::vector<unsigned char> &bytes() const { return m_buf; }
+
+   // replay
+   void assign( const unsigned char *data, size_t n );
+   bool next( warp_trace_record &r );
+   const warp_trace_record *peek();
+
+private:
+   // pc, address and mask deltas are taken against the previous record
+   struct delta_state {
+      delta_state() : pc(0), addr(0) {}
+      address_type pc;
+      new_addr_type addr;
+      active_mask_t issue_mask;
+   };
+
+   bool decode( warp_trace_record &r );
+
+   unsigned m_cta;
+   unsigned m_warp;
+   std::vector<unsigned char> m_buf;
+   size_t m_pos;
+   delta_state m_enc;
+   delta_state m_dec;
+   warp_trace_record m_ahead;
+   bool m_ahead_valid;
+};
+
+// All warp streams of one kernel launch
+class warp_trace {
+public:
+   warp_trace( enum warp_trace_mode mode, const char *prefix, const kernel_info_t &kernel, unsigned warp_size );
+   ~warp_trace();
+
+   enum warp_trace_mode get_mode() const { return m_mode; }
+
+   // flattened id of a CTA of this kernel
+   unsigned cta_id( const dim3 &ctaid ) const;
+
+   // capture creates the stream; replay returns the stream read from the
+   // trace file and aborts if the warp was not captured
+   warp_trace_stream *stream( unsigned cta, unsigned warp );
+
+   // capture: the warp has retired, write its records out and release them
+   void warp_done( warp_trace_stream *s );
+
+private:
+   void write_header();
+   void read_file();
+
+   enum warp_trace_mode m_mode;
+   std::string m_filename;
+   gzFile m_file;
+   dim3 m_grid_dim;
+   dim3 m_cta_dim;
+   unsigned m_warp_size;
+   std::map<std::pair<unsigned,unsigned>,warp_trace_stream*> m_streams;
+   unsigned long long m_n_bytes;
+};
+
+#endif
@@ -60,7 +60,7 @@ InterconnectInterface* InterconnectInterface::New(const char* const config_file)
 
 InterconnectInterface::InterconnectInterface()
 {
-
+  _drained = false;
 }
 
 InterconnectInterface::~InterconnectInterface()
@@ -139,6 +139,7 @@ void InterconnectInterface::CreateInterconnect(unsigned n_shader, unsigned n_mem
 void InterconnectInterface::Init()
 {
   _traffic_manager->Init();
+  _drained = false;
   // TODO: Should we init _round_robin_turn?
   //       _boundary_buffer, _ejection_buffer and _ejected_flit_queue should be cleared
 }
@@ -182,6 +183,7 @@ void InterconnectInterface::Push(unsigned input_deviceID, unsigned output_device
   }
 
   //TODO: _include_queuing ?
+  _drained = false;
   _traffic_manager->_GeneratePacket( input_icntID, -1, 0 /*class*/, _traffic_manager->_time, subnet, n_flits, packet_type, data, output_icntID);
 
 #if DOUB
@@ -222,7 +224,35 @@ void* InterconnectInterface::Pop(unsigned deviceID)
 
 void InterconnectInterface::Advance()
 {
+  if (_drained) {
+    // a drained network does nothing in a step except counting it
+    ++_traffic_manager->_time;
+    return;
+  }
   _traffic_manager->_Step();
+  _drained = !Busy() && _CheckDrained();
+}
+
+bool InterconnectInterface::_CheckDrained() const
+{
+  // a credit still on its way back shows up as an occupied slot in the
+  // buffer state of the router or node that sent the flit
+  for (int s = 0; s < _subnets; ++s) {
+    const vector<Router *> & routers = _net[s]->GetRouters();
+    for (size_t r = 0; r < routers.size(); ++r) {
+      for (int o = 0; o < routers[r]->NumOutputs(); ++o) {
+        if (routers[r]->GetUsedCredit(o)) {
+          return false;
+        }
+      }
+    }
+    for (size_t n = 0; n < _traffic_manager->_buf_states.size(); ++n) {
+      if (_traffic_manager->_buf_states[n][s]->Occupancy()) {
+        return false;
+      }
+    }
+  }
+  return true;
 }
 
 bool InterconnectInterface::Busy() const
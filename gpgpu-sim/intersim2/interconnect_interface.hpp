@@ -57,6 +57,9 @@ public:
   virtual void* Pop(unsigned ouput_deviceID);
   virtual void Advance();
   virtual bool Busy() const;
+  // no flit and no credit anywhere in the network, so Pop() returns NULL
+  // and Advance() only moves the clock until the next Push()
+  bool Drained() const { return _drained; }
   virtual bool HasBuffer(unsigned deviceID, unsigned int size) const;
   virtual void DisplayStats() const;
   virtual void DisplayOverallStats() const;
@@ -93,6 +96,7 @@ protected:
   typedef queue<Flit*> _EjectionBufferItem;
   
   void _CreateBuffer( );
+  bool _CheckDrained() const;
   void _CreateNodeMap(unsigned n_shader, unsigned n_mem, unsigned n_node, int use_map);
   void _DisplayMap(int dim,int count);
   
@@ -108,6 +112,8 @@ protected:
   unsigned int _input_buffer_capacity;
   
   vector<vector<int> > _round_robin_turn; //keep track of _boundary_buffer last used in icnt_pop
+
+  bool _drained;
   
   GPUTrafficManager* _traffic_manager;
   unsigned _flit_size;
@@ -114,6 +114,23 @@ void Stats::AddSample( double val )
   _hist[b]++;
 }
 
+void Stats::AddSamples( double val, int n )
+{
+  if ( n <= 0 ) {
+    return;
+  }
+  _num_samples += n;
+  _sample_sum += val * n;
+
+  _max = !(val <= _max) ? val : _max;
+  _min = !(val >= _min) ? val : _min;
+
+  int b = (int)fmax(floor( val / _bin_size ), 0.0);
+  b = (b >= _num_bins) ? (_num_bins - 1) : b;
+
+  _hist[b] += n;
+}
+
 void Stats::Display( ostream & os ) const
 {
   os << *this << endl;
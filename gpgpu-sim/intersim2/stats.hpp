@@ -62,6 +62,8 @@ public:
   inline void AddSample( int val ) {
     AddSample( (double)val );
   }
+  // same as n calls of AddSample( val )
+  void AddSamples( double val, int n );
 
   int GetBin(int b){ return _hist[b];}
 
@@ -18,6 +18,11 @@ void StatAddSample (void * st, int val)
    ((Stats *)st)->AddSample(val);
 }
 
+void StatAddSamples (void * st, int val, unsigned n)
+{
+   ((Stats *)st)->AddSamples(val, n);
+}
+
 double StatAverage(void * st) 
 {
    return((Stats *)st)->Average();
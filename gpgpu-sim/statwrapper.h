@@ -4,6 +4,7 @@
 class Stats_gpgpu* StatCreate (const char * name, double bin_size, int num_bins) ;
 void StatClear(void * st);
 void StatAddSample (void * st, int val);
+void StatAddSamples (void * st, int val, unsigned n);
 double StatAverage(void * st) ;
 double StatMax(void * st) ;
 double StatMin(void * st) ;